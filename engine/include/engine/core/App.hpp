@@ -10,6 +10,7 @@ namespace engine::util {
 class Error;
 }
 
+#include <cstdint>
 #include <vector>
 
 namespace engine::core {
@@ -31,6 +32,7 @@ class Controller;
 *        initialize();
 *        while (loop()) {
 *            poll_events();
+*            fixed_update();
 *            update();
 *            draw();
 *        }
@@ -55,6 +57,7 @@ public:
     *        initialize();
     *        while (loop()) {
     *            poll_events();
+    *            fixed_update();
     *            update();
     *            draw();
     *        }
@@ -106,14 +109,43 @@ private:
     */
     bool loop();
 
+    /**
+    * @brief Runs the fixed-rate simulation steps. Calls @ref engine::core::Controller::fixed_update for registered
+    * controllers, once per step.
+    *
+    * The @ref platform::PlatformController decides in @ref App::loop how many steps of
+    * @ref platform::FixedTimestep::step seconds fit into the time that passed, at most
+    * @ref platform::FixedTimestep::max_steps, so the simulation advances at the same rate regardless of the frame rate.
+    */
+    void fixed_update();
+
     /**
     * @brief Updates the app logic state. Calls @ref engine::core::Controller::update for registered controllers.
     *
     * This is where all the App state should be updated including handling events
     * registered in @ref App::poll_events, processing physics, world logic etc.
+    *
+    * With the parallel update, enabled by `--parallel-update` or `"app": { "parallel_update": true }` in the
+    * config.json, see @ref App::update_parallel.
     */
     void update();
 
+    /**
+    * @brief Updates the controllers that don't depend on each other concurrently.
+    *
+    * A controller updates as soon as all the controllers ordered before it by @ref Controller::before and
+    * @ref Controller::after have updated. The controllers whose @ref Controller::uses_gl_context returns false
+    * update on the workers of the @ref JobSystem, the rest on the main thread, which schedules the controllers and waits for the
+    * workers in between. An exception thrown by a controller is rethrown on the main thread once the controllers
+    * already running have finished.
+    */
+    void update_parallel();
+
+    /**
+    * @brief Records the edges between the sorted controllers for @ref App::update_parallel.
+    */
+    void build_update_graph();
+
     /**
     * @brief Draws the frame. Calls @ref engine::core::Controller::draw for registered controllers.
     *
@@ -168,6 +200,18 @@ public:
 
 private:
     std::vector<Controller *> m_controllers;
+
+    /**
+    * @brief Indices of the controllers that update after each controller, indexed like @ref App::m_controllers.
+    */
+    std::vector<std::vector<uint32_t> > m_update_successors;
+
+    /**
+    * @brief Number of the controllers that update directly before each controller.
+    */
+    std::vector<uint32_t> m_update_predecessor_count;
+
+    bool m_parallel_update{false};
 };
 } // namespace engine
 
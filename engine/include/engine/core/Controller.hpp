@@ -66,6 +66,17 @@ public:
         return typeid(*this).name();
     }
 
+    /**
+    * @brief Returns true if the @ref Controller::update calls OpenGL, or anything else that must run on the main
+    * thread. With the parallel update of the @ref App, only the controllers that return false update on the worker
+    * threads. Override to return false if the update only changes the state of the controller.
+    *
+    * All the other phases always execute on the main thread.
+    */
+    virtual bool uses_gl_context() const {
+        return true;
+    }
+
     virtual ~Controller() = default;
 
     /**
@@ -143,8 +154,17 @@ private:
     virtual void poll_events() {
     }
 
+    /**
+    * @brief Advance the simulation by exactly one @ref platform::FixedTimestep::step.
+    * Executes in the @ref core::App::fixed_update, zero or more times per frame, before @ref core::Controller::update.
+    * The results don't depend on the frame rate, so put physics and game logic here.
+    */
+    virtual void fixed_update() {
+    }
+
     /**
     * @brief Update the controller state and prepare for drawing. Executes in the @ref core::App::update.
+    * Interpolate the state simulated in @ref core::Controller::fixed_update with @ref platform::FixedTimestep::alpha.
     */
     virtual void update() {
     }
@@ -9,6 +9,8 @@
 #include <engine/core/App.hpp>
 
 #include <engine/core/Controller.hpp>
+#include <engine/core/JobSystem.hpp>
+#include <engine/core/JobSystemController.hpp>
 
 
 #include <engine/platform/Window.hpp>
@@ -17,17 +19,33 @@
 
 #include <engine/graphics/OpenGL.hpp>
 #include <engine/graphics/Camera.hpp>
+#include <engine/graphics/CameraPath.hpp>
+#include <engine/graphics/Bounds.hpp>
+#include <engine/graphics/FrameUniforms.hpp>
+#include <engine/graphics/GeometryPool.hpp>
+#include <engine/graphics/GpuCulling.hpp>
+#include <engine/graphics/GpuProfiler.hpp>
+#include <engine/graphics/Frustum.hpp>
+#include <engine/graphics/OcclusionCuller.hpp>
+#include <engine/graphics/RenderQueue.hpp>
+#include <engine/graphics/StreamBuffer.hpp>
 
 #include <engine/util/Utils.hpp>
 #include <engine/util/Configuration.hpp>
 #include <engine/util/ArgParser.hpp>
 #include <engine/util/Errors.hpp>
+#include <engine/util/Profiler.hpp>
 
 #include <engine/resources/ShaderCompiler.hpp>
 #include <engine/resources/ResourcesController.hpp>
+#include <engine/resources/ResourceHandle.hpp>
 #include <engine/resources/Model.hpp>
+#include <engine/resources/ModelImporter.hpp>
+#include <engine/resources/MeshCache.hpp>
 #include <engine/resources/Shader.hpp>
 #include <engine/resources/Texture.hpp>
+#include <engine/resources/TextureCache.hpp>
+#include <engine/resources/TextureCompressor.hpp>
 #include <engine/resources/Skybox.hpp>
 
 #endif//MATF_RG_PROJECT_ENGINE_HPP
@@ -0,0 +1,215 @@
+/**
+ * @file JobSystem.hpp
+ * @brief Defines the JobSystem class that runs jobs on worker threads that steal work from each other.
+ */
+
+#ifndef MATF_RG_PROJECT_JOB_SYSTEM_HPP
+#define MATF_RG_PROJECT_JOB_SYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace engine::core {
+/**
+* @class JobCounter
+* @brief Counts the unfinished jobs scheduled with it, so that @ref JobSystem::wait can wait for all of them.
+*
+* The first exception thrown by one of the jobs is rethrown from @ref JobSystem::wait.
+* The counter must outlive its jobs; waiting for it before it goes out of scope guarantees that.
+*/
+class JobCounter {
+    friend class JobSystem;
+
+public:
+    /**
+    * @brief Returns true if all the jobs scheduled with the counter have finished.
+    */
+    bool is_done() const {
+        std::lock_guard lock(m_mutex);
+        return m_pending == 0;
+    }
+
+private:
+    mutable std::mutex m_mutex;
+    std::condition_variable m_done;
+    uint32_t m_pending{};
+    std::exception_ptr m_error;
+};
+
+/**
+* @class JobSystem
+* @brief Runs jobs on a fixed number of worker threads, each with its own deque of jobs.
+*
+* A worker pushes the jobs it schedules to the back of its deque and takes them from the back, so the
+* most recently scheduled, cache-warm jobs run first. A worker without jobs steals from the front of the other deques.
+* Jobs scheduled from the other threads are spread over the workers.
+*
+* The OpenGL context is current only on the main thread, so the jobs must not call OpenGL functions. Hand the OpenGL
+* part of the work back with @ref JobSystem::run_on_main_thread:
+* @code
+* auto jobs = engine::core::Controller::get<engine::core::JobSystemController>()->job_system();
+* jobs->schedule([jobs, path] {
+*     auto image = resources::load_image(path, false);
+*     jobs->run_on_main_thread([image = std::move(image)] {
+*         graphics::OpenGL::generate_texture(image);
+*     });
+* });
+* @endcode
+* Wait for a group of jobs with a @ref JobCounter, or split a loop over the workers with @ref JobSystem::parallel_for.
+* The waiting thread runs the queued jobs in the meantime instead of blocking.
+*/
+class JobSystem {
+public:
+    using Job = std::move_only_function<void()>;
+
+    /**
+    * @brief Starts the worker threads.
+    * @param number_of_workers Number of worker threads. Defaults to @ref JobSystem::default_number_of_workers.
+    */
+    explicit JobSystem(uint32_t number_of_workers = default_number_of_workers());
+
+    /**
+    * @brief Stops and joins the worker threads. Jobs that haven't started yet are discarded.
+    */
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    /**
+    * @brief Schedules the `job` for execution on one of the worker threads.
+    * @param job Callable without arguments.
+    * @param counter Counts the job until it finishes, if not null.
+    */
+    void schedule(Job job, JobCounter *counter = nullptr);
+
+    /**
+    * @brief Schedules the `task` and returns the future of its result.
+    * Exceptions thrown by the `task` are rethrown from the `std::future::get` of the returned future.
+    */
+    template<typename Task>
+    std::future<std::invoke_result_t<Task> > submit(Task task) {
+        using Result = std::invoke_result_t<Task>;
+        std::packaged_task<Result()> packaged_task(std::move(task));
+        std::future<Result> result = packaged_task.get_future();
+        schedule([packaged_task = std::move(packaged_task)]() mutable {
+            packaged_task();
+        });
+        return result;
+    }
+
+    /**
+    * @brief Runs the queued jobs on the calling thread until all the jobs of the `counter` have finished.
+    * Rethrows the first exception thrown by one of them.
+    */
+    void wait(JobCounter &counter);
+
+    /**
+    * @brief Calls `function(first, last)` for the consecutive chunks of [begin, end) of at most `grain_size`
+    * elements in parallel, and waits for all of them. The calling thread works on the chunks too.
+    * @code
+    * jobs->parallel_for(0, instances.size(), 256, [&](size_t first, size_t last) {
+    *     for (size_t i = first; i < last; ++i) {
+    *         visible[i] = frustum.intersects(instances[i].bounds);
+    *     }
+    * });
+    * @endcode
+    */
+    template<typename Function>
+    void parallel_for(size_t begin, size_t end, size_t grain_size, Function function) {
+        if (begin >= end) {
+            return;
+        }
+        grain_size = std::max<size_t>(grain_size, 1);
+        JobCounter counter;
+        for (size_t first = begin; first < end; first += grain_size) {
+            const size_t last = std::min(first + grain_size, end);
+            schedule([&function, first, last] {
+                function(first, last);
+            }, &counter);
+        }
+        wait(counter);
+    }
+
+    /**
+    * @brief Queues the `job` to run on the main thread, in the next @ref JobSystem::execute_main_thread_jobs.
+    * Safe to call from any thread.
+    */
+    void run_on_main_thread(Job job);
+
+    /**
+    * @brief Runs the jobs queued with @ref JobSystem::run_on_main_thread, in the order in which they were queued.
+    * Called by the @ref JobSystemController at the beginning of every frame.
+    */
+    void execute_main_thread_jobs();
+
+    /**
+    * @brief Returns the number of worker threads.
+    */
+    uint32_t number_of_workers() const {
+        return m_workers.size();
+    }
+
+    /**
+    * @brief Returns the number of hardware threads minus the main thread, but at least one.
+    */
+    static uint32_t default_number_of_workers();
+
+private:
+    struct QueuedJob {
+        Job function;
+        JobCounter *counter{};
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+        std::thread thread;
+    };
+
+    void worker_loop(uint32_t index);
+
+    /**
+    * @brief Takes the newest job of the worker `index`, or steals the oldest job of another worker.
+    * Threads that aren't workers only steal.
+    */
+    std::optional<QueuedJob> find_job(uint32_t index);
+
+    /**
+    * @brief Returns the index of the calling thread among the workers of this system, or @ref JobSystem::NOT_A_WORKER.
+    */
+    uint32_t current_worker() const;
+
+    static void run(QueuedJob &job);
+
+    static constexpr uint32_t NOT_A_WORKER = UINT32_MAX;
+
+    std::vector<std::unique_ptr<Worker> > m_workers;
+    /**
+    * @brief Number of the jobs in all the deques; the workers sleep while it is zero.
+    */
+    std::atomic<uint32_t> m_queued{0};
+    std::atomic<uint32_t> m_next_worker{0};
+    std::atomic<bool> m_stopping{false};
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+
+    std::mutex m_main_thread_mutex;
+    std::vector<Job> m_main_thread_jobs;
+};
+} // namespace engine::core
+
+#endif//MATF_RG_PROJECT_JOB_SYSTEM_HPP
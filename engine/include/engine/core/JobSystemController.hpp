@@ -0,0 +1,49 @@
+/**
+ * @file JobSystemController.hpp
+ * @brief Defines the JobSystemController class that owns the JobSystem shared by the whole engine.
+ */
+
+#ifndef MATF_RG_PROJECT_JOB_SYSTEM_CONTROLLER_HPP
+#define MATF_RG_PROJECT_JOB_SYSTEM_CONTROLLER_HPP
+
+#include <memory>
+#include <engine/core/Controller.hpp>
+#include <engine/core/JobSystem.hpp>
+
+namespace engine::core {
+/**
+* @class JobSystemController
+* @brief Starts the @ref JobSystem before the other engine controllers and stops it after them.
+*
+* Runs the jobs queued with @ref JobSystem::run_on_main_thread in @ref Controller::loop, at the beginning of every
+* frame. The number of workers is set in the config.json with `"jobs": { "workers": 4 }`; 0 or no setting uses
+* @ref JobSystem::default_number_of_workers.
+*/
+class JobSystemController final : public Controller {
+public:
+    std::string_view name() const override {
+        return "JobSystemController";
+    }
+
+    /**
+    * @brief Returns the job system shared by the engine and the app controllers.
+    */
+    JobSystem *job_system() {
+        return m_job_system.get();
+    }
+
+private:
+    void initialize() override;
+
+    bool loop() override;
+
+    /**
+    * @brief Joins the workers. Jobs that haven't started yet are discarded, as are the queued main thread jobs.
+    */
+    void terminate() override;
+
+    std::unique_ptr<JobSystem> m_job_system;
+};
+} // namespace engine::core
+
+#endif//MATF_RG_PROJECT_JOB_SYSTEM_CONTROLLER_HPP
@@ -0,0 +1,67 @@
+/**
+ * @file Bounds.hpp
+ * @brief Defines the bounding volumes used for visibility tests.
+*/
+
+#ifndef MATF_RG_PROJECT_BOUNDS_HPP
+#define MATF_RG_PROJECT_BOUNDS_HPP
+
+#include <limits>
+#include <glm/glm.hpp>
+
+namespace engine::graphics {
+/**
+* @struct AABB
+* @brief Axis aligned bounding box. The default constructed box is empty and grows with @ref AABB::expand.
+*/
+struct AABB {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+    bool is_empty() const {
+        return min.x > max.x || min.y > max.y || min.z > max.z;
+    }
+
+    glm::vec3 center() const {
+        return (min + max) * 0.5f;
+    }
+
+    /**
+    * @brief Returns the half-size of the box along each axis.
+    */
+    glm::vec3 extents() const {
+        return (max - min) * 0.5f;
+    }
+
+    void expand(const glm::vec3 &point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void expand(const AABB &other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    /**
+    * @brief Returns the smallest axis aligned box that contains this box transformed by the `transform`.
+    */
+    AABB transformed(const glm::mat4 &transform) const;
+};
+
+/**
+* @struct BoundingSphere
+* @brief Sphere that contains the whole object. Cheaper to test than the @ref AABB, but less tight.
+*/
+struct BoundingSphere {
+    glm::vec3 center{};
+    float radius{};
+
+    /**
+    * @brief Returns the sphere transformed by the `transform`. Non-uniform scale grows the radius by the largest scale.
+    */
+    BoundingSphere transformed(const glm::mat4 &transform) const;
+};
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_BOUNDS_HPP
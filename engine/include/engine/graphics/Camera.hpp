@@ -113,6 +113,11 @@ public:
      */
     void zoom(float offset);
 
+    /**
+     * @brief Turns the camera towards the `target` point, keeping the pitch within (-89, 89) degrees.
+     */
+    void look_at(const glm::vec3 &target);
+
 private:
     /**
      * @brief Calculates the front vector from the Camera's (updated) Euler Angles
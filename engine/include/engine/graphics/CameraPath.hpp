@@ -0,0 +1,94 @@
+/**
+ * @file CameraPath.hpp
+ * @brief Defines the CameraPath class that moves the Camera along a spline through keyframes.
+*/
+
+#ifndef MATF_RG_PROJECT_CAMERA_PATH_HPP
+#define MATF_RG_PROJECT_CAMERA_PATH_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <json.hpp>
+
+namespace engine::graphics {
+class Camera;
+
+/**
+* @struct CameraKeyframe
+* @brief Where the camera is and the point it looks at.
+*/
+struct CameraKeyframe {
+    glm::vec3 position{};
+    glm::vec3 target{0.0f, 0.0f, -1.0f};
+};
+
+/**
+* @class CameraPath
+* @brief A Catmull-Rom spline through the @ref CameraKeyframe, sampled by a parameter instead of the time, so the
+* camera goes through the same poses in every run regardless of the frame rate.
+*
+* Both the position and the target are interpolated, so the camera turns smoothly between the keyframes:
+* @code
+* auto path = engine::graphics::CameraPath::from_json(config["bench"]["camera_path"]);
+* path.apply(graphics->camera(), static_cast<float>(frame) / static_cast<float>(frame_count - 1));
+* @endcode
+*/
+class CameraPath {
+public:
+    CameraPath() = default;
+
+    explicit CameraPath(std::vector<CameraKeyframe> keyframes, bool closed = false) : m_keyframes(
+            std::move(keyframes)), m_closed(closed) {
+    }
+
+    /**
+    * @brief Reads the path from JSON:
+    * @code
+    * {
+    *   "closed": false,
+    *   "keyframes": [
+    *     { "position": [0, 0, 5], "target": [0, 0, 0] },
+    *     { "position": [5, 1, 0], "yaw": -180.0, "pitch": 0.0 }
+    *   ]
+    * }
+    * @endcode
+    * A keyframe looks either at the `target` or in the direction of the `yaw` and `pitch` in degrees, as shown in
+    * the camera info window of the test app, so a path can be recorded by writing down the camera poses.
+    */
+    static CameraPath from_json(const nlohmann::json &json);
+
+    void add(const CameraKeyframe &keyframe) {
+        m_keyframes.push_back(keyframe);
+    }
+
+    bool empty() const {
+        return m_keyframes.empty();
+    }
+
+    const std::vector<CameraKeyframe> &keyframes() const {
+        return m_keyframes;
+    }
+
+    /**
+    * @brief Returns the pose at `t` in [0, 1]. The first keyframe is at 0, the last at 1, or the first again if the
+    * path is closed.
+    */
+    CameraKeyframe sample(float t) const;
+
+    /**
+    * @brief Moves the `camera` to the pose at `t` and points it at the target.
+    */
+    void apply(Camera *camera, float t) const;
+
+private:
+    /**
+    * @brief Returns the keyframe `index`, wrapped around if the path is closed and clamped to the ends otherwise.
+    */
+    const CameraKeyframe &keyframe(int index) const;
+
+    std::vector<CameraKeyframe> m_keyframes;
+    bool m_closed{false};
+};
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_CAMERA_PATH_HPP
@@ -0,0 +1,56 @@
+/**
+ * @file FrameUniforms.hpp
+ * @brief Defines the FrameUniforms struct, the per-frame data that the GraphicsController shares with all the shaders.
+*/
+
+#ifndef MATF_RG_PROJECT_FRAME_UNIFORMS_HPP
+#define MATF_RG_PROJECT_FRAME_UNIFORMS_HPP
+
+#include <cstdint>
+#include <string_view>
+#include <glm/glm.hpp>
+
+namespace engine::graphics {
+/**
+* @struct FrameUniforms
+* @brief The CPU side of the `FrameData` std140 uniform block.
+*
+* The @ref GraphicsController writes it once per frame in @ref GraphicsController::begin_draw into the
+* @ref StreamBuffer and binds that range to @ref FrameUniforms::BINDING, and the @ref resources::ShaderCompiler connects every shader program that
+* declares the block to that binding. Shaders that declare the block don't need the view and projection uniforms:
+* @code
+* layout (std140) uniform FrameData {
+*     mat4 view;
+*     mat4 projection;
+*     mat4 view_projection;
+*     vec4 camera_position; // xyz
+*     float time;
+* };
+* @endcode
+*/
+struct alignas(16) FrameUniforms {
+    /**
+    * @brief Name of the uniform block in the shaders.
+    */
+    static constexpr std::string_view BLOCK_NAME = "FrameData";
+
+    /**
+    * @brief Uniform buffer binding point of the block.
+    */
+    static constexpr uint32_t BINDING = 0;
+
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 view_projection;
+    glm::vec4 camera_position;
+    /**
+    * @brief Seconds since the platform initialization, at the beginning of the current frame.
+    */
+    float time;
+    float padding[3];
+};
+
+static_assert(sizeof(FrameUniforms) == 224, "FrameUniforms must match the std140 layout of the FrameData block.");
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_FRAME_UNIFORMS_HPP
@@ -0,0 +1,63 @@
+/**
+ * @file Frustum.hpp
+ * @brief Defines the Frustum class used to cull the objects outside the camera view.
+*/
+
+#ifndef MATF_RG_PROJECT_FRUSTUM_HPP
+#define MATF_RG_PROJECT_FRUSTUM_HPP
+
+#include <array>
+#include <cstddef>
+#include <engine/graphics/Bounds.hpp>
+#include <glm/glm.hpp>
+
+namespace engine::graphics {
+/**
+* @class Frustum
+* @brief The six planes of the view frustum, with the normals pointing inside.
+*
+* The planes are stored as a structure of arrays and padded to eight lanes with planes that contain everything,
+* so the tests are straight-line loops over 8 floats that the compiler vectorizes.
+*/
+class Frustum {
+public:
+    static constexpr size_t PLANE_COUNT = 6;
+    static constexpr size_t LANE_COUNT = 8;
+
+    /**
+    * @brief Contains everything; nothing is culled.
+    */
+    Frustum();
+
+    /**
+    * @brief Extracts the planes from the `view_projection` matrix (Gribb-Hartmann), in world space.
+    * For the camera frustum pass `projection_matrix() * camera->view_matrix()`.
+    */
+    static Frustum from_matrix(const glm::mat4 &view_projection);
+
+    /**
+    * @brief Returns false if the `sphere` is completely outside the frustum.
+    */
+    bool intersects(const BoundingSphere &sphere) const;
+
+    /**
+    * @brief Returns false if the `aabb` is completely outside the frustum. Conservative near the frustum corners.
+    */
+    bool intersects(const AABB &aabb) const;
+
+    /**
+    * @brief Returns the plane `index` as (normal, distance); a point p is inside if dot(normal, p) + distance >= 0.
+    */
+    glm::vec4 plane(size_t index) const {
+        return {m_normal_x[index], m_normal_y[index], m_normal_z[index], m_distance[index]};
+    }
+
+private:
+    alignas(32) std::array<float, LANE_COUNT> m_normal_x{};
+    alignas(32) std::array<float, LANE_COUNT> m_normal_y{};
+    alignas(32) std::array<float, LANE_COUNT> m_normal_z{};
+    alignas(32) std::array<float, LANE_COUNT> m_distance{};
+};
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_FRUSTUM_HPP
@@ -0,0 +1,186 @@
+/**
+ * @file GeometryPool.hpp
+ * @brief Defines the GeometryPool class that stores the vertices and indices of all the static meshes in one buffer.
+*/
+
+#ifndef MATF_RG_PROJECT_GEOMETRY_POOL_HPP
+#define MATF_RG_PROJECT_GEOMETRY_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+
+namespace engine::resources {
+struct Vertex;
+}
+
+namespace engine::graphics {
+/**
+* @class RangeAllocator
+* @brief Hands out ranges of [0, capacity) with the first fit, and merges the freed ranges with their neighbours.
+*/
+class RangeAllocator {
+public:
+    /**
+    * @brief Makes the [capacity(), capacity) range available too.
+    */
+    void grow(uint32_t capacity);
+
+    /**
+    * @returns The first element of a free range of `count` elements, or nothing if no range is big enough.
+    */
+    std::optional<uint32_t> allocate(uint32_t count);
+
+    /**
+    * @brief Returns the range of `count` elements from the `first` to the allocator.
+    */
+    void free(uint32_t first, uint32_t count);
+
+    uint32_t capacity() const {
+        return m_capacity;
+    }
+
+    /**
+    * @brief Number of the elements in the allocated ranges.
+    */
+    uint32_t used() const {
+        return m_used;
+    }
+
+private:
+    /**
+    * @brief Free ranges, first element -> number of elements.
+    */
+    std::map<uint32_t, uint32_t> m_free;
+    uint32_t m_capacity{};
+    uint32_t m_used{};
+};
+
+/**
+* @struct GeometryRange
+* @brief Where a mesh is in the @ref GeometryPool; the arguments of its glDrawElementsBaseVertex.
+*/
+struct GeometryRange {
+    /**
+    * @brief Index of the first vertex of the mesh in the vertex buffer; added to every index.
+    */
+    uint32_t base_vertex{};
+    uint32_t vertex_count{};
+    /**
+    * @brief Position of the first index of the mesh in the index buffer.
+    */
+    uint32_t first_index{};
+    uint32_t index_count{};
+};
+
+/**
+* @class GeometryPool
+* @brief Stores the vertices and indices of all the static meshes in one vertex and one index buffer, read through a
+* single vertex array object with the @ref resources::Vertex layout.
+*
+* The meshes only remember their @ref GeometryRange and draw with glDrawElementsBaseVertex, so consecutive draws
+* don't switch the vertex array, and the driver manages two big buffers instead of hundreds of small ones:
+* @code
+* auto &pool = graphics->geometry_pool();
+* GeometryRange range = pool.allocate(vertices, indices);
+* pool.bind();
+* glDrawElementsBaseVertex(GL_TRIANGLES, range.index_count, GL_UNSIGNED_INT,
+*                          (void *) (range.first_index * sizeof(uint32_t)), range.base_vertex);
+* @endcode
+* The indices are relative to the first vertex of their mesh. When a buffer is full, the pool moves the data into a
+* buffer twice the size with glCopyBufferSubData; the ranges stay the same.
+*/
+class GeometryPool {
+public:
+    /**
+    * @brief Creates the buffers and the vertex array. Called by the @ref GraphicsController.
+    * @param vertex_capacity Number of vertices that fit before the vertex buffer grows.
+    * @param index_capacity Number of indices that fit before the index buffer grows.
+    */
+    void initialize(uint32_t vertex_capacity, uint32_t index_capacity);
+
+    /**
+    * @brief Deletes the buffers and the vertex array. Called by the @ref GraphicsController.
+    */
+    void terminate();
+
+    /**
+    * @brief Copies the mesh into the pool.
+    */
+    GeometryRange allocate(std::span<const resources::Vertex> vertices, std::span<const uint32_t> indices);
+
+    /**
+    * @brief Makes the `range` available to the next meshes.
+    */
+    void free(const GeometryRange &range);
+
+    /**
+    * @brief Binds the vertex array of the pool, unless it's already bound.
+    */
+    void bind() const;
+
+    /**
+    * @brief Points the per-instance model matrix attributes, at the locations
+    * @ref resources::Mesh::INSTANCE_MODEL_LOCATION and the next three, to the `buffer` from the byte `offset`.
+    * Binds the vertex array of the pool.
+    */
+    void attach_instance_buffer(uint32_t buffer, size_t offset);
+
+    /**
+    * @brief Disables the per-instance attributes again, so that the draws without instances don't read the buffer.
+    */
+    void detach_instance_buffer();
+
+    uint32_t vertex_array() const {
+        return m_vertex_array;
+    }
+
+    uint32_t vertex_buffer() const {
+        return m_vertex_buffer;
+    }
+
+    uint32_t index_buffer() const {
+        return m_index_buffer;
+    }
+
+    /**
+    * @brief Number of vertices in the pool, and how many fit before it grows.
+    */
+    uint32_t vertices_used() const {
+        return m_vertices.used();
+    }
+
+    uint32_t vertex_capacity() const {
+        return m_vertices.capacity();
+    }
+
+    uint32_t indices_used() const {
+        return m_indices.used();
+    }
+
+    uint32_t index_capacity() const {
+        return m_indices.capacity();
+    }
+
+private:
+    /**
+    * @brief Moves the contents of the `buffer` into a new buffer of `new_size` bytes, and deletes the old one.
+    */
+    static void grow_buffer(uint32_t &buffer, size_t old_size, size_t new_size);
+
+    /**
+    * @brief Points the vertex attributes 0-4 of the vertex array to the vertex buffer, and attaches the index buffer.
+    */
+    void setup_vertex_array();
+
+    uint32_t m_vertex_array{};
+    uint32_t m_vertex_buffer{};
+    uint32_t m_index_buffer{};
+    RangeAllocator m_vertices;
+    RangeAllocator m_indices;
+};
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_GEOMETRY_POOL_HPP
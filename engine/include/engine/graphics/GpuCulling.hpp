@@ -0,0 +1,266 @@
+/**
+ * @file GpuCulling.hpp
+ * @brief Defines the GpuCulling class that culls the indirect draws of the RenderQueue in a compute shader.
+*/
+
+#ifndef MATF_RG_PROJECT_GPU_CULLING_HPP
+#define MATF_RG_PROJECT_GPU_CULLING_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include <engine/graphics/Bounds.hpp>
+#include <engine/graphics/Frustum.hpp>
+#include <engine/graphics/RenderQueue.hpp>
+#include <engine/graphics/StreamBuffer.hpp>
+#include <engine/resources/Shader.hpp>
+#include <glm/glm.hpp>
+
+namespace engine::graphics {
+/**
+* @struct CullingDraw
+* @brief A draw for the culling compute shader, laid out as its std430 `Draws` buffer.
+*/
+struct CullingDraw {
+    /**
+    * @brief The bounding box of the mesh in the model space; w is unused.
+    */
+    glm::vec4 aabb_min{};
+    glm::vec4 aabb_max{};
+    /**
+    * @brief The draw, whose @ref DrawElementsIndirectCommand::base_instance is also the index of its model matrix.
+    */
+    DrawElementsIndirectCommand command{};
+    /**
+    * @brief The multi-draw the draw belongs to; its counter is incremented for every visible draw.
+    */
+    uint32_t batch{};
+    /**
+    * @brief Where the commands of the batch begin in the output buffer.
+    */
+    uint32_t batch_first{};
+    uint32_t padding{};
+};
+
+static_assert(sizeof(CullingDraw) == 64, "CullingDraw must match the std430 layout of the Draws buffer.");
+
+/**
+* @struct DepthPyramid
+* @brief The CPU copy of a depth pyramid: every level keeps the farthest depth of the texels of the previous level it
+* covers, level 0 being the depth buffer itself.
+*/
+struct DepthPyramid {
+    uint32_t width{};
+    uint32_t height{};
+    /**
+    * @brief The levels, row by row; level `l` is max(1, width >> l) by max(1, height >> l) texels.
+    */
+    std::vector<std::vector<float>> levels;
+
+    uint32_t level_width(uint32_t level) const {
+        return std::max(1u, width >> level);
+    }
+
+    uint32_t level_height(uint32_t level) const {
+        return std::max(1u, height >> level);
+    }
+
+    float texel(uint32_t level, uint32_t x, uint32_t y) const {
+        return levels[level][y * level_width(level) + x];
+    }
+};
+
+/**
+* @brief Builds the pyramid of the `depth` buffer, `width` by `height` values row by row, as the reduction compute
+* shader of the @ref GpuCulling does. An odd column or row is folded into the last texel of the next level.
+*/
+DepthPyramid build_depth_pyramid_reference(std::span<const float> depth, uint32_t width, uint32_t height);
+
+/**
+* @brief Returns true if the `aabb`, in the world space, is behind the depth of the `pyramid` built from a frame drawn
+* with the `view_projection`. Boxes crossing the camera plane are never occluded. The CPU reference of the compute
+* shader.
+*/
+bool is_occluded_reference(const AABB &aabb, const glm::mat4 &view_projection, const DepthPyramid &pyramid);
+
+/**
+* @class GpuCulling
+* @brief Culls the draws of the glMultiDrawElementsIndirect batches of the @ref RenderQueue in a compute shader, so
+* the CPU doesn't test the meshes one by one.
+*
+* One invocation per draw transforms the bounding box of the mesh by its model matrix and tests it against the
+* @ref Frustum and, with the occlusion culling enabled, against the depth pyramid built by
+* @ref GpuCulling::build_depth_pyramid at the end of the previous frame. The visible draws are compacted to the front
+* of the range of their batch with an atomic counter per batch:
+* @code
+* slot = atomicAdd(counts[draw.batch], 1);
+* commands[draw.batch_first + slot] = draw.command;
+* @endcode
+* The counter is the draw count of glMultiDrawElementsIndirectCount with OpenGL 4.6 or GL_ARB_indirect_parameters.
+* Otherwise the batch draws all its commands, and the ones past the counter were zeroed and draw nothing.
+*
+* The pyramid is tested with the view-projection of the previous frame, the one its depth was drawn with, so an
+* object that moved in front of the occluders since then can be missing for a frame.
+*
+* Needs OpenGL 4.3 for the compute shaders and the shader storage buffers, see @ref GpuCulling::is_supported.
+* The `validate` option compares the GPU counters with @ref GpuCulling::cull_reference every frame, which waits for
+* the GPU, and logs the differences. It's meant for checking a driver, e.g. Mesa llvmpipe in a headless run.
+*/
+class GpuCulling {
+public:
+    /**
+    * @brief Binding points of the shader storage buffers of the culling compute shader.
+    */
+    static constexpr uint32_t DRAWS_BINDING = 0;
+    static constexpr uint32_t TRANSFORMS_BINDING = 1;
+    static constexpr uint32_t COMMANDS_BINDING = 2;
+    static constexpr uint32_t COUNTS_BINDING = 3;
+
+    /**
+    * @brief Returns true if the context supports the compute shaders and the shader storage buffers.
+    */
+    static bool is_supported();
+
+    /**
+    * @brief Compiles the compute shaders. Called by the @ref RenderQueue if @ref GpuCulling::is_supported.
+    * @param occlusion Test the draws against the depth pyramid too, not only against the frustum.
+    * @param validate Compare the results with the CPU reference every frame.
+    */
+    void initialize(bool occlusion, bool validate);
+
+    /**
+    * @brief Deletes the compute shaders and the pyramid textures.
+    */
+    void terminate();
+
+    /**
+    * @brief The output of @ref GpuCulling::cull, valid until the end of the frame.
+    */
+    struct Result {
+        /**
+        * @brief The compacted @ref DrawElementsIndirectCommand, at the same offsets as the input draws.
+        */
+        StreamAllocation commands;
+        /**
+        * @brief The number of visible draws of each batch, as uint32_t.
+        */
+        StreamAllocation counts;
+    };
+
+    /**
+    * @brief Dispatches the culling of the `draws`, and issues the barrier for the indirect draws that read the result.
+    * @param draws The draws, sorted by batch.
+    * @param transforms The model matrices the @ref DrawElementsIndirectCommand::base_instance of the draws index,
+    * a storage allocation of the @ref StreamBuffer.
+    * @param batch_count The number of batches of the `draws`.
+    * @param frustum The camera frustum of the frame.
+    */
+    Result cull(std::span<const CullingDraw> draws, const StreamAllocation &transforms, uint32_t batch_count,
+                const Frustum &frustum);
+
+    /**
+    * @brief Copies the depth buffer of the bound read framebuffer, `width` by `height`, and reduces it into the
+    * depth pyramid for the next frame. Called by the @ref GraphicsController after the @ref RenderQueue::flush.
+    * @param view_projection The view-projection the frame was drawn with.
+    */
+    void build_depth_pyramid(int width, int height, const glm::mat4 &view_projection);
+
+    /**
+    * @brief Computes the number of visible draws of each batch on the CPU, as the compute shader does.
+    * @param pyramid The depth pyramid to test against, or null to test against the frustum only.
+    */
+    static std::vector<uint32_t> cull_reference(std::span<const CullingDraw> draws,
+                                                std::span<const glm::mat4> transforms, uint32_t batch_count,
+                                                const Frustum &frustum, const DepthPyramid *pyramid,
+                                                const glm::mat4 &pyramid_view_projection);
+
+    /**
+    * @brief Reads the counters of the `result` back and compares them with @ref GpuCulling::cull_reference.
+    * Waits for the GPU. Called by the @ref RenderQueue when the validation is enabled.
+    */
+    void validate(const Result &result, std::span<const CullingDraw> draws, std::span<const glm::mat4> transforms,
+                  uint32_t batch_count, const Frustum &frustum);
+
+    bool is_occlusion_enabled() const {
+        return m_occlusion;
+    }
+
+    void set_occlusion_enabled(bool enabled) {
+        m_occlusion = enabled;
+    }
+
+    bool is_validation_enabled() const {
+        return m_validate;
+    }
+
+    /**
+    * @brief Returns true if the multi-draws take their draw count from the GPU counters.
+    */
+    static bool has_indirect_count();
+
+    /**
+    * @brief Issues a glMultiDrawElementsIndirectCount of up to `max_draw_count` commands from the bound
+    * `GL_DRAW_INDIRECT_BUFFER` at `command_offset`, with the draw count at `count_offset` of the `count_buffer`.
+    */
+    static void multi_draw_indirect_count(size_t command_offset, uint32_t count_buffer, size_t count_offset,
+                                          uint32_t max_draw_count);
+
+private:
+    /**
+    * @brief Recreates the depth copy and the pyramid texture for a `width` by `height` framebuffer.
+    */
+    void resize(int width, int height);
+
+    std::unique_ptr<resources::Shader> m_cull_shader;
+    std::unique_ptr<resources::Shader> m_reduce_shader;
+
+    /**
+    * @brief The uniforms of the culling compute shader, set every frame.
+    */
+    struct CullUniforms {
+        resources::UniformHandle draw_count;
+        std::array<resources::UniformHandle, Frustum::PLANE_COUNT> frustum_planes;
+        resources::UniformHandle occlusion;
+        resources::UniformHandle pyramid_view_projection;
+        resources::UniformHandle pyramid_width;
+        resources::UniformHandle pyramid_height;
+        resources::UniformHandle pyramid_levels;
+        resources::UniformHandle depth_pyramid;
+    } m_cull_uniforms;
+
+    /**
+    * @brief The uniforms of the depth pyramid reduction compute shader, set for every level.
+    */
+    struct ReduceUniforms {
+        resources::UniformHandle source;
+        resources::UniformHandle source_level;
+        resources::UniformHandle copy;
+        resources::UniformHandle destination_width;
+        resources::UniformHandle destination_height;
+    } m_reduce_uniforms;
+    bool m_occlusion{true};
+    bool m_validate{false};
+
+    uint32_t m_depth_texture{};
+    uint32_t m_pyramid_texture{};
+    int m_width{};
+    int m_height{};
+    uint32_t m_pyramid_levels{};
+    /**
+    * @brief True once the pyramid holds a frame, so that the first frame doesn't test against an empty one.
+    */
+    bool m_pyramid_valid{false};
+    glm::mat4 m_pyramid_view_projection{1.0f};
+    /**
+    * @brief The CPU copy of the pyramid for the validation.
+    */
+    DepthPyramid m_pyramid_copy;
+    uint64_t m_validated_frames{};
+    uint64_t m_mismatched_frames{};
+};
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_GPU_CULLING_HPP
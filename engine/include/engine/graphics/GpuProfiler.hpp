@@ -0,0 +1,166 @@
+/**
+ * @file GpuProfiler.hpp
+ * @brief Defines the GpuProfiler class that measures how long the GPU spends on the parts of the frame.
+*/
+
+#ifndef MATF_RG_PROJECT_GPU_PROFILER_HPP
+#define MATF_RG_PROJECT_GPU_PROFILER_HPP
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <engine/util/Profiler.hpp>
+#include <engine/util/Utils.hpp>
+
+namespace engine::graphics {
+/**
+* @class GpuProfiler
+* @brief Measures named GPU scopes with `GL_TIMESTAMP` queries and reports them to the @ref util::Profiler.
+*
+* The queries of a frame are read @ref GpuProfiler::FRAME_LATENCY frames later, when the GPU has certainly finished
+* them, so reading the results never waits for the GPU. Frames whose results still aren't available by then are
+* dropped. The results are converted to the @ref util::Profiler clock and shown in its window and trace,
+* on the "GPU" lane.
+*
+* Measure a block of OpenGL calls with the @ref RG_GPU_PROFILE_SCOPE macro:
+* @code
+* RG_GPU_PROFILE_SCOPE("Model::draw");
+* for (auto &mesh: m_meshes) {
+*     mesh.draw(shader);
+* }
+* @endcode
+* If the driver doesn't count the time (`GL_QUERY_COUNTER_BITS` is 0, as on some software rasterizers), or the
+* @ref util::Profiler is disabled, the scopes do nothing.
+*/
+class GpuProfiler {
+public:
+    /**
+    * @brief Number of frames in flight between issuing the queries of a frame and reading them.
+    */
+    static constexpr uint32_t FRAME_LATENCY = 4;
+
+    /**
+    * @brief Scopes after this many in a frame aren't measured.
+    */
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME = 256;
+
+    static GpuProfiler *instance();
+
+    /**
+    * @brief Creates the queries if the driver supports timestamps. Called by the @ref GraphicsController.
+    */
+    void initialize();
+
+    /**
+    * @brief Deletes the queries. Called by the @ref GraphicsController.
+    */
+    void terminate();
+
+    bool is_supported() const {
+        return m_supported;
+    }
+
+    /**
+    * @brief Reads the results of the oldest frame in flight and starts measuring a new frame.
+    * Called by the @ref GraphicsController in @ref core::Controller::begin_draw.
+    */
+    void begin_frame();
+
+    /**
+    * @brief Stops measuring the frame. Called by the @ref GraphicsController in @ref core::Controller::end_draw.
+    */
+    void end_frame();
+
+    /**
+    * @brief Issues the timestamp at the beginning of a scope.
+    * @param name Name of the scope. Must outlive the profiler, e.g. a string literal.
+    * @returns Index of the scope, or @ref GpuProfiler::INVALID_SCOPE if the scope isn't measured.
+    */
+    uint32_t begin_scope(std::string_view name);
+
+    /**
+    * @brief Issues the timestamp at the end of the scope returned by @ref GpuProfiler::begin_scope.
+    */
+    void end_scope(uint32_t scope);
+
+    /**
+    * @brief Returns the GPU time of the last frame whose results were read, in nanoseconds.
+    */
+    uint64_t last_frame_time() const {
+        return m_last_frame_time;
+    }
+
+    /**
+    * @brief Returns the number of frames dropped because their results weren't available in time.
+    */
+    uint64_t dropped_frames() const {
+        return m_dropped_frames;
+    }
+
+    static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+private:
+    struct Scope {
+        std::string_view name;
+        uint32_t depth{};
+    };
+
+    struct Frame {
+        /**
+        * @brief Two timestamp queries per scope, the beginning and the end.
+        */
+        std::vector<uint32_t> queries;
+        std::vector<Scope> scopes;
+        /**
+        * @brief `util::Profiler::now() - GL_TIMESTAMP` at the beginning of the frame.
+        */
+        int64_t clock_offset{};
+        bool in_flight{false};
+    };
+
+    GpuProfiler() = default;
+
+    /**
+    * @brief Reads the results of the `frame` into the @ref util::Profiler, unless they aren't available yet.
+    */
+    void collect(Frame &frame);
+
+    std::array<Frame, FRAME_LATENCY> m_frames;
+    uint64_t m_frame_index{};
+    Frame *m_current{};
+    uint32_t m_depth{};
+    bool m_supported{false};
+    uint64_t m_last_frame_time{};
+    uint64_t m_dropped_frames{};
+    std::vector<util::ProfileEvent> m_events;
+};
+
+/**
+* @class GpuProfileScope
+* @brief Measures the GPU time of the OpenGL calls issued from the construction to the destruction.
+*/
+class GpuProfileScope {
+public:
+    explicit GpuProfileScope(std::string_view name) : m_scope(GpuProfiler::instance()->begin_scope(name)) {
+    }
+
+    ~GpuProfileScope() {
+        GpuProfiler::instance()->end_scope(m_scope);
+    }
+
+    GpuProfileScope(const GpuProfileScope &) = delete;
+
+    GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+
+private:
+    uint32_t m_scope;
+};
+
+/**
+* @brief Measures the GPU time of the rest of the enclosing block. The name must outlive the profiler.
+*/
+#define RG_GPU_PROFILE_SCOPE(name) engine::graphics::GpuProfileScope CONCAT(gpu_profile_scope_, __LINE__)(name)
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_GPU_PROFILER_HPP
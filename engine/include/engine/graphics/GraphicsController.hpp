@@ -6,7 +6,13 @@
 #ifndef GRAPHICSCONTROLLER_HPP
 #define GRAPHICSCONTROLLER_HPP
 
+#include <cstdint>
+#include <vector>
 #include <engine/graphics/Camera.hpp>
+#include <engine/graphics/FrameUniforms.hpp>
+#include <engine/graphics/GeometryPool.hpp>
+#include <engine/graphics/RenderQueue.hpp>
+#include <engine/graphics/StreamBuffer.hpp>
 #include <engine/core/Controller.hpp>
 #include <engine/platform/PlatformEventObserver.hpp>
 
@@ -78,18 +84,80 @@ public:
 
     /**
     * @brief Calls internal method for the ending of gui drawing. Should be called in pair with @ref GraphicsController::begin_gui.
+    * The gui is rendered in @ref GraphicsController::end_draw, on top of the @ref GraphicsController::render_queue.
     */
     void end_gui();
 
     /**
-    * @brief Draws a @ref resources::Skybox with the @ref resources::Shader.
+    * @brief Returns false if the app was started with `--no-gui`. The gui code still runs between
+    * @ref GraphicsController::begin_gui and @ref GraphicsController::end_gui, but ImGui isn't initialized for the
+    * window and nothing is rendered.
+    */
+    bool is_gui_enabled() const {
+        return m_gui_enabled;
+    }
+
+    /**
+    * @brief Returns the framebuffer a headless app renders into, or 0, the window framebuffer, otherwise.
+    */
+    uint32_t framebuffer() const {
+        return m_offscreen_framebuffer;
+    }
+
+    /**
+    * @brief Reads the pixels rendered into the @ref GraphicsController::framebuffer so far.
+    * @returns RGBA pixels of the whole framebuffer, the bottom row first.
+    */
+    std::vector<uint8_t> read_pixels() const;
+
+    /**
+    * @brief Queues a draw of the @ref resources::Skybox with the @ref resources::Shader into the @ref RenderPass::Skybox.
     */
     void draw_skybox(const resources::Shader *shader, const resources::Skybox *skybox);
 
+    /**
+    * @brief Returns the queue of the draws of the current frame. See @ref RenderQueue.
+    */
+    RenderQueue &render_queue() {
+        return m_render_queue;
+    }
+
+    /**
+    * @brief Returns the buffer for the data that changes every frame. See @ref StreamBuffer.
+    * Its size is `graphics.stream_buffer_kib` per frame from the config.json, and `graphics.persistent_mapping`
+    * turns the persistent mapping off.
+    */
+    StreamBuffer &stream_buffer() {
+        return m_stream_buffer;
+    }
+
+    /**
+    * @brief Returns the buffers that hold the vertices and indices of all the meshes. See @ref GeometryPool.
+    * Its initial size is `graphics.geometry_pool.vertices` and `graphics.geometry_pool.indices` from the config.json.
+    */
+    GeometryPool &geometry_pool() {
+        return m_geometry_pool;
+    }
+
+    /**
+    * @brief Returns the view frustum of the camera in the current frame, extracted from
+    * `projection_matrix() * camera()->view_matrix()` in @ref GraphicsController::begin_draw.
+    */
+    const Frustum &frustum() const {
+        return m_frustum;
+    }
+
     Camera *camera() {
         return &m_camera;
     }
 
+    /**
+    * @brief Returns the per-frame data uploaded to the `FrameData` uniform block in this frame. See @ref FrameUniforms.
+    */
+    const FrameUniforms &frame_uniforms() const {
+        return m_frame_uniforms;
+    }
+
     /**
     * @brief Compute the projection matrix.
     * @returns Return perspective projection by default.
@@ -159,7 +227,24 @@ private:
     */
     void initialize() override;
 
-    void terminate();
+    /**
+    * @brief Uploads the @ref FrameUniforms for the current camera and projection and begins the @ref RenderQueue.
+    */
+    void begin_draw() override;
+
+    /**
+    * @brief Submits the @ref RenderQueue and renders the gui.
+    */
+    void end_draw() override;
+
+    void terminate() override;
+
+    /**
+    * @brief Creates the color and depth renderbuffers of a headless app and binds them as the framebuffer.
+    */
+    void create_offscreen_framebuffer(int width, int height);
+
+    void destroy_offscreen_framebuffer();
 
     PerspectiveMatrixParams m_perspective_params{};
     OrthographicMatrixParams m_ortho_params{};
@@ -167,6 +252,21 @@ private:
     glm::mat4 m_projection_matrix{};
     Camera m_camera{};
     ImGuiContext *m_imgui_context{};
+
+    FrameUniforms m_frame_uniforms{};
+    StreamBuffer m_stream_buffer;
+    GeometryPool m_geometry_pool;
+
+    Frustum m_frustum{};
+    RenderQueue m_render_queue;
+    bool m_gui_pending{false};
+    bool m_gui_enabled{true};
+
+    uint32_t m_offscreen_framebuffer{};
+    uint32_t m_offscreen_color{};
+    uint32_t m_offscreen_depth{};
+    int m_offscreen_width{};
+    int m_offscreen_height{};
 };
 
 /**
@@ -0,0 +1,190 @@
+/**
+ * @file OcclusionCuller.hpp
+ * @brief Defines the OcclusionCuller class that rasterizes the occluders on the CPU and tests the meshes against them.
+*/
+
+#ifndef MATF_RG_PROJECT_OCCLUSION_CULLER_HPP
+#define MATF_RG_PROJECT_OCCLUSION_CULLER_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <engine/graphics/Bounds.hpp>
+#include <glm/glm.hpp>
+
+namespace engine::core {
+class JobSystem;
+}
+
+namespace engine::graphics {
+/**
+* @struct OccluderMesh
+* @brief A low-poly proxy of a model, rasterized by the @ref OcclusionCuller instead of the model itself.
+*/
+struct OccluderMesh {
+    std::vector<glm::vec3> vertices;
+    /**
+    * @brief Three per triangle.
+    */
+    std::vector<uint32_t> indices;
+    AABB aabb;
+
+    uint32_t triangle_count() const {
+        return static_cast<uint32_t>(indices.size() / 3);
+    }
+};
+
+/**
+* @brief Simplifies the triangles by vertex clustering, keeping the proxy on the source surface: the bounding box of
+* the `positions` is split into `grid` cells along every axis, and in every cell the vertices that lie inside one flat
+* region are merged into their average, if it lies on one of their triangles. The vertices on the outlines of the
+* surface, e.g. around a window, on the creases and corners, and on the curved and thin parts stay where they are, so
+* the proxy only gets simpler where the source is flat. The triangles that collapse are dropped.
+*
+* Every proxy triangle lies in the plane of the source triangle it comes from. A hole or a notch narrower than a cell
+* in the middle of a flat region can still be partly covered by the triangles around it.
+*/
+OccluderMesh build_occluder_mesh(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                                 uint32_t grid);
+
+/**
+* @class OcclusionCuller
+* @brief A software occlusion culler: rasterizes the occluders of a frame into a small depth buffer on the CPU and
+* tests the bounding boxes of the meshes against it before they are drawn.
+*
+* The buffer keeps 1/w, the inverse view depth, which is linear in the screen space and needs no near and far plane;
+* the bigger value is the nearer one, and the cleared buffer is 0, infinitely far away. It's split into tiles of
+* @ref OcclusionCuller::TILE_SIZE by @ref OcclusionCuller::TILE_SIZE pixels, and each tile also keeps its farthest
+* value, so most boxes are decided by a few tiles instead of all their pixels.
+*
+* A pixel is covered if its center is inside the triangle, and it gets the farthest depth of the triangle over the
+* pixel. A box is occluded only if its nearest point is behind every pixel its screen rectangle touches, and a box
+* crossing the camera plane never is. So a mesh can only be culled wrongly if it peeks out less than half a pixel of
+* the buffer past the edge of an occluder, or through a hole smaller than a cell of the proxy, see
+* @ref build_occluder_mesh.
+*
+* The rows of tiles are rasterized in parallel on the @ref core::JobSystem, every job writing only its own rows, and
+* the depth test keeps the nearest value whatever the order of the triangles, so the result is the same with any
+* number of workers and needs nothing from the GPU. The pixel loops run 8 pixels at a time with AVX, 4 with SSE2, and
+* one at a time elsewhere; configure with `RG_ENGINE_AVX2` to compile the AVX kernels in.
+* @code
+* culler.begin(view_projection);
+* culler.add_occluder(*model->occluder(), transform);
+* culler.rasterize(*jobs);
+* bool hidden = culler.is_occluded(mesh->bounds().aabb.transformed(transform));
+* @endcode
+*/
+class OcclusionCuller {
+public:
+    /**
+    * @brief The side of a tile in pixels, also the width of the widest SIMD kernel.
+    */
+    static constexpr uint32_t TILE_SIZE = 8;
+
+    /**
+    * @brief Allocates the depth buffer; the size is rounded up to whole tiles.
+    */
+    void initialize(uint32_t width, uint32_t height);
+
+    /**
+    * @brief Forgets the occluders of the previous frame and sets the camera of this one.
+    */
+    void begin(const glm::mat4 &view_projection);
+
+    /**
+    * @brief Queues the `occluder` to be rasterized with the `model` matrix. It must outlive the frame.
+    */
+    void add_occluder(const OccluderMesh &occluder, const glm::mat4 &model);
+
+    /**
+    * @brief Transforms, clips and rasterizes the queued occluders, and updates the farthest depth of every tile.
+    */
+    void rasterize(core::JobSystem &jobs);
+
+    /**
+    * @brief Returns true if the `aabb`, in the world space, is behind the occluders rasterized this frame.
+    * Safe to call from many threads after @ref OcclusionCuller::rasterize.
+    */
+    bool is_occluded(const AABB &aabb) const;
+
+    /**
+    * @brief Returns true if at least one occluder was rasterized this frame, so that testing is worth it.
+    */
+    bool has_occluders() const {
+        return !m_triangles.empty();
+    }
+
+    uint32_t width() const {
+        return m_width;
+    }
+
+    uint32_t height() const {
+        return m_height;
+    }
+
+    /**
+    * @brief Returns the 1/w of the pixel; the row 0 is at the bottom of the screen.
+    */
+    float depth(uint32_t x, uint32_t y) const {
+        return m_depth[y * m_width + x];
+    }
+
+    /**
+    * @brief Returns the triangles rasterized in the last frame, after the clipping.
+    */
+    uint32_t triangle_count() const {
+        return static_cast<uint32_t>(m_triangles.size());
+    }
+
+    /**
+    * @brief Returns the name of the compiled SIMD kernels, "AVX", "SSE2" or "scalar".
+    */
+    static const char *kernel_name();
+
+    /**
+    * @struct ScreenTriangle
+    * @brief A clipped triangle in pixels, with the 1/w of its vertices.
+    */
+    struct ScreenTriangle {
+        glm::vec3 vertices[3];
+    };
+
+private:
+    /**
+    * @brief Rasterizes the triangles that overlap the pixel rows [`first_row`, `last_row`) and computes the farthest
+    * depth of their tiles. The range is made of whole tile rows.
+    */
+    void rasterize_rows(uint32_t first_row, uint32_t last_row);
+
+    /**
+    * @struct Occluder
+    * @brief An occluder queued for this frame.
+    */
+    struct Occluder {
+        const OccluderMesh *mesh{};
+        glm::mat4 model{1.0f};
+    };
+
+    uint32_t m_width{};
+    uint32_t m_height{};
+    uint32_t m_tiles_x{};
+    uint32_t m_tiles_y{};
+    glm::mat4 m_view_projection{1.0f};
+    std::vector<Occluder> m_occluders;
+    /**
+    * @brief The clipped triangles of every occluder, and all of them in the order of the occluders.
+    */
+    std::vector<std::vector<ScreenTriangle>> m_occluder_triangles;
+    std::vector<ScreenTriangle> m_triangles;
+    /**
+    * @brief 1/w of every pixel, row by row from the bottom of the screen.
+    */
+    std::vector<float> m_depth;
+    /**
+    * @brief The smallest, farthest, 1/w of every tile.
+    */
+    std::vector<float> m_tile_depth;
+};
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_OCCLUSION_CULLER_HPP
@@ -8,7 +8,10 @@
 
 #include <cstdint>
 #include <filesystem>
+#include <string_view>
+#include <vector>
 #include <engine/resources/Shader.hpp>
+#include <engine/resources/Texture.hpp>
 
 namespace engine::resources {
 class Skybox;
@@ -80,10 +83,63 @@ public:
     */
     static uint32_t generate_texture(const std::filesystem::path &path, bool flip_uvs);
 
+    /**
+    * @brief Uploads the already decoded `image` into the OpenGL context.
+    * Use together with @ref resources::load_image to decode the image off the main thread.
+    *
+    * @param image decoded image.
+    * @returns OpenGL id of a texture object.
+    */
+    static uint32_t generate_texture(const resources::ImageData &image);
+
+    /**
+    * @brief Uploads the `texture` into the OpenGL context.
+    * Block-compressed levels are uploaded with `glCompressedTexImage2D` as they are, without generating the mipmaps.
+    * If the driver doesn't support the compressed format, the levels are decoded on the CPU and uploaded uncompressed.
+    *
+    * @param texture texture produced by @ref resources::TextureCache::import.
+    * @returns OpenGL id of a texture object.
+    */
+    static uint32_t generate_texture(const resources::TextureData &texture);
+
+    /**
+    * @brief Returns true if the driver can sample textures in the `format`.
+    */
+    static bool is_texture_format_supported(resources::TextureFormat format);
+
+    /**
+    * @brief Returns true if the OpenGL context supports the extension with the `name`, e.g. "GL_EXT_texture_compression_s3tc".
+    */
+    static bool has_extension(std::string_view name);
+
+    /**
+    * @brief Returns true if the OpenGL context has at least the version `major`.`minor`.
+    * The platform asks for a 4.6, 4.3 and then a 3.3 core context, and the drivers may create a newer version.
+    */
+    static bool is_version_at_least(int major, int minor);
+
+    /**
+    * @brief Loads an OpenGL function that glad doesn't load, because it's newer than OpenGL 3.3, e.g. glBufferStorage.
+    * Check @ref OpenGL::is_version_at_least or @ref OpenGL::has_extension first.
+    * @returns The function pointer, or null if the driver doesn't export it.
+    */
+    template<typename TFunction>
+    static TFunction load_function(const char *name) {
+        return reinterpret_cast<TFunction>(load_function_address(name));
+    }
+
+    static void *load_function_address(const char *name);
+
+    /**
+    * @brief Returns the vendor, renderer and version strings of the OpenGL context, e.g. to tell the benchmark
+    * results of a GPU from those of a software rasterizer.
+    */
+    static std::string renderer_description();
+
     /**
     * @brief Get texture format for a `number_of_channels`.
     * @param number_of_channels that the texture has.
-    * @returns GL_RED, GL_RGB, GL_RGBA for the number_of_channels=[1,3,4] respectively.
+    * @returns GL_RED, GL_RG, GL_RGB, GL_RGBA for the number_of_channels=[1,2,3,4] respectively.
     */
     static int32_t texture_format(int32_t number_of_channels);
 
@@ -119,6 +175,15 @@ public:
     */
     static uint32_t load_skybox_textures(const std::filesystem::path &path, bool flip_uvs = false);
 
+    /**
+    * @brief Uploads the already decoded skybox `faces` into a cubemap texture.
+    * Each face is assigned to the side of the cubemap based on the file name of its @ref resources::ImageData::path,
+    * the same way as in @ref OpenGL::load_skybox_textures(const std::filesystem::path &, bool).
+    * @param faces decoded images for the 6 sides of the cube.
+    * @returns OpenGL id to the cubemap texture
+    */
+    static uint32_t load_skybox_textures(const std::vector<resources::ImageData> &faces);
+
     /**
     * @brief Enables depth testing.
     */
@@ -141,6 +206,102 @@ public:
     */
     static std::string get_compilation_error_message(uint32_t shader_id);
 
+    /**
+    * @struct StateCacheStats
+    * @brief Number of state changing calls that went through the state cache.
+    */
+    struct StateCacheStats {
+        /**
+        * @brief Calls that changed the state and were sent to the driver.
+        */
+        uint64_t issued{};
+        /**
+        * @brief Calls that would set the state to its current value and were skipped.
+        */
+        uint64_t skipped{};
+    };
+
+    /**
+    * @brief Binds the shader `program`, unless it's already bound.
+    *
+    * The state functions below shadow the OpenGL state, so that redundant calls never reach the driver.
+    * Bind the programs, vertex arrays, textures, and buffers only through them; the direct OpenGL binds would leave
+    * the shadowed state stale. If some code changes the state behind the cache's back, call
+    * @ref OpenGL::invalidate_state_cache afterwards.
+    */
+    static void use_program(uint32_t program);
+
+    /**
+    * @brief Binds the `vertex_array`, unless it's already bound.
+    */
+    static void bind_vertex_array(uint32_t vertex_array);
+
+    /**
+    * @brief Binds the `texture` to the texture `unit` (0 for GL_TEXTURE0), unless it's already bound there.
+    * @param unit index of the texture unit.
+    * @param target GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.
+    * @param texture OpenGL id of the texture.
+    */
+    static void bind_texture(uint32_t unit, uint32_t target, uint32_t texture);
+
+    /**
+    * @brief Binds the `buffer` to the `target`, unless it's already bound.
+    * GL_ELEMENT_ARRAY_BUFFER is a part of the vertex array state and is always bound.
+    */
+    static void bind_buffer(uint32_t target, uint32_t buffer);
+
+    /**
+    * @brief Binds the `buffer` to the indexed binding point `index` of the `target`. Always sent to the driver.
+    */
+    static void bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer);
+
+    /**
+    * @brief Binds the `size` bytes of the `buffer` from the `offset` to the indexed binding point `index` of the
+    * `target`. Always sent to the driver. The `offset` must be aligned, see @ref StreamBuffer::allocate_uniform.
+    */
+    static void bind_buffer_range(uint32_t target, uint32_t index, uint32_t buffer, size_t offset, size_t size);
+
+    /**
+    * @brief Enables or disables GL_DEPTH_TEST.
+    */
+    static void set_depth_test(bool enabled);
+
+    /**
+    * @brief Sets the depth comparison function, e.g. GL_LESS.
+    */
+    static void set_depth_func(uint32_t func);
+
+    /**
+    * @brief Enables or disables writing into the depth buffer.
+    */
+    static void set_depth_mask(bool enabled);
+
+    /**
+    * @brief Enables or disables GL_BLEND.
+    */
+    static void set_blend(bool enabled);
+
+    /**
+    * @brief Sets the blend function, e.g. GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA.
+    */
+    static void set_blend_func(uint32_t source, uint32_t destination);
+
+    /**
+    * @brief Forgets the shadowed state, so that the next call of every state function reaches the driver.
+    * Call after the OpenGL objects are deleted, or after a library changed the state directly.
+    */
+    static void invalidate_state_cache();
+
+    /**
+    * @brief Starts counting the state cache calls for a new frame. Called by the @ref GraphicsController every frame.
+    */
+    static void begin_state_cache_frame();
+
+    /**
+    * @brief Returns the state cache counters of the previous frame.
+    */
+    static const StateCacheStats &state_cache_stats();
+
 private:
     /**
     * @brief Throws an engine::util::EngineError of type @ref engine::util::EngineError::Type::OpenGLError if an OpenGL error occurred. Used internally.
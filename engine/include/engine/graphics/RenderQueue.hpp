@@ -0,0 +1,420 @@
+/**
+ * @file RenderQueue.hpp
+ * @brief Defines the RenderQueue class that collects the draws of a frame and submits them sorted by state.
+*/
+
+#ifndef MATF_RG_PROJECT_RENDER_QUEUE_HPP
+#define MATF_RG_PROJECT_RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <engine/graphics/Frustum.hpp>
+#include <engine/graphics/OcclusionCuller.hpp>
+#include <glm/glm.hpp>
+
+namespace engine::resources {
+struct MeshBounds;
+
+class Mesh;
+class Model;
+class Shader;
+class Skybox;
+}
+
+namespace engine::graphics {
+class GpuCulling;
+struct CullingDraw;
+
+/**
+* @enum RenderPass
+* @brief The passes of a frame, submitted in the order of declaration.
+*/
+enum class RenderPass : uint8_t {
+    /**
+    * @brief Sorted by shader, material, and then front-to-back, so that the early depth test rejects hidden fragments.
+    */
+    Opaque,
+    /**
+    * @brief Drawn after the opaque geometry, only where nothing else was drawn.
+    */
+    Skybox,
+    /**
+    * @brief Sorted back-to-front and alpha blended, without writing into the depth buffer.
+    */
+    Transparent,
+};
+
+/**
+* @struct DrawPacket
+* @brief Everything needed to issue one draw call of the @ref RenderQueue.
+*/
+struct DrawPacket {
+    uint64_t key{};
+    const resources::Shader *shader{};
+    /**
+    * @brief The mesh to draw, or nullptr if the packet draws the @ref DrawPacket::skybox.
+    */
+    resources::Mesh *mesh{};
+    const resources::Skybox *skybox{};
+    /**
+    * @brief Set to the `model` uniform of the shader.
+    */
+    glm::mat4 model{1.0f};
+};
+
+/**
+* @struct DrawElementsIndirectCommand
+* @brief One draw of glMultiDrawElementsIndirect, laid out as OpenGL reads it from the `GL_DRAW_INDIRECT_BUFFER`.
+*/
+struct DrawElementsIndirectCommand {
+    uint32_t count{};
+    uint32_t instance_count{};
+    uint32_t first_index{};
+    int32_t base_vertex{};
+    /**
+    * @brief The first instance, and the index of the per-draw model matrix in the instance buffer.
+    */
+    uint32_t base_instance{};
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20);
+
+/**
+* @struct RenderQueueStats
+* @brief What the @ref RenderQueue submitted in one frame.
+*/
+struct RenderQueueStats {
+    /**
+    * @brief OpenGL draw calls; a multi-draw counts once, however many meshes it draws.
+    */
+    uint32_t draw_calls{};
+    /**
+    * @brief Meshes drawn by the glMultiDrawElementsIndirect calls.
+    */
+    uint32_t indirect_draws{};
+    uint64_t triangles{};
+    uint32_t shader_changes{};
+    uint32_t material_changes{};
+    /**
+    * @brief Meshes submitted and inside the frustum. The meshes culled on the GPU count as visible, the CPU doesn't
+    * know which they are.
+    */
+    uint32_t visible{};
+    /**
+    * @brief Meshes submitted but skipped because they were outside the frustum.
+    */
+    uint32_t culled{};
+    /**
+    * @brief Meshes inside the frustum but hidden behind the occluders of the @ref OcclusionCuller; not counted as
+    * visible.
+    */
+    uint32_t occluded{};
+    /**
+    * @brief Triangles of the occluder proxies rasterized by the @ref OcclusionCuller.
+    */
+    uint32_t occluder_triangles{};
+};
+
+/**
+* @struct RenderQueueSettings
+* @brief The optional paths of the @ref RenderQueue, used where the context supports them.
+*/
+struct RenderQueueSettings {
+    bool multi_draw_indirect{true};
+    /**
+    * @brief Cull the meshes of the multi-draws in a compute shader, see @ref GpuCulling.
+    */
+    bool gpu_culling{true};
+    bool occlusion_culling{true};
+    /**
+    * @brief Compare the GPU culling with its CPU reference every frame.
+    */
+    bool validate_culling{false};
+    /**
+    * @brief Cull the meshes hidden behind the occluder models on the CPU, see @ref OcclusionCuller.
+    */
+    bool software_occlusion{true};
+    /**
+    * @brief The size of the depth buffer of the @ref OcclusionCuller.
+    */
+    uint32_t software_occlusion_width{256};
+    uint32_t software_occlusion_height{144};
+};
+
+/**
+* @class RenderQueue
+* @brief Collects the draw packets of a frame and submits them with as few state changes as possible.
+*
+* Every packet gets a 64-bit sort key, with the most significant bits first:
+* @code
+* Opaque, Skybox:  pass (2) | shader (12) | material (16) | depth (24)       | unused (10)
+* Transparent:     pass (2) | inverted depth (24)         | shader (12)      | material (16) | unused (10)
+* @endcode
+* Sorting the keys groups the opaque draws by shader and material and orders them front-to-back inside each group,
+* while the transparent draws come out back-to-front.
+*
+* The meshes whose bounds are outside the camera @ref Frustum are culled in @ref RenderQueue::submit and never queued.
+*
+* With OpenGL 4.3, or GL_ARB_multi_draw_indirect and GL_ARB_base_instance, the consecutive packets that share the
+* shader and the textures are drawn by one glMultiDrawElementsIndirect, if the shader reads the model matrix from the
+* per-instance attribute, `layout (location = 5) in mat4 aInstanceModel;`, instead of the `model` uniform.
+* The flush streams the model matrices of these packets and one @ref DrawElementsIndirectCommand per packet through
+* the @ref StreamBuffer; each command draws one instance whose @ref DrawElementsIndirectCommand::base_instance
+* selects its matrix. So the CPU cost of a batch doesn't depend on the number of meshes in it. Without the support
+* the packets are drawn one by one, with the matrix set as the constant value of the attribute.
+*
+* With OpenGL 4.3 the meshes of the multi-draws aren't culled in @ref RenderQueue::submit but by the @ref GpuCulling
+* compute shader, against the frustum and the depth of the previous frame.
+*
+* The models with an @ref resources::Model::occluder proxy submitted into the @ref RenderPass::Opaque are also
+* rasterized by the @ref OcclusionCuller, and the flush drops the meshes hidden behind them before sorting, on the CPU
+* and within the frame. A model whose nodes were moved has no proxy anymore, so it's drawn but doesn't occlude.
+*
+* The @ref GraphicsController owns the queue, begins it in @ref core::Controller::begin_draw and submits it in
+* @ref core::Controller::end_draw, so the controllers only submit the packets in their @ref core::Controller::draw:
+* @code
+* auto graphics = engine::core::Controller::get<engine::graphics::GraphicsController>();
+* graphics->render_queue().submit(shader, backpack, glm::scale(glm::mat4(1.0f), glm::vec3(scale)));
+* @endcode
+*/
+class RenderQueue {
+public:
+    RenderQueue();
+
+    ~RenderQueue();
+
+    /**
+    * @brief Loads glMultiDrawElementsIndirect and creates the @ref GpuCulling if the context supports them, and
+    * allocates the depth buffer of the @ref OcclusionCuller. Called by the @ref GraphicsController.
+    */
+    void initialize(const RenderQueueSettings &settings);
+
+    /**
+    * @brief Deletes the OpenGL objects of the @ref GpuCulling. Called by the @ref GraphicsController.
+    */
+    void terminate();
+
+    /**
+    * @brief Clears the packets of the previous frame and sets the camera used to cull the meshes and to compute the
+    * depth of the packets.
+    * @param view The view matrix of the camera.
+    * @param view_projection The projection times the view matrix, which the occluders are rasterized with.
+    * @param frustum The view frustum of the camera in the world space.
+    * @param near The distance of the near plane; the packets closer than it get the depth 0.
+    * @param far The distance of the far plane; the packets further than it get the maximum depth.
+    */
+    void begin(const glm::mat4 &view, const glm::mat4 &view_projection, const Frustum &frustum, float near, float far);
+
+    /**
+    * @brief Queues a draw of the `mesh` with the `shader`.
+    * @param shader The shader to draw with; it should have the `model` uniform or the `aInstanceModel` attribute.
+    * @param mesh The mesh to draw. It must outlive the frame.
+    * @param model The model matrix of the mesh.
+    * @param pass The pass in which the mesh is drawn.
+    */
+    void submit(const resources::Shader *shader, resources::Mesh *mesh, const glm::mat4 &model,
+                RenderPass pass = RenderPass::Opaque);
+
+    /**
+    * @brief Queues a draw of every mesh of the `model`, with the `transform` times the world transform of its node.
+    * If the whole model is outside the frustum, its meshes aren't tested one by one. Queues the @ref resources::Model::occluder of an opaque model for the @ref OcclusionCuller.
+    */
+    void submit(const resources::Shader *shader, resources::Model *model, const glm::mat4 &transform,
+                RenderPass pass = RenderPass::Opaque);
+
+    /**
+    * @brief Queues a draw of the `skybox` into the @ref RenderPass::Skybox.
+    */
+    void submit(const resources::Shader *shader, const resources::Skybox *skybox);
+
+    /**
+    * @brief Sorts the packets and draws them. Restores the default depth and blend state afterwards.
+    */
+    void flush();
+
+    /**
+    * @brief Returns what the last @ref RenderQueue::flush submitted and how many meshes were culled in that frame.
+    */
+    const RenderQueueStats &stats() const {
+        return m_stats;
+    }
+
+    /**
+    * @brief Enables or disables the frustum culling in @ref RenderQueue::submit. Enabled by default.
+    */
+    void set_culling_enabled(bool enabled) {
+        m_culling_enabled = enabled;
+    }
+
+    bool is_culling_enabled() const {
+        return m_culling_enabled;
+    }
+
+    /**
+    * @brief Returns true if the context supports the glMultiDrawElementsIndirect path.
+    */
+    bool is_multi_draw_indirect_supported() const {
+        return m_multi_draw_indirect_supported;
+    }
+
+    /**
+    * @brief Enables or disables the glMultiDrawElementsIndirect path, e.g. to compare it with the per-mesh draws.
+    * Has no effect if the path isn't supported.
+    */
+    void set_multi_draw_indirect_enabled(bool enabled) {
+        m_multi_draw_indirect_enabled = enabled && m_multi_draw_indirect_supported;
+    }
+
+    bool is_multi_draw_indirect_enabled() const {
+        return m_multi_draw_indirect_enabled;
+    }
+
+    /**
+    * @brief Returns the GPU culling, or null if the context doesn't support it.
+    */
+    GpuCulling *gpu_culling() {
+        return m_gpu_culling.get();
+    }
+
+    /**
+    * @brief Enables or disables the culling of the multi-draws on the GPU. Has no effect if it isn't supported.
+    */
+    void set_gpu_culling_enabled(bool enabled) {
+        m_gpu_culling_enabled = enabled && m_gpu_culling;
+    }
+
+    /**
+    * @brief Returns true if the meshes of the multi-draws are culled on the GPU. Needs the multi-draws and the
+    * culling enabled too.
+    */
+    bool is_gpu_culling_enabled() const {
+        return m_gpu_culling_enabled && m_culling_enabled && m_multi_draw_indirect_enabled;
+    }
+
+    /**
+    * @brief Enables or disables the culling behind the occluders on the CPU.
+    */
+    void set_software_occlusion_enabled(bool enabled) {
+        m_software_occlusion_enabled = enabled;
+    }
+
+    /**
+    * @brief Returns true if the meshes hidden behind the occluders are culled. Needs the culling enabled too.
+    */
+    bool is_software_occlusion_enabled() const {
+        return m_software_occlusion_enabled && m_culling_enabled;
+    }
+
+    const OcclusionCuller &occlusion_culler() const {
+        return m_occlusion_culler;
+    }
+
+    /**
+    * @brief Returns the packets submitted since the last @ref RenderQueue::begin.
+    */
+    const std::vector<DrawPacket> &packets() const {
+        return m_packets;
+    }
+
+    /**
+    * @brief Computes the sort key of a packet. The `depth` is in the range [0, 1], 0 being the near plane.
+    */
+    static uint64_t sort_key(RenderPass pass, uint32_t shader_id, uint32_t material, float depth);
+
+private:
+    /**
+    * @brief Returns the distance of the `position` from the camera, mapped to [0, 1] between the near and far plane.
+    */
+    float normalized_depth(const glm::vec3 &position) const;
+
+    /**
+    * @brief Returns true if the `bounds` transformed by the `model` matrix intersect the frustum.
+    * Tests the sphere first and the box only if the sphere intersects.
+    */
+    bool is_visible(const resources::MeshBounds &bounds, const glm::mat4 &model) const;
+
+    void draw_skybox(const DrawPacket &packet) const;
+
+    /**
+    * @brief Rasterizes the occluders of the frame and removes the packets of the meshes hidden behind them.
+    */
+    void cull_occluded();
+
+    /**
+    * @brief Returns true if the packet is drawn by a glMultiDrawElementsIndirect.
+    */
+    bool is_indirect(const DrawPacket &packet) const;
+
+    /**
+    * @brief Groups the indirect packets into the @ref RenderQueue::m_indirect_batches, streams their model matrices
+    * and indirect commands, culled on the GPU if enabled, and attaches the matrices as the instance buffer of the
+    * @ref GeometryPool.
+    */
+    void prepare_indirect_draws();
+
+    /**
+    * @brief Draws the batch with one glMultiDrawElementsIndirect, or glMultiDrawElementsIndirectCount after the
+    * GPU culling.
+    */
+    void draw_indirect(uint32_t batch_index);
+
+    /**
+    * @struct IndirectBatch
+    * @brief The packets [`first`, `last`) of @ref RenderQueue::m_sorted, which share the shader and the textures.
+    */
+    struct IndirectBatch {
+        size_t first{};
+        size_t last{};
+        /**
+        * @brief Index of the command of the `first` packet.
+        */
+        uint32_t first_command{};
+    };
+
+    std::vector<DrawPacket> m_packets;
+    /**
+    * @brief The keys of the packets and their indices, sorted instead of the packets themselves.
+    */
+    std::vector<std::pair<uint64_t, uint32_t>> m_sorted;
+    glm::mat4 m_view{1.0f};
+    Frustum m_frustum{};
+    bool m_culling_enabled{true};
+    bool m_multi_draw_indirect_supported{false};
+    bool m_multi_draw_indirect_enabled{false};
+    std::unique_ptr<GpuCulling> m_gpu_culling;
+    bool m_gpu_culling_enabled{false};
+    OcclusionCuller m_occlusion_culler;
+    bool m_software_occlusion_enabled{false};
+    /**
+    * @brief Whether each packet is occluded, filled in parallel by @ref RenderQueue::cull_occluded.
+    */
+    std::vector<uint8_t> m_occluded;
+    /**
+    * @brief The batches, model matrices and commands of the multi-draws of the frame, in the sorted order.
+    */
+    std::vector<IndirectBatch> m_indirect_batches;
+    std::vector<glm::mat4> m_indirect_transforms;
+    std::vector<DrawElementsIndirectCommand> m_indirect_commands;
+    std::vector<CullingDraw> m_culling_draws;
+    /**
+    * @brief Offset of the first command in the bound `GL_DRAW_INDIRECT_BUFFER`.
+    */
+    size_t m_indirect_offset{};
+    /**
+    * @brief The buffer and the offset of the per-batch draw counts written by the GPU culling, if it ran.
+    */
+    uint32_t m_indirect_count_buffer{};
+    size_t m_indirect_count_offset{};
+    float m_near{0.1f};
+    float m_far{100.0f};
+    /**
+    * @brief Counters of the frame in progress, published into @ref RenderQueue::m_stats at the end of the flush.
+    */
+    RenderQueueStats m_frame_stats{};
+    RenderQueueStats m_stats{};
+};
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_RENDER_QUEUE_HPP
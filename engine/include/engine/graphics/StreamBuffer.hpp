@@ -0,0 +1,196 @@
+/**
+ * @file StreamBuffer.hpp
+ * @brief Defines the StreamBuffer class that sub-allocates the per-frame dynamic data from a ring of GPU buffer regions.
+*/
+
+#ifndef MATF_RG_PROJECT_STREAM_BUFFER_HPP
+#define MATF_RG_PROJECT_STREAM_BUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace engine::graphics {
+/**
+* @struct StreamAllocation
+* @brief A range of a @ref StreamBuffer that stays valid until the end of the frame.
+*/
+struct StreamAllocation {
+    /**
+    * @brief Where to write the data; `size` bytes. Write only, never read from it, it may be uncached GPU memory.
+    */
+    void *data{};
+    /**
+    * @brief The OpenGL buffer to bind for the draws that read the data.
+    */
+    uint32_t buffer{};
+    /**
+    * @brief Offset of the data in the `buffer`, aligned as requested.
+    */
+    size_t offset{};
+    size_t size{};
+};
+
+/**
+* @class StreamBuffer
+* @brief Streams the data that changes every frame, e.g. instance transforms and uniform blocks, to the GPU without
+* stalling on the draws of the previous frames.
+*
+* The buffer has a region for each of the @ref StreamBuffer::FRAMES_IN_FLIGHT frames. A frame allocates from its own
+* region while the GPU still reads the regions of the previous frames. Before a region is reused, the CPU waits for the
+* fence placed after the last draw that read it, which normally has long signaled.
+*
+* With OpenGL 4.4 or GL_ARB_buffer_storage the buffer is allocated with glBufferStorage and stays mapped, persistent
+* and coherent, so the data is written straight into the GPU-visible memory. Otherwise the buffer holds one region,
+* orphaned with glBufferData at the beginning of every frame, and @ref StreamBuffer::commit uploads the data with
+* glBufferSubData.
+* @code
+* auto &stream = graphics->stream_buffer();
+* auto allocation = stream.allocate(transforms.size_bytes(), alignof(glm::mat4));
+* std::memcpy(allocation.data, transforms.data(), transforms.size_bytes());
+* stream.commit(allocation);
+* // bind allocation.buffer and read from allocation.offset
+* @endcode
+* A frame that needs more than a region grows the buffer. The old buffer is deleted once the GPU is done with it.
+*/
+class StreamBuffer {
+public:
+    /**
+    * @brief Number of frames whose data may be in use by the GPU at the same time.
+    */
+    static constexpr uint32_t FRAMES_IN_FLIGHT = 3;
+
+    /**
+    * @brief Creates the buffer, with `frame_capacity` bytes for each frame. Called by the @ref GraphicsController.
+    * @param persistent Use persistent mapping if the driver supports it.
+    */
+    void initialize(size_t frame_capacity, bool persistent);
+
+    /**
+    * @brief Deletes the buffers. Called by the @ref GraphicsController.
+    */
+    void terminate();
+
+    /**
+    * @brief Moves to the region of the next frame, waiting for the GPU to finish reading it if needed.
+    * Called by the @ref GraphicsController in @ref core::Controller::begin_draw.
+    */
+    void begin_frame();
+
+    /**
+    * @brief Fences the draws that read the region of the frame.
+    * Called by the @ref GraphicsController in @ref core::Controller::end_draw, after all the draws.
+    */
+    void end_frame();
+
+    /**
+    * @brief Allocates `size` bytes for the current frame.
+    * @param alignment Alignment of the @ref StreamAllocation::offset, a power of two.
+    */
+    StreamAllocation allocate(size_t size, size_t alignment = 16);
+
+    /**
+    * @brief Allocates `size` bytes for a uniform block, aligned to `GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT`, so that it
+    * can be bound with @ref OpenGL::bind_buffer_range.
+    */
+    StreamAllocation allocate_uniform(size_t size) {
+        return allocate(size, m_uniform_alignment);
+    }
+
+    /**
+    * @brief Allocates `size` bytes for a shader storage block, aligned to `GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT`.
+    */
+    StreamAllocation allocate_storage(size_t size) {
+        return allocate(size, m_storage_alignment);
+    }
+
+    /**
+    * @brief Makes the data written into the `allocation` visible to the draws issued after this call.
+    * Does nothing for a persistent buffer; uploads the data for the fallback.
+    */
+    void commit(const StreamAllocation &allocation);
+
+    bool is_persistent() const {
+        return m_persistent;
+    }
+
+    /**
+    * @brief Bytes each frame can allocate without growing the buffer.
+    */
+    size_t frame_capacity() const {
+        return m_frame_capacity;
+    }
+
+    /**
+    * @brief Bytes allocated in the current frame, including the alignment padding.
+    */
+    size_t frame_used() const {
+        return m_offset;
+    }
+
+    /**
+    * @brief Number of times @ref StreamBuffer::begin_frame had to wait for the GPU since the initialization.
+    * Growing steadily means the GPU is more than @ref StreamBuffer::FRAMES_IN_FLIGHT frames behind.
+    */
+    uint64_t stalls() const {
+        return m_stalls;
+    }
+
+private:
+    /**
+    * @brief A buffer replaced by a bigger one while the GPU could still read it.
+    */
+    struct RetiredBuffer {
+        uint32_t buffer{};
+        void *fence{};
+        std::unique_ptr<std::byte[]> shadow;
+    };
+
+    /**
+    * @brief Creates the buffer with `frame_capacity` bytes per frame.
+    */
+    void create(size_t frame_capacity);
+
+    /**
+    * @brief Replaces the buffer with one that has at least `frame_capacity` bytes per frame, in the middle of a frame.
+    */
+    void grow(size_t frame_capacity);
+
+    /**
+    * @brief Offset of the region of the current frame in the buffer.
+    */
+    size_t region_begin() const {
+        return m_persistent ? m_frame * m_frame_capacity : 0;
+    }
+
+    void delete_finished_retired_buffers();
+
+    uint32_t m_buffer{};
+    size_t m_frame_capacity{};
+    bool m_persistent{false};
+    /**
+    * @brief The persistent mapping of the whole buffer.
+    */
+    std::byte *m_mapped{};
+    /**
+    * @brief The CPU copy of the region that @ref StreamBuffer::commit uploads from, for the fallback.
+    */
+    std::unique_ptr<std::byte[]> m_shadow;
+
+    uint32_t m_frame{};
+    size_t m_offset{};
+    /**
+    * @brief GLsync of the last frame that used each region, null if there is nothing to wait for.
+    */
+    std::array<void *, FRAMES_IN_FLIGHT> m_fences{};
+    std::vector<RetiredBuffer> m_retired;
+
+    size_t m_uniform_alignment{256};
+    size_t m_storage_alignment{256};
+    uint64_t m_stalls{};
+};
+} // namespace engine::graphics
+
+#endif//MATF_RG_PROJECT_STREAM_BUFFER_HPP
@@ -7,6 +7,8 @@
 #define MATF_RG_PROJECT_PLATFORM_H
 
 #include <engine/core/Controller.hpp>
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <engine/platform/Input.hpp>
@@ -37,6 +39,115 @@ struct FrameTime {
     float current;
 };
 
+/**
+* @struct FixedTimestep
+* @brief Describes how the frame maps onto the fixed-rate simulation steps of @ref core::App::fixed_update.
+*
+* Every frame adds its @ref FrameTime::dt to an accumulator and runs as many whole steps as fit into it. The
+* leftover time is expressed as @ref FixedTimestep::alpha, so the rendering can interpolate between the last two
+* simulated states:
+* @code
+* void update() override {
+*     float alpha = platform->fixed_timestep().alpha;
+*     m_rendered_position = glm::mix(m_previous_position, m_position, alpha);
+* }
+* @endcode
+*/
+struct FixedTimestep {
+    /**
+    * @brief Duration of one step in seconds, 1 / `app.fixed_update.rate` from the config.json.
+    */
+    float step{1.0f / 60.0f};
+
+    /**
+    * @brief The most steps a single frame runs, `app.fixed_update.max_steps` from the config.json. A frame that
+    * falls further behind drops the rest of the time instead of making the next frame even slower.
+    */
+    uint32_t max_steps{5};
+
+    /**
+    * @brief Number of steps the current frame runs.
+    */
+    uint32_t steps{};
+
+    /**
+    * @brief Time accumulated, but not simulated yet, in seconds. Always less than one @ref FixedTimestep::step.
+    */
+    float accumulator{};
+
+    /**
+    * @brief `accumulator / step`, in [0, 1): how far the current frame is past the last simulated state.
+    */
+    float alpha{};
+
+    /**
+    * @brief Total number of steps dropped because of @ref FixedTimestep::max_steps.
+    */
+    uint64_t dropped_steps{};
+};
+
+/**
+* @brief How the buffer swap waits for the vertical blank, `window.vsync` in the config.json.
+*/
+enum class VSync {
+    /**
+    * @brief `"off"`: swap right away, may tear.
+    */
+    Off,
+    /**
+    * @brief `"on"`: wait for the vertical blank.
+    */
+    On,
+    /**
+    * @brief `"adaptive"`: wait for the vertical blank, but swap right away if the frame missed it. Falls back to
+    * @ref VSync::On where the driver doesn't support it.
+    */
+    Adaptive,
+};
+
+/**
+* @struct FramePacing
+* @brief Presentation settings, read from the `window` section of the config.json.
+*/
+struct FramePacing {
+    VSync vsync{VSync::On};
+
+    /**
+    * @brief The frame limiter sleeps after the buffer swap so that the app presents at most this many frames per
+    * second, `window.max_fps`. 0 means no limit.
+    */
+    float max_fps{0.0f};
+
+    /**
+    * @brief The limit while the window is unfocused or minimized, `window.background_fps`. 0 means the same as
+    * in the foreground.
+    */
+    float background_fps{0.0f};
+};
+
+/**
+* @struct FramePacingStats
+* @brief Statistics of the time between the presented frames, over the last
+* @ref PlatformController::FRAME_PACING_HISTORY frames. All the times are in milliseconds.
+*/
+struct FramePacingStats {
+    /**
+    * @brief Frame time the limiter aims for, 0 if it's not limiting.
+    */
+    float target_ms{};
+    float mean_ms{};
+    /**
+    * @brief Standard deviation of the frame time.
+    */
+    float jitter_ms{};
+    float max_ms{};
+    /**
+    * @brief Frames that took more than one and a half of the target frame time.
+    */
+    uint32_t late_frames{};
+    uint32_t frames{};
+};
+
 /**
 * @class PlatformController
 * @brief Registers Platform events such as mouse movement, key press, window events...
@@ -93,6 +204,69 @@ public:
         return m_frame_time.dt;
     }
 
+    /**
+    * @brief Get the @ref FixedTimestep for the current frame. Updated in @ref core::App::loop
+    */
+    const FixedTimestep &fixed_timestep() const {
+        return m_fixed_timestep;
+    }
+
+    /**
+    * @brief Get the presentation settings.
+    */
+    const FramePacing &frame_pacing() const {
+        return m_frame_pacing;
+    }
+
+    /**
+    * @brief Changes the presentation settings, e.g. from a settings menu. Takes effect with the next swap.
+    */
+    void set_frame_pacing(const FramePacing &frame_pacing);
+
+    /**
+    * @brief Computes the @ref FramePacingStats of the recent frames.
+    */
+    FramePacingStats frame_pacing_stats() const;
+
+    /**
+    * @brief Number of the frames the @ref FramePacingStats cover.
+    */
+    static constexpr uint32_t FRAME_PACING_HISTORY = 240;
+
+    /**
+    * @brief Returns true if the app was started with `--headless`. The window is then invisible, or doesn't exist at
+    * all if there's no display, and the @ref graphics::GraphicsController renders into an offscreen framebuffer.
+    */
+    bool is_headless() const {
+        return m_headless;
+    }
+
+    /**
+    * @brief Get the number of frames started since the initialization.
+    */
+    uint64_t frame_count() const {
+        return m_frame_count;
+    }
+
+    /**
+    * @brief The app stops after this many frames, 0 means no limit. Set by `--frames <count>`.
+    */
+    uint64_t frame_limit() const {
+        return m_frame_limit;
+    }
+
+    /**
+    * @brief Overrides the frame limit, e.g. for a benchmark that knows how many frames it needs.
+    */
+    void set_frame_limit(uint64_t frame_limit) {
+        m_frame_limit = frame_limit;
+    }
+
+    /**
+    * @brief Number of frames a headless app runs if `--frames` isn't passed.
+    */
+    static constexpr uint64_t DEFAULT_HEADLESS_FRAMES = 300;
+
     /**
     *  @brief Enables/disabled the visibility of the cursor on screen.
     */
@@ -100,6 +274,7 @@ public:
 
     /**
     * @brief Swaps the current draw buffer for the main window. Should be called at the end of the frame.
+    * Then waits as long as the frame limiter of the @ref FramePacing requires.
     */
     void swap_buffers();
 
@@ -151,10 +326,68 @@ private:
 
     void update_key(Key &key_data) const;
 
+    /**
+    * @brief Creates the hidden window of a headless app. Without a display it falls back to the GLFW null platform
+    * with an EGL surfaceless or an OSMesa context, e.g. Mesa llvmpipe on a build machine without a GPU.
+    */
+    GLFWwindow *create_headless_window(int width, int height, const std::string &title);
+
+    /**
+    * @brief Creates the window with the newest OpenGL core context out of 4.6, 4.3 and 3.3 that the driver provides.
+    * The engine only needs 3.3; the newer versions enable the optional paths, e.g. glMultiDrawElementsIndirect.
+    */
+    GLFWwindow *create_window(int width, int height, const std::string &title);
+
+    /**
+    * @brief Adds the time of the frame to the accumulator and computes the steps of the frame.
+    */
+    void advance_fixed_timestep(float dt);
+
+    /**
+    * @brief Sets the swap interval for the @ref FramePacing::vsync.
+    */
+    void apply_vsync();
+
+    /**
+    * @brief Waits until the frame limiter lets the next frame start, and records the frame time for the
+    * @ref FramePacingStats.
+    */
+    void pace_frame();
+
+    /**
+    * @brief Returns true if the user isn't looking at the window: it's unfocused or minimized.
+    */
+    bool is_in_background() const;
+
+    /**
+    * @brief The frame limit that applies now, 0 if none.
+    */
+    float frame_rate_limit() const;
+
     FrameTime m_frame_time;
+    FixedTimestep m_fixed_timestep;
     Window m_window;
     std::vector<Key> m_keys;
     std::vector<std::unique_ptr<PlatformEventObserver> > m_platform_event_observers;
+    bool m_headless{false};
+    uint64_t m_frame_count{};
+    uint64_t m_frame_limit{};
+
+    FramePacing m_frame_pacing;
+    /**
+    * @brief The moment the last frame was presented, or its ideal moment while the limiter keeps up, in seconds.
+    */
+    double m_last_present{};
+    /**
+    * @brief Ring buffer of the last @ref PlatformController::FRAME_PACING_HISTORY frame times, in seconds.
+    */
+    std::array<float, FRAME_PACING_HISTORY> m_present_intervals{};
+    uint32_t m_present_count{};
+    double m_previous_present{};
+    /**
+    * @brief False until the first frame is presented, which only starts the timer.
+    */
+    bool m_pacing_started{false};
 };
 } // namespace engine
 
@@ -7,7 +7,11 @@
 #define MATF_RG_PROJECT_MESH_HPP
 
 #include <glm/glm.hpp>
+#include <string>
 #include <vector>
+#include <engine/graphics/Bounds.hpp>
+#include <engine/graphics/GeometryPool.hpp>
+#include <engine/resources/Shader.hpp>
 #include <engine/resources/Texture.hpp>
 
 namespace engine::resources {
@@ -24,14 +28,96 @@ struct Vertex {
     glm::vec3 Bitangent;
 };
 
+/**
+* @struct TextureReference
+* @brief A texture that a mesh material references by path, before the texture is loaded.
+*/
+struct TextureReference {
+    std::filesystem::path path;
+    TextureType type;
+};
+
+/**
+* @struct MeshBounds
+* @brief Bounding volumes of a mesh in its local space.
+*/
+struct MeshBounds {
+    graphics::AABB aabb;
+    graphics::BoundingSphere sphere;
+};
+
+/**
+* @brief Computes the bounds of the `vertices`. The sphere is centered in the center of the `aabb`.
+* @param vertices The vertices of the mesh.
+* @param aabb The bounding box of the vertices, if it's already known, e.g. from Assimp.
+*/
+MeshBounds compute_bounds(const std::vector<Vertex> &vertices, const graphics::AABB &aabb);
+
+/**
+* @brief Computes the bounds of the `vertices`.
+*/
+MeshBounds compute_bounds(const std::vector<Vertex> &vertices);
+
+/**
+* @struct MeshData
+* @brief Represents a mesh in the CPU memory, before it is uploaded to the OpenGL context.
+*
+* Produced by the model import, which doesn't touch the OpenGL context and can run on worker threads.
+*/
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<TextureReference> textures;
+    MeshBounds bounds;
+};
+
+/**
+* @struct NodeData
+* @brief A node of the scene hierarchy of a model, before it is loaded into a @ref Model.
+*/
+struct NodeData {
+    std::string name;
+    /**
+    * @brief The transform relative to the parent node.
+    */
+    glm::mat4 transform{1.0f};
+    /**
+    * @brief Index of the parent node, always smaller than the index of the node, or -1 for the root.
+    */
+    int32_t parent{-1};
+    /**
+    * @brief Indices of the @ref ModelData::meshes drawn with the transform of the node. Many nodes can reference
+    * the same mesh, which is then stored and uploaded once.
+    */
+    std::vector<uint32_t> meshes;
+};
+
+/**
+* @struct ModelData
+* @brief Represents a model in the CPU memory: its meshes and the hierarchy of nodes that places them.
+*/
+struct ModelData {
+    std::vector<MeshData> meshes;
+    /**
+    * @brief The nodes in the depth-first order, so every parent comes before its children.
+    */
+    std::vector<NodeData> nodes;
+};
+
 /**
 * @class Mesh
 * @brief Represents a mesh in the model in the OpenGL context.
 */
 class Mesh {
-    friend class AssimpSceneProcessor;
+    friend class ResourcesController;
+    friend class Model;
 
 public:
+    /**
+    * @brief First attribute location of the per-instance model matrix used by @ref Mesh::draw_instanced.
+    * The matrix takes four locations, one per column: `layout (location = 5) in mat4 aInstanceModel;`
+    */
+    static constexpr uint32_t INSTANCE_MODEL_LOCATION = 5;
 
     /**
     * @brief Draws the mesh using a given shader. Called by the @ref Model::draw function to draw all the meshes in the model.
@@ -39,6 +125,54 @@ public:
     */
     void draw(const Shader *shader);
 
+    /**
+    * @brief Draws `instance_count` instances of the mesh with a single draw call. Called by the @ref Model::draw_instanced function.
+    * The per-instance model matrices are read from the instance buffer attached by the @ref Model.
+    * @param shader The shader to use for drawing.
+    * @param instance_count The number of instances to draw.
+    */
+    void draw_instanced(const Shader *shader, uint32_t instance_count);
+
+    /**
+    * @brief Returns a 16-bit hash of the textures of the mesh. The meshes with the same textures have the same key.
+    * Used by the @ref graphics::RenderQueue to group the draws by material.
+    */
+    uint16_t material_key() const;
+
+    /**
+    * @brief Returns true if the `other` mesh has the same textures, so that the two can be drawn without rebinding them.
+    */
+    bool has_same_material(const Mesh &other) const {
+        return m_textures == other.m_textures;
+    }
+
+    /**
+    * @brief Binds the textures to the sampler uniforms of the `shader`. Called by @ref Mesh::draw, and by the
+    * @ref graphics::RenderQueue once for all the meshes of a multi-draw.
+    */
+    void bind_textures(const Shader *shader);
+
+    /**
+    * @brief Returns the bounding volumes of the mesh in the model space.
+    */
+    const MeshBounds &bounds() const {
+        return m_bounds;
+    }
+
+    /**
+    * @brief Returns the number of indices drawn by @ref Mesh::draw, three per triangle.
+    */
+    uint32_t index_count() const {
+        return m_geometry.index_count;
+    }
+
+    /**
+    * @brief Returns where the vertices and indices of the mesh are in the @ref graphics::GeometryPool.
+    */
+    const graphics::GeometryRange &geometry() const {
+        return m_geometry;
+    }
+
     /**
     * @brief Destroys the mesh in the OpenGL context.
     */
@@ -46,17 +180,29 @@ public:
 
 private:
     /**
-    * @brief Constructs a Mesh object.
+    * @brief Constructs a Mesh object and copies its vertices and indices into the @ref graphics::GeometryPool.
     * @param vertices The vertices in the mesh.
     * @param indices The indices in the mesh.
     * @param textures The textures in the mesh.
+    * @param bounds The bounding volumes of the vertices.
      */
     Mesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
-         std::vector<Texture *> textures);
+         std::vector<Texture *> textures, const MeshBounds &bounds);
 
-    uint32_t m_vao{0};
-    uint32_t m_num_indices{0};
+    graphics::GeometryRange m_geometry;
     std::vector<Texture *> m_textures;
+    MeshBounds m_bounds;
+
+    /**
+    * @brief Sampler uniform name for each texture, following the @ref Texture::uniform_name_convention, e.g. "texture_diffuse1".
+    */
+    std::vector<std::string> m_sampler_names;
+
+    /**
+    * @brief Sampler uniforms looked up in the shader with the id @ref Mesh::m_sampler_shader_id, the last one the mesh was drawn with.
+    */
+    std::vector<UniformHandle> m_sampler_uniforms;
+    uint32_t m_sampler_shader_id{0};
 };
 } // namespace engine
 
@@ -0,0 +1,100 @@
+/**
+ * @file MeshCache.hpp
+ * @brief Defines the MeshCache class that stores imported models in a binary format, so that the warm starts skip Assimp.
+*/
+
+#ifndef MATF_RG_PROJECT_MESH_CACHE_HPP
+#define MATF_RG_PROJECT_MESH_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include <engine/resources/Mesh.hpp>
+
+namespace engine::resources {
+/**
+* @class MeshCache
+* @brief Stores the result of the @ref ModelImporter in a versioned binary file per model.
+*
+* A cache file is valid only for the same source path, source modification time and size, import flags
+* (including `flip_uvs`), @ref MeshCache::VERSION, and `sizeof(Vertex)`. Otherwise, the model is imported again and the
+* cache file is rewritten.
+*
+* File layout, all the numbers are little-endian and every section starts at a 16 byte aligned offset:
+* @code
+* MeshCacheHeader
+* for each mesh:
+*     MeshCacheRecord
+*     for each texture: uint32_t type, uint32_t path_length, char path[path_length]
+*     Vertex vertices[vertex_count]
+*     uint32_t indices[index_count]
+* for each node:
+*     MeshCacheNodeRecord
+*     uint32_t meshes[mesh_count], char name[name_length]
+* @endcode
+* Vertex and index sections are stored exactly in the layout that the @ref Mesh copies into the
+* @ref graphics::GeometryPool,
+* so loading a mesh is a single read per section.
+*
+* All the functions are safe to call from multiple threads.
+*/
+class MeshCache {
+public:
+    /**
+    * @brief Bump when the @ref ModelData or the file layout changes.
+    */
+    static constexpr uint32_t VERSION = 4;
+
+    /**
+    * @brief Directory of the cache files, relative to the working directory of the app.
+    */
+    static constexpr std::string_view DEFAULT_DIRECTORY = "resources/cache/models";
+
+    /**
+    * @param cache_directory directory where the cache files are stored.
+    * @param enabled if false, @ref MeshCache::import always imports the model with Assimp and doesn't write the cache.
+    */
+    explicit MeshCache(std::filesystem::path cache_directory, bool enabled = true)
+            : m_cache_directory(std::move(cache_directory))
+              , m_enabled(enabled) {
+    }
+
+    /**
+    * @brief Loads the model from the cache if the cache is valid, otherwise imports it with the @ref ModelImporter
+    * and stores the result in the cache.
+    * @param model_path path to the model file.
+    * @param flip_uvs flip the texture coordinates on import.
+    * @returns The meshes and the nodes of the model.
+    */
+    ModelData import(const std::filesystem::path &model_path, bool flip_uvs) const;
+
+    /**
+    * @brief Loads the model from the cache.
+    * @returns The meshes and the nodes of the model, or nothing if there's no valid cache file for the model.
+    */
+    std::optional<ModelData> load(const std::filesystem::path &model_path, bool flip_uvs) const;
+
+    /**
+    * @brief Writes the `model` into the cache file for the model.
+    * @returns true if the cache file was written.
+    */
+    bool store(const std::filesystem::path &model_path, bool flip_uvs, const ModelData &model) const;
+
+    /**
+    * @brief Returns the path of the cache file for the model. The name depends on the source path and the import flags.
+    */
+    std::filesystem::path cache_file_path(const std::filesystem::path &model_path, bool flip_uvs) const;
+
+    const std::filesystem::path &cache_directory() const {
+        return m_cache_directory;
+    }
+
+private:
+    std::filesystem::path m_cache_directory;
+    bool m_enabled;
+};
+} // namespace engine::resources
+
+#endif//MATF_RG_PROJECT_MESH_CACHE_HPP
@@ -6,25 +6,133 @@
 #ifndef MATF_RG_PROJECT_MODEL_HPP
 #define MATF_RG_PROJECT_MODEL_HPP
 
+#include <engine/graphics/OcclusionCuller.hpp>
 #include <engine/resources/Mesh.hpp>
 #include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
 #include <utility>
+#include <glm/glm.hpp>
 
 namespace engine::resources {
+/**
+* @struct MeshInstance
+* @brief A mesh of the model placed by a node, drawn with the world transform of the node.
+*/
+struct MeshInstance {
+    uint32_t mesh{};
+    uint32_t node{};
+};
+
 /**
 * @class Model
-* @brief Represents a model object within the OpenGL context as an array of @ref Mesh objects.
+* @brief Represents a model object within the OpenGL context as an array of @ref Mesh objects, placed by a hierarchy
+* of nodes.
+*
+* The nodes are a flat table in the depth-first order, every parent before its children, stored as parallel arrays
+* of the parent indices, the ends of the subtrees, the local transforms and the world transforms. The descendants of a
+* node are the contiguous range up to the end of its subtree, so changing a local transform only records the node, and
+* @ref Model::update_transforms recomputes the world transforms of the changed subtrees in one linear sweep each,
+* O(changed nodes and their descendants). The bounds of the model depend on every mesh, so they're recomputed from all
+* the instances, but only on the next @ref Model::bounds after a change. The @ref Model::occluder proxy is baked from
+* the node transforms of the file, so moving a node also stops the model from occluding:
+* @code
+* auto door = model->find_node("Door");
+* model->set_local_transform(*door, glm::rotate(model->local_transform(*door), angle, glm::vec3(0, 1, 0)));
+* model->update_transforms(); // also done by the draws
+* @endcode
 */
 class Model {
     friend class ResourcesController;
 
 public:
     /**
-    * @brief Draws the model using a given shader by drawing all the meshes in the model.
+    * @brief Draws the model using a given shader by drawing all the meshes in the model. The meshes are drawn with
+    * the `model` uniform the caller has set, without the transforms of their nodes.
     * @param shader The shader to use for drawing.
     */
     void draw(const Shader *shader);
 
+    /**
+    * @brief Draws all the meshes of the model placed by their nodes: sets the `model` uniform of the shader to the
+    * `transform` times the world transform of the node of each mesh. If the shader reads the per-instance
+    * `aInstanceModel` attribute instead, a mesh placed by many nodes is drawn once, with one instance per node.
+    * @param shader The shader to use for drawing.
+    * @param transform The model matrix of the whole model.
+    */
+    void draw(const Shader *shader, const glm::mat4 &transform);
+
+    /**
+    * @brief Draws one instance of the model for each of the `transforms`, with one draw call per mesh, however many
+    * nodes place it.
+    * The transforms are written into the @ref graphics::StreamBuffer and passed to the `shader` as a per-instance attribute:
+    * @code
+    * layout (location = 5) in mat4 aInstanceModel; // instead of the model uniform
+    * @endcode
+    * See the basic_instanced.glsl shader in the test app.
+    * @param shader The shader to use for drawing.
+    * @param transforms Model matrix of each instance, multiplied by the world transform of the node of each mesh.
+    */
+    void draw_instanced(const Shader *shader, std::span<const glm::mat4> transforms);
+
+    /**
+    * @brief Returns the meshes as placed by the nodes, sorted by mesh; a model without a hierarchy has one root node.
+    */
+    const std::vector<MeshInstance> &instances() const {
+        return m_instances;
+    }
+
+    uint32_t node_count() const {
+        return static_cast<uint32_t>(m_parents.size());
+    }
+
+    /**
+    * @brief Returns the index of the first node with the `name`, or nothing if there's none.
+    */
+    std::optional<uint32_t> find_node(std::string_view name) const;
+
+    /**
+    * @brief Returns the name of the node from the model file.
+    */
+    const std::string &node_name(uint32_t node) const {
+        return m_node_names[node];
+    }
+
+    /**
+    * @brief Returns the index of the parent of the `node`, or -1 for the root.
+    */
+    int32_t parent(uint32_t node) const {
+        return m_parents[node];
+    }
+
+    /**
+    * @brief Returns the transform of the `node` relative to its parent.
+    */
+    const glm::mat4 &local_transform(uint32_t node) const {
+        return m_local_transforms[node];
+    }
+
+    /**
+    * @brief Sets the transform of the `node` relative to its parent, and records it for the
+    * @ref Model::update_transforms. Marks the @ref Model::occluder proxy stale.
+    */
+    void set_local_transform(uint32_t node, const glm::mat4 &transform);
+
+    /**
+    * @brief Recomputes the world transforms of the changed nodes and their descendants, and marks the bounds for
+    * recomputing. Does nothing if no node changed.
+    */
+    void update_transforms();
+
+    /**
+    * @brief Returns the transform of the `node` in the model space, as of the last @ref Model::update_transforms.
+    */
+    const glm::mat4 &world_transform(uint32_t node) const {
+        return m_world_transforms[node];
+    }
+
     /**
     * @brief Destroys the model in the OpenGL context.
     */
@@ -38,6 +146,36 @@ public:
         return m_meshes;
     }
 
+    /**
+    * @brief Returns the meshes in the model.
+    * @returns The meshes in the model.
+    */
+    std::vector<Mesh> &meshes() {
+        return m_meshes;
+    }
+
+    /**
+    * @brief Returns the bounding volumes that contain all the meshes of the model, placed by their nodes, in the
+    * model space. Recomputed from all the instances on the first call after the transforms changed.
+    */
+    const MeshBounds &bounds() const {
+        if (m_bounds_dirty) {
+            update_bounds();
+        }
+        return m_bounds;
+    }
+
+    /**
+    * @brief Returns the low-poly proxy the @ref graphics::OcclusionCuller rasterizes for the model, or null if the
+    * model isn't an occluder. Built at load for the models with `"occluder": true` in the config.json.
+    *
+    * The proxy is baked in the bind pose, so it's null too once a node was moved by
+    * @ref Model::set_local_transform: in the old pose it could hide the meshes that are visible now.
+    */
+    const graphics::OccluderMesh *occluder() const {
+        return m_occluder && !m_occluder_stale ? &*m_occluder : nullptr;
+    }
+
     /**
     * @brief Returns the path to the model file from which the model was loaded.
     * @returns The path to the model.
@@ -59,6 +197,26 @@ private:
     * @brief The meshes in the model.
     */
     std::vector<Mesh> m_meshes;
+    std::vector<MeshInstance> m_instances;
+    /**
+    * @brief The node table, one element per node in each array.
+    */
+    std::vector<std::string> m_node_names;
+    std::vector<int32_t> m_parents;
+    /**
+    * @brief One past the last descendant of every node; the subtree of the node `i` is [i, m_subtree_ends[i]).
+    */
+    std::vector<uint32_t> m_subtree_ends;
+    std::vector<glm::mat4> m_local_transforms;
+    std::vector<glm::mat4> m_world_transforms;
+    /**
+    * @brief The nodes whose local transforms changed since the last @ref Model::update_transforms.
+    */
+    std::vector<uint32_t> m_dirty_nodes;
+    mutable MeshBounds m_bounds;
+    mutable bool m_bounds_dirty{false};
+    std::optional<graphics::OccluderMesh> m_occluder;
+    bool m_occluder_stale{false};
     /**
     * @brief The path to the model file from which the model was loaded.
     */
@@ -70,17 +228,27 @@ private:
 
     Model() = default;
 
+    /**
+    * @brief Computes the @ref Model::m_bounds from the bounds of the meshes transformed by their nodes.
+    */
+    void update_bounds() const;
+
+    /**
+    * @brief Streams `transforms` times the world transform of every instance of a mesh, and draws each mesh with one
+    * instanced draw call. The `shader` must be in use.
+    */
+    void draw_mesh_instances(const Shader *shader, std::span<const glm::mat4> transforms);
+
     /**
     * @brief Constructs a Model object. Used internally by the @ref engine::resources::ResourcesController class. You are not supposed to call this constructor directly from user code.
     * @param meshes The meshes in the model.
+    * @param nodes The node hierarchy, parents first, whose @ref NodeData::meshes index the `meshes`. If empty, one
+    * root node draws all the meshes.
     * @param path The path to the model file from which the model was loaded.
     * @param name The name of the model by which it can be referenced using the @ref engine::resources::ResourcesController::model function.
     */
-    Model(std::vector<Mesh> meshes, std::filesystem::path path,
-          std::string name) : m_meshes(std::move(meshes))
-                              , m_path(std::move(path))
-                              , m_name(std::move(name)) {
-    }
+    Model(std::vector<Mesh> meshes, const std::vector<NodeData> &nodes, std::filesystem::path path,
+          std::string name);
 };
 } // namespace engine
 
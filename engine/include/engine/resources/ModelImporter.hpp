@@ -0,0 +1,43 @@
+/**
+ * @file ModelImporter.hpp
+ * @brief Defines the ModelImporter class that imports model files into the CPU memory using Assimp.
+*/
+
+#ifndef MATF_RG_PROJECT_MODEL_IMPORTER_HPP
+#define MATF_RG_PROJECT_MODEL_IMPORTER_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include <engine/resources/Mesh.hpp>
+
+namespace engine::resources {
+/**
+* @class ModelImporter
+* @brief Imports model files with Assimp and converts them into @ref ModelData. Doesn't touch the OpenGL context.
+*
+* The node hierarchy of the scene is kept as a flat table of @ref NodeData with their local transforms, so the parts
+* of a model stay where the artist placed them without baking the transforms into the vertices. Every aiMesh is
+* converted once, however many nodes reference it; the nodes are its instances.
+*
+* Prefer @ref MeshCache::import, which skips Assimp when the model was already imported with the same settings.
+*/
+class ModelImporter {
+public:
+    /**
+    * @brief Imports the model file at `model_path`. Safe to call from any thread.
+    * Throws @ref engine::util::EngineError::Type::AssetLoadingError if Assimp can't read the model.
+    * @param model_path path to the model file.
+    * @param flip_uvs flip the texture coordinates on import.
+    * @returns The meshes and the nodes of the model.
+    */
+    static ModelData import(const std::filesystem::path &model_path, bool flip_uvs);
+
+    /**
+    * @brief Returns the Assimp post-processing flags that @ref ModelImporter::import uses.
+    */
+    static uint32_t import_flags(bool flip_uvs);
+};
+} // namespace engine::resources
+
+#endif//MATF_RG_PROJECT_MODEL_IMPORTER_HPP
@@ -0,0 +1,121 @@
+/**
+ * @file ResourceHandle.hpp
+ * @brief Defines the ResourceHandle class that references a resource which may still be loading.
+*/
+
+#ifndef MATF_RG_PROJECT_RESOURCE_HANDLE_HPP
+#define MATF_RG_PROJECT_RESOURCE_HANDLE_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace engine::resources {
+/**
+* @enum LoadState
+* @brief The state of an asynchronous resource load.
+*/
+enum class LoadState {
+    /**
+    * @brief The resource is still loading; @ref ResourceHandle::get returns the placeholder.
+    */
+    Pending,
+    /**
+    * @brief The resource is loaded and uploaded to the OpenGL context.
+    */
+    Ready,
+    /**
+    * @brief The resource failed to load; @ref ResourceHandle::get keeps returning the placeholder.
+    */
+    Failed
+};
+
+/**
+* @brief Converts a @ref LoadState to a string.
+*/
+std::string_view to_string(LoadState state);
+
+/**
+* @class ResourceHandle
+* @brief A handle to a resource requested through one of the `*_async` functions of the @ref ResourcesController.
+*
+* The handle is returned right away. The resource is loaded on the worker threads, uploaded to the OpenGL context on
+* the main thread once per frame, during @ref core::App::loop, and only then the handle becomes @ref LoadState::Ready.
+* Until then @ref ResourceHandle::get returns a placeholder, so the handle can be drawn in every frame.
+* Handles are meant to be used from the main thread only.
+* @code
+* auto resources = engine::core::Controller::get<engine::resources::ResourcesController>();
+* m_backpack = resources->model_async("backpack");
+* ...
+* m_backpack->draw(shader); // draws the placeholder cube until the backpack is loaded
+* @endcode
+*/
+template<typename TResource>
+class ResourceHandle {
+    friend class ResourcesController;
+
+public:
+    ResourceHandle() = default;
+
+    /**
+    * @brief Returns the current @ref LoadState of the resource.
+    */
+    LoadState state() const {
+        return m_slot ? m_slot->state : LoadState::Failed;
+    }
+
+    /**
+    * @brief Returns true if the resource is loaded.
+    */
+    bool is_ready() const {
+        return state() == LoadState::Ready;
+    }
+
+    /**
+    * @brief Returns the loaded resource if it's ready, otherwise the placeholder. You are not supposed to call `delete` on this pointer.
+    */
+    TResource *get() const {
+        if (!m_slot) {
+            return nullptr;
+        }
+        return m_slot->state == LoadState::Ready ? m_slot->resource : m_slot->placeholder;
+    }
+
+    TResource *operator->() const {
+        return get();
+    }
+
+    /**
+    * @brief Returns the name under which the resource was requested.
+    */
+    const std::string &name() const {
+        return m_slot->name;
+    }
+
+    /**
+    * @brief Returns the error message if the state is @ref LoadState::Failed.
+    */
+    const std::string &error() const {
+        return m_slot->error;
+    }
+
+private:
+    /**
+    * @brief State shared between all the handles to the same resource and the pending load.
+    */
+    struct Slot {
+        LoadState state{LoadState::Pending};
+        TResource *resource{};
+        TResource *placeholder{};
+        std::string name;
+        std::string error;
+    };
+
+    explicit ResourceHandle(std::shared_ptr<Slot> slot) : m_slot(std::move(slot)) {
+    }
+
+    std::shared_ptr<Slot> m_slot;
+};
+} // namespace engine::resources
+
+#endif//MATF_RG_PROJECT_RESOURCE_HANDLE_HPP
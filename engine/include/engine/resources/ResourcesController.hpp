@@ -7,13 +7,35 @@
 #define MATF_RG_PROJECT_RESOURCES_CONTROLLER_HPP
 
 #include <engine/core/Controller.hpp>
+#include <engine/resources/MeshCache.hpp>
 #include <engine/resources/Model.hpp>
 #include <engine/resources/Texture.hpp>
+#include <engine/resources/TextureCache.hpp>
 #include <engine/resources/Shader.hpp>
 #include <engine/resources/Skybox.hpp>
+#include <engine/resources/ResourceHandle.hpp>
+#include <engine/core/JobSystem.hpp>
+#include <functional>
 #include <unordered_map>
 
 namespace engine::resources {
+/**
+* @struct OccluderConfig
+* @brief How to build the occluder proxy of a model, from its `occluder`, `occluder_nodes` and `occluder_grid` in the
+* config.json.
+*/
+struct OccluderConfig {
+    /**
+    * @brief The cells along every axis, see @ref graphics::build_occluder_mesh.
+    */
+    uint32_t grid{16};
+    /**
+    * @brief The names of the nodes whose meshes, and the meshes of their descendants, go into the proxy.
+    * Empty for all the meshes of the model.
+    */
+    std::vector<std::string> nodes;
+};
+
 /**
 * @class ResourcesController
 * @brief Manages app resources: @ref Model, @ref Texture, @ref Shader, and @ref Skybox.
@@ -69,31 +91,140 @@ public:
     */
     Shader *shader(const std::string &name, const std::filesystem::path &path = "");
 
+    /**
+    * @brief Starts loading the model with a given name without blocking and returns a handle to it right away.
+    *
+    * Until the model is loaded the handle returns a placeholder cube with a checkerboard texture.
+    * @param name of the model in the configuration file.
+    * @returns The @ref ResourceHandle to the @ref Model associated with the `name`.
+    */
+    ResourceHandle<Model> model_async(const std::string &name);
+
+    /**
+    * @brief Starts loading the texture without blocking and returns a handle to it right away.
+    *
+    * Until the texture is loaded the handle returns a checkerboard placeholder texture.
+    * The parameters are the same as for @ref ResourcesController::texture.
+    * @returns The @ref ResourceHandle to the @ref Texture associated with the `name`.
+    */
+    ResourceHandle<Texture> texture_async(const std::string &name,
+                                          const std::filesystem::path &path = "",
+                                          TextureType texture_type = TextureType::Regular,
+                                          bool flip_uvs = false);
+
+    /**
+    * @brief Starts loading the skybox without blocking and returns a handle to it right away.
+    *
+    * Until the skybox is loaded the handle returns a plain gray placeholder skybox.
+    * The parameters are the same as for @ref ResourcesController::skybox.
+    * @returns The @ref ResourceHandle to the @ref Skybox associated with the `name`.
+    */
+    ResourceHandle<Skybox> skybox_async(const std::string &name,
+                                        const std::filesystem::path &path = "", bool flip_uvs = false);
+
+    /**
+    * @brief Starts loading the shader without blocking and returns a handle to it right away.
+    *
+    * The source file is read on a worker thread and compiled on the main thread.
+    * Until then the handle returns a placeholder shader that draws in magenta and uses the `model` uniform and the
+    * `FrameData` block.
+    * The parameters are the same as for @ref ResourcesController::shader.
+    * @returns The @ref ResourceHandle to the @ref Shader associated with the `name`.
+    */
+    ResourceHandle<Shader> shader_async(const std::string &name, const std::filesystem::path &path = "");
+
 private:
+    /**
+    * @brief Resources whose CPU side of loading is still in progress on the worker threads. Defined in ResourcesController.cpp.
+    */
+    struct PendingLoads;
+
     /**
     * @brief Loads all the resources from the "resources/" directory.
+    *
+    * File reads, image decoding, and model import run in parallel on the @ref core::JobSystem.
+    * Only the uploads to the OpenGL context run on the main thread, in @ref ResourcesController::finish_loading.
     */
     void initialize() override;
 
     /**
-    * @brief Loads all the models from the "resources/models" directory based on the provided configuration. Called during @ref ResourcesController::initialize.
+    * @brief Creates the placeholder resources returned by the pending @ref ResourceHandle.
+    */
+    void create_placeholders();
+
+    template<typename TResource>
+    using InFlightLoads = std::unordered_map<std::string, std::shared_ptr<typename ResourceHandle<TResource>::Slot> >;
+
+    /**
+    * @brief Runs `load` on a worker thread and then `create` with its result on the main thread, with
+    * @ref core::JobSystem::run_on_main_thread at the beginning of a later frame. Requests for a resource that is already loading share the same load.
+    * @param name name of the resource.
+    * @param loaded the map in which `create` registers the resource.
+    * @param in_flight the loads of the same resource type that haven't finished yet.
+    * @param placeholder returned by the handle until the resource is ready.
+    * @param load the CPU side of loading. Must not touch the OpenGL context.
+    * @param create uploads the result of `load` into the OpenGL context and returns the resource.
     */
-    void load_models();
+    template<typename TResource, typename TLoad, typename TCreate>
+    ResourceHandle<TResource> load_async(const std::string &name,
+                                         std::unordered_map<std::string, std::unique_ptr<TResource> > &loaded,
+                                         InFlightLoads<TResource> &in_flight, TResource *placeholder,
+                                         TLoad load, TCreate create);
 
     /**
-    * @brief Loads all the models from the "resources/textures" directory. Called during @ref ResourcesController::initialize.
+    * @brief Schedules the import of all the models from the "resources/models" directory based on the provided configuration. Called during @ref ResourcesController::initialize.
     */
-    void load_textures();
+    void load_models(core::JobSystem &jobs, PendingLoads &pending);
 
     /**
-    * @brief Loads all the skyboxes from the "resources/skyboxes" directory. Called during @ref ResourcesController::initialize.
+    * @brief Schedules the decoding of all the textures from the "resources/textures" directory. Called during @ref ResourcesController::initialize.
     */
-    void load_skyboxes();
+    void load_textures(core::JobSystem &jobs, PendingLoads &pending);
 
     /**
-    * @brief Loads and compile all the shaders from the "resources/shaders" directory. Called during @ref ResourcesController::initialize.
+    * @brief Schedules the decoding of all the skyboxes from the "resources/skyboxes" directory. Called during @ref ResourcesController::initialize.
     */
-    void load_shaders();
+    void load_skyboxes(core::JobSystem &jobs, PendingLoads &pending);
+
+    /**
+    * @brief Schedules the reading of all the shaders from the "resources/shaders" directory. Called during @ref ResourcesController::initialize.
+    */
+    void load_shaders(core::JobSystem &jobs, PendingLoads &pending);
+
+    /**
+    * @brief Waits for the scheduled loads and uploads their results into the OpenGL context on the main thread.
+    * Textures referenced by the model materials are decoded on the `jobs` as soon as their model is imported.
+    */
+    void finish_loading(core::JobSystem &jobs, PendingLoads &pending);
+
+    /**
+    * @brief Uploads an already decoded texture and registers it under the `name`.
+    */
+    Texture *create_texture(const std::string &name, const ImageData &image, TextureType type);
+
+    /**
+    * @brief Uploads a texture loaded through the @ref TextureCache and registers it under the `name`.
+    */
+    Texture *create_texture(const std::string &name, const TextureData &texture, TextureType type);
+
+    /**
+    * @brief Uploads the imported meshes, builds the node table and registers the model under the `name`, with the
+    * `occluder` proxy built on the worker that imported it.
+    * Textures referenced by the meshes are loaded through @ref ResourcesController::texture if they aren't loaded already.
+    */
+    Model *create_model(const std::string &name, std::filesystem::path path, const ModelData &model,
+                        std::optional<graphics::OccluderMesh> occluder);
+
+    /**
+    * @brief Path to the model file and its import flags from the configuration.
+    */
+    std::pair<std::filesystem::path, bool> model_config(const std::string &name) const;
+
+    /**
+    * @brief The occluder settings of the model from the configuration, or nothing if the model isn't an occluder.
+    * Read on the main thread, before the import is handed to a worker.
+    */
+    std::optional<OccluderConfig> occluder_config(const std::string &name) const;
 
     /**
     * @brief A hashmap of all the loaded @ref Model.
@@ -112,7 +243,34 @@ private:
     */
     std::unordered_map<std::string, std::unique_ptr<Shader> > m_shaders;
 
+    InFlightLoads<Model> m_models_in_flight;
+    InFlightLoads<Texture> m_textures_in_flight;
+    InFlightLoads<Skybox> m_sky_boxes_in_flight;
+    InFlightLoads<Shader> m_shaders_in_flight;
+
+    std::unique_ptr<Model> m_placeholder_model;
+    std::unique_ptr<Texture> m_placeholder_texture;
+    std::unique_ptr<Skybox> m_placeholder_skybox;
+    std::unique_ptr<Shader> m_placeholder_shader;
+
+    /**
+    * @brief Binary cache of the imported models, see @ref MeshCache.
+    */
+    std::unique_ptr<MeshCache> m_mesh_cache;
+
+    /**
+    * @brief Disk cache of the block-compressed textures, see @ref TextureCache.
+    */
+    std::unique_ptr<TextureCache> m_texture_cache;
+
+    /**
+    * @brief Runs the CPU side of the resource loading. Owned by the @ref core::JobSystemController.
+    */
+    core::JobSystem *m_jobs{};
+
     const std::filesystem::path m_models_path = "resources/models";
+    const std::filesystem::path m_mesh_cache_path = MeshCache::DEFAULT_DIRECTORY;
+    const std::filesystem::path m_texture_cache_path = TextureCache::DEFAULT_DIRECTORY;
     const std::filesystem::path m_textures_path = "resources/textures";
     const std::filesystem::path m_shaders_path = "resources/shaders";
     const std::filesystem::path m_skyboxes_path = "resources/skyboxes";
@@ -8,6 +8,8 @@
 
 #include <engine/util/Utils.hpp>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <glm/glm.hpp>
 
 namespace engine::resources {
@@ -18,7 +20,11 @@ using ShaderName = std::string;
 * @brief The type of the shader.
 */
 enum class ShaderType {
-    Vertex, Fragment, Geometry
+    Vertex, Fragment, Geometry,
+    /**
+    * @brief Needs OpenGL 4.3. A compute shader is linked into a program of its own.
+    */
+    Compute
 };
 
 /**
@@ -28,6 +34,66 @@ enum class ShaderType {
 */
 std::string_view to_string(ShaderType type);
 
+/**
+* @class UniformHandle
+* @brief The location of a uniform in a specific @ref Shader, looked up once with @ref Shader::uniform.
+*
+* Setting a uniform through a handle doesn't query OpenGL for the location and doesn't build any strings,
+* so keep the handles around for the uniforms that are set every frame.
+* @code
+* UniformHandle model = shader->uniform("model");
+* ...
+* shader->set_mat4(model, model_matrix);
+* @endcode
+* Setting an invalid handle is a no-op, the same as setting a uniform that the shader doesn't use.
+*/
+class UniformHandle {
+    friend class Shader;
+
+public:
+    UniformHandle() = default;
+
+    /**
+    * @brief Returns true if the uniform is active in the shader.
+    */
+    bool is_valid() const {
+        return m_location != -1;
+    }
+
+    /**
+    * @brief Returns the OpenGL location of the uniform, or -1 if the uniform isn't active.
+    */
+    int32_t location() const {
+        return m_location;
+    }
+
+private:
+    explicit UniformHandle(int32_t location) : m_location(location) {
+    }
+
+    int32_t m_location{-1};
+};
+
+/**
+* @struct ActiveUniform
+* @brief A uniform that the linked shader program uses, as reported by `glGetActiveUniform`.
+*/
+struct ActiveUniform {
+    /**
+    * @brief The name of the uniform. Every element of an array uniform has its own entry, e.g. `lights[1]`.
+    */
+    std::string name;
+    int32_t location{-1};
+    /**
+    * @brief The OpenGL type of the uniform, e.g. GL_FLOAT_MAT4.
+    */
+    uint32_t type{};
+    /**
+    * @brief The number of elements, greater than 1 only for the arrays.
+    */
+    int32_t size{};
+};
+
 /**
 * @class Shader
 * @brief Represents a linked shader program object within the OpenGL context.
@@ -47,68 +113,136 @@ public:
     */
     unsigned id() const;
 
+    /**
+    * @brief Looks up the uniform with the `name` in the uniforms collected after linking. Doesn't call OpenGL.
+    * @param name The name of the uniform.
+    * @returns The handle to the uniform, invalid if the shader doesn't use the uniform.
+    */
+    UniformHandle uniform(std::string_view name) const;
+
+    /**
+    * @brief Returns all the active uniforms of the shader program, sorted by name.
+    */
+    const std::vector<ActiveUniform> &uniforms() const {
+        return m_uniforms;
+    }
+
+    /**
+    * @brief Returns true if the vertex shader reads the per-instance model matrix,
+    * `layout (location = 5) in mat4 aInstanceModel;`, instead of the `model` uniform.
+    * The @ref graphics::RenderQueue draws such shaders with glMultiDrawElementsIndirect when it can.
+    */
+    bool reads_instance_model() const {
+        return m_reads_instance_model;
+    }
+
     /**
     * @brief Sets a boolean uniform value.
     * @param name The name of the uniform.
     * @param value The value to set.
     */
-    void set_bool(const std::string &name, bool value) const;
+    void set_bool(std::string_view name, bool value) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_bool(UniformHandle uniform, bool value) const;
 
     /**
     * @brief Sets an integer uniform value.
     * @param name The name of the uniform.
     * @param value The value to set.
     */
-    void set_int(const std::string &name, int value) const;
+    void set_int(std::string_view name, int value) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_int(UniformHandle uniform, int value) const;
 
     /**
     * @brief Sets a float uniform value.
     * @param name The name of the uniform.
     * @param value The value to set.
     */
-    void set_float(const std::string &name, float value) const;
+    void set_float(std::string_view name, float value) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_float(UniformHandle uniform, float value) const;
 
     /**
     * @brief Sets a 2D vector uniform value.
     * @param name The name of the uniform.
     * @param value The value to set.
     */
-    void set_vec2(const std::string &name, const glm::vec2 &value) const;
+    void set_vec2(std::string_view name, const glm::vec2 &value) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_vec2(UniformHandle uniform, const glm::vec2 &value) const;
 
     /**
     * @brief Sets a 3D vector uniform value.
     * @param name The name of the uniform.
     * @param value The value to set.
     */
-    void set_vec3(const std::string &name, const glm::vec3 &value) const;
+    void set_vec3(std::string_view name, const glm::vec3 &value) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_vec3(UniformHandle uniform, const glm::vec3 &value) const;
 
     /**
     * @brief Sets a 4D vector uniform value.
     * @param name The name of the uniform.
     * @param value The value to set.
     */
-    void set_vec4(const std::string &name, const glm::vec4 &value) const;
+    void set_vec4(std::string_view name, const glm::vec4 &value) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_vec4(UniformHandle uniform, const glm::vec4 &value) const;
 
     /**
     * @brief Sets a 2x2 matrix uniform value.
     * @param name The name of the uniform.
     * @param mat The value to set.
     */
-    void set_mat2(const std::string &name, const glm::mat2 &mat) const;
+    void set_mat2(std::string_view name, const glm::mat2 &mat) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_mat2(UniformHandle uniform, const glm::mat2 &mat) const;
 
     /**
     * @brief Sets a 3x3 matrix uniform value.
     * @param name The name of the uniform.
     * @param mat The value to set.
     */
-    void set_mat3(const std::string &name, const glm::mat3 &mat) const;
+    void set_mat3(std::string_view name, const glm::mat3 &mat) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_mat3(UniformHandle uniform, const glm::mat3 &mat) const;
 
     /**
     * @brief Sets a 4x4 matrix uniform value.
     * @param name The name of the uniform.
     * @param mat The value to set.
     */
-    void set_mat4(const std::string &name, const glm::mat4 &mat) const;
+    void set_mat4(std::string_view name, const glm::mat4 &mat) const;
+
+    /**
+    * @brief Sets the uniform value through the `uniform` handle from @ref Shader::uniform.
+    */
+    void set_mat4(UniformHandle uniform, const glm::mat4 &mat) const;
 
     /**
     * @brief Returns the name of the shader program by which it can be referenced using the @ref engine::resources::ResourcesController::shader function.
@@ -144,6 +278,16 @@ private:
     */
     void destroy() const;
 
+    /**
+    * @brief Collects the active uniforms of the linked program into @ref Shader::m_uniforms.
+    */
+    void introspect_uniforms();
+
+    /**
+    * @brief Sets @ref Shader::m_reads_instance_model from the active attributes of the linked program.
+    */
+    void introspect_attributes();
+
     /**
     * @brief The OpenGL ID of the shader program.
     */
@@ -155,6 +299,12 @@ private:
     std::string m_name;
     std::string m_source;
     std::filesystem::path m_source_path;
+
+    /**
+    * @brief Active uniforms sorted by name, so that @ref Shader::uniform can binary search them by `std::string_view`.
+    */
+    std::vector<ActiveUniform> m_uniforms;
+    bool m_reads_instance_model{false};
 };
 } // namespace engine
 
@@ -14,12 +14,13 @@
 namespace engine::resources {
 /**
 * @struct ShaderParsingResult
-* @brief Contains the parsed vertex, fragment, and geometry shaders, since the ShaderCompiler expects a single .glsl source file.
+* @brief Contains the parsed vertex, fragment, geometry, and compute shaders, since the ShaderCompiler expects a single .glsl source file.
 */
 struct ShaderParsingResult {
     std::string vertex_shader;
     std::string fragment_shader;
     std::string geometry_shader;
+    std::string compute_shader;
 };
 
 /**
@@ -45,6 +46,7 @@ struct ShaderParsingResult {
 *     FragColor = vec4(0.0, 0.0, 0.0, 1.0);
 * }
 * @endcode
+* A source with only the `//#shader compute` directive is compiled into a compute program, which needs OpenGL 4.3.
 */
 class ShaderCompiler {
 public:
@@ -52,9 +54,11 @@ public:
     * @brief Compiles a shader from source.
     * @param shader_name
     * @param shader_source string for the vertex, fragment, [geometry] shader
+    * @param shader_path the file from which the `shader_source` was read, if any
     * @returns Compiled @ref Shader object that can be used for drawing.
     */
-    static Shader compile_from_source(std::string shader_name, std::string shader_source);
+    static Shader compile_from_source(std::string shader_name, std::string shader_source,
+                                      std::filesystem::path shader_path = "");
 
     /**
     * @brief Compiles a shader from file.
@@ -6,9 +6,12 @@
 #ifndef MATF_RG_PROJECT_TEXTURE_HPP
 #define MATF_RG_PROJECT_TEXTURE_HPP
 
+#include <cstdint>
 #include <string_view>
 #include <filesystem>
+#include <memory>
 #include <utility>
+#include <vector>
 
 namespace engine::resources {
 class Shader;
@@ -24,6 +27,104 @@ enum class TextureType {
     Height,
 };
 
+/**
+* @struct ImageData
+* @brief Decoded image pixels in CPU memory. Produced by @ref load_image and uploaded to the OpenGL context by
+* @ref graphics::OpenGL::generate_texture.
+*
+* Decoding doesn't touch the OpenGL context, so images can be decoded on worker threads.
+*/
+struct ImageData {
+    /**
+    * @brief Releases the pixels. The pixels are allocated with `malloc`, the same as the stb image decoder does.
+    */
+    struct PixelsDeleter {
+        void operator()(uint8_t *pixels) const;
+    };
+
+    std::unique_ptr<uint8_t[], PixelsDeleter> pixels;
+    int32_t width{};
+    int32_t height{};
+    int32_t channels{};
+    /**
+    * @brief The path from which the image was decoded.
+    */
+    std::filesystem::path path{};
+};
+
+/**
+* @brief Decodes the image from `path` into the CPU memory. Safe to call from any thread.
+* Throws @ref engine::util::EngineError::Type::AssetLoadingError if the image can't be decoded.
+* @param path path to the image file.
+* @param flip_uvs flip the image vertically on load.
+* @returns Decoded @ref ImageData.
+*/
+ImageData load_image(const std::filesystem::path &path, bool flip_uvs);
+
+/**
+* @enum TextureFormat
+* @brief The format of the pixels in @ref TextureData.
+*/
+enum class TextureFormat : uint32_t {
+    /**
+    * @brief Uncompressed, 8 bits per channel.
+    */
+    Raw,
+    /**
+    * @brief RGB, 4x4 blocks of 8 bytes (S3TC DXT1).
+    */
+    BC1,
+    /**
+    * @brief RGBA, 4x4 blocks of 16 bytes (S3TC DXT5).
+    */
+    BC3,
+    /**
+    * @brief Single channel, 4x4 blocks of 8 bytes (RGTC1).
+    */
+    BC4,
+    /**
+    * @brief Two channels, 4x4 blocks of 16 bytes (RGTC2).
+    */
+    BC5,
+};
+
+/**
+* @brief Converts a @ref TextureFormat to a string.
+*/
+std::string_view to_string(TextureFormat format);
+
+/**
+* @struct TextureData
+* @brief Texture pixels in CPU memory, ready to be uploaded by @ref graphics::OpenGL::generate_texture.
+*
+* Holds either the block-compressed mip chain produced by the @ref TextureCompressor, or a single @ref TextureFormat::Raw
+* level, in which case the mipmaps are generated by OpenGL on upload.
+*/
+struct TextureData {
+    /**
+    * @brief One mip level. `data` is tightly packed, without any row alignment.
+    */
+    struct Level {
+        int32_t width{};
+        int32_t height{};
+        std::vector<uint8_t> data;
+    };
+
+    TextureFormat format{TextureFormat::Raw};
+    /**
+    * @brief Number of channels of the source image.
+    */
+    int32_t channels{};
+    /**
+    * @brief Mip levels, starting with the full resolution image.
+    */
+    std::vector<Level> levels;
+    /**
+    * @brief The path from which the image was decoded.
+    */
+    std::filesystem::path path{};
+};
+
 /**
 * @class Texture
 * @brief Represents a texture object within the OpenGL context.
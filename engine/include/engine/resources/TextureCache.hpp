@@ -0,0 +1,92 @@
+/**
+ * @file TextureCache.hpp
+ * @brief Defines the TextureCache class that stores block-compressed textures on disk, so that the warm starts skip image decoding.
+*/
+
+#ifndef MATF_RG_PROJECT_TEXTURE_CACHE_HPP
+#define MATF_RG_PROJECT_TEXTURE_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <engine/resources/Texture.hpp>
+
+namespace engine::resources {
+/**
+* @class TextureCache
+* @brief Stores the result of the @ref TextureCompressor in a versioned binary file per texture.
+*
+* A cache file is valid only for the same source path, source modification time and size, `flip_uvs`, and
+* @ref TextureCache::VERSION. Otherwise, the image is decoded and compressed again and the cache file is rewritten.
+*
+* File layout, all the numbers are little-endian and every section starts at a 16 byte aligned offset:
+* @code
+* TextureCacheHeader
+* for each mip level:
+*     TextureCacheLevel
+*     uint8_t blocks[size]
+* @endcode
+* The blocks are stored exactly in the layout that `glCompressedTexImage2D` expects.
+*
+* All the functions are safe to call from multiple threads.
+*/
+class TextureCache {
+public:
+    /**
+    * @brief Bump when the encoder or the file layout changes.
+    */
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+    * @brief Directory of the cache files, relative to the working directory of the app.
+    */
+    static constexpr std::string_view DEFAULT_DIRECTORY = "resources/cache/textures";
+
+    /**
+    * @param cache_directory directory where the cache files are stored.
+    * @param enabled if false, @ref TextureCache::import decodes the image every time and returns it uncompressed.
+    */
+    explicit TextureCache(std::filesystem::path cache_directory, bool enabled = true)
+            : m_cache_directory(std::move(cache_directory))
+              , m_enabled(enabled) {
+    }
+
+    /**
+    * @brief Loads the compressed texture from the cache if the cache is valid, otherwise decodes the image,
+    * compresses it with the @ref TextureCompressor and stores the result in the cache.
+    * Throws @ref engine::util::EngineError::Type::AssetLoadingError if the image can't be decoded.
+    * @param image_path path to the image file.
+    * @param flip_uvs flip the image vertically on load.
+    * @returns The texture ready to be uploaded with @ref graphics::OpenGL::generate_texture.
+    */
+    TextureData import(const std::filesystem::path &image_path, bool flip_uvs) const;
+
+    /**
+    * @brief Loads the compressed texture from the cache.
+    * @returns The texture, or nothing if there's no valid cache file for the image.
+    */
+    std::optional<TextureData> load(const std::filesystem::path &image_path, bool flip_uvs) const;
+
+    /**
+    * @brief Writes the compressed `texture` into the cache file for the image.
+    * @returns true if the cache file was written.
+    */
+    bool store(const std::filesystem::path &image_path, bool flip_uvs, const TextureData &texture) const;
+
+    /**
+    * @brief Returns the path of the cache file for the image. The name depends on the source path and `flip_uvs`.
+    */
+    std::filesystem::path cache_file_path(const std::filesystem::path &image_path, bool flip_uvs) const;
+
+    const std::filesystem::path &cache_directory() const {
+        return m_cache_directory;
+    }
+
+private:
+    std::filesystem::path m_cache_directory;
+    bool m_enabled;
+};
+} // namespace engine::resources
+
+#endif//MATF_RG_PROJECT_TEXTURE_CACHE_HPP
@@ -0,0 +1,61 @@
+/**
+ * @file TextureCompressor.hpp
+ * @brief Defines the TextureCompressor class that encodes images into GPU block-compressed formats on the CPU.
+*/
+
+#ifndef MATF_RG_PROJECT_TEXTURE_COMPRESSOR_HPP
+#define MATF_RG_PROJECT_TEXTURE_COMPRESSOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <engine/resources/Texture.hpp>
+
+namespace engine::resources {
+/**
+* @class TextureCompressor
+* @brief Builds the mip chain of an image and encodes every level into a block-compressed @ref TextureFormat.
+*
+* The encoder runs on the CPU only, so it works without a GPU, and it's safe to call from any thread.
+* The format is chosen by the number of channels:
+* 1 -> @ref TextureFormat::BC4, 2 -> @ref TextureFormat::BC5, 3 -> @ref TextureFormat::BC1, 4 -> @ref TextureFormat::BC3.
+* The encoder fits the endpoints to the bounding box of the block colors, which is fast and good enough for the
+* diffuse and specular maps. BC7 isn't supported; RGBA images use BC3.
+*/
+class TextureCompressor {
+public:
+    /**
+    * @brief Builds the mip chain of the `image` down to 1x1 and block-compresses every level.
+    * @param image decoded image with 1 to 4 channels.
+    * @returns The compressed mip chain.
+    */
+    static TextureData compress(const ImageData &image);
+
+    /**
+    * @brief Decodes block-compressed `texture` back into @ref TextureFormat::Raw levels with the same number of channels.
+    * Used when the OpenGL driver can't sample the compressed format.
+    */
+    static TextureData decompress(const TextureData &texture);
+
+    /**
+    * @brief Copies the `image` into a single @ref TextureFormat::Raw level, without compressing it.
+    */
+    static TextureData raw(const ImageData &image);
+
+    /**
+    * @brief Returns the compressed format used for an image with `channels` channels.
+    */
+    static TextureFormat format_for(int32_t channels);
+
+    /**
+    * @brief Returns the size in bytes of a 4x4 block in the compressed `format`.
+    */
+    static size_t block_size(TextureFormat format);
+
+    /**
+    * @brief Returns the size in bytes of a `width` x `height` level in the compressed `format`.
+    */
+    static size_t level_size(TextureFormat format, int32_t width, int32_t height);
+};
+} // namespace engine::resources
+
+#endif//MATF_RG_PROJECT_TEXTURE_COMPRESSOR_HPP
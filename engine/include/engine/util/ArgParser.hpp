@@ -51,6 +51,13 @@ public:
         }
     }
 
+    /**
+    * @brief Check whether a flag, an argument without a value such as `--headless`, was passed.
+    * @param name The name of the flag.
+    * @returns true if the flag is present.
+    */
+    bool has_flag(std::string_view name) const;
+
     /**
     * @brief Initialize the ArgParser with the command line arguments.
     * @param argc The number of command line arguments.
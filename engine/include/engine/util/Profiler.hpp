@@ -0,0 +1,226 @@
+/**
+ * @file Profiler.hpp
+ * @brief Defines the Profiler class that records hierarchical CPU timings of the frame.
+*/
+
+#ifndef MATF_RG_PROJECT_PROFILER_HPP
+#define MATF_RG_PROJECT_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <engine/util/Utils.hpp>
+
+namespace engine::util {
+/**
+* @struct ProfileEvent
+* @brief A finished @ref ProfileScope.
+*/
+struct ProfileEvent {
+    /**
+    * @brief What was measured, e.g. the controller name. Must outlive the profiler, e.g. a string literal.
+    */
+    std::string_view name;
+    /**
+    * @brief Optional second part of the name, e.g. the controller phase. Must outlive the profiler.
+    */
+    std::string_view detail;
+    /**
+    * @brief Nanoseconds since the profiler started, see @ref Profiler::now.
+    */
+    uint64_t begin{};
+    uint64_t end{};
+    /**
+    * @brief Number of the scopes that enclose this one on the same thread.
+    */
+    uint32_t depth{};
+    /**
+    * @brief Index of the thread in the order in which the threads recorded their first event, 0 is usually the main thread.
+    */
+    uint32_t thread{};
+};
+
+/**
+* @class Profiler
+* @brief Collects the @ref ProfileEvent of all threads into a ring buffer per thread.
+*
+* Measure a block of code with the @ref RG_PROFILE_SCOPE macro:
+* @code
+* void MainController::update() {
+*     RG_PROFILE_SCOPE("MainController::update_camera");
+*     update_camera();
+* }
+* @endcode
+* The @ref core::App measures every phase of every controller by the @ref core::Controller::name, so most of the time
+* there's nothing to add. Call @ref Profiler::draw_gui between @ref graphics::GraphicsController::begin_gui and
+* @ref graphics::GraphicsController::end_gui to see the timeline of the last frame, or
+* @ref Profiler::export_chrome_trace to open all the recorded events in `chrome://tracing` or https://ui.perfetto.dev.
+* Run the app with `--profiler-trace <path>` to export the trace when the app exits.
+*/
+class Profiler {
+    friend class ProfileScope;
+
+public:
+    /**
+    * @brief Number of the last events kept for each thread.
+    */
+    static constexpr size_t EVENTS_PER_THREAD = 8192;
+
+    /**
+    * @brief Number of the last frames whose durations are kept.
+    */
+    static constexpr size_t FRAME_HISTORY = 240;
+
+    static Profiler *instance();
+
+    /**
+    * @brief Returns the nanoseconds since the profiler started, from a monotonic clock.
+    */
+    static uint64_t now();
+
+    /**
+    * @brief Starts a new frame. Called by the @ref core::App at the beginning of every frame.
+    */
+    void begin_frame();
+
+    /**
+    * @brief Disabled profiler doesn't record anything. Enabled by default.
+    */
+    void set_enabled(bool enabled) {
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool is_enabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+    * @brief Names the calling thread in the exported trace.
+    */
+    void set_thread_name(std::string name);
+
+    /**
+    * @brief Returns the events of the last finished frame of all threads, sorted by the beginning.
+    * The GPU events arrive a few frames late and aren't included, see @ref Profiler::last_gpu_frame_events.
+    */
+    std::vector<ProfileEvent> last_frame_events() const;
+
+    /**
+    * @brief Records the scopes of one frame measured on the GPU, already converted to the profiler clock.
+    * Called by the @ref graphics::GpuProfiler, a few frames after the GPU executed them.
+    */
+    void record_gpu_events(std::span<const ProfileEvent> events);
+
+    /**
+    * @brief Returns the GPU scopes of the last frame whose GPU results were read.
+    */
+    const std::vector<ProfileEvent> &last_gpu_frame_events() const {
+        return m_gpu_frame_events;
+    }
+
+    /**
+    * @brief Copies the events of all the threads that began in [from, to), as long as they are still in the buffers.
+    */
+    std::vector<ProfileEvent> events_between(uint64_t from, uint64_t to) const;
+
+    /**
+    * @brief Returns the durations of the last frames in nanoseconds, the oldest first.
+    */
+    std::vector<uint64_t> frame_durations() const;
+
+    /**
+    * @brief Writes all the recorded events into a Chrome trace event format JSON file.
+    * @returns true if the file was written.
+    */
+    bool export_chrome_trace(const std::filesystem::path &path) const;
+
+    /**
+    * @brief Draws the profiler window with the frame time graph, the timeline of the last frame, and the time
+    * spent in every controller phase and GPU scope. Call between @ref graphics::GraphicsController::begin_gui and
+    * @ref graphics::GraphicsController::end_gui.
+    */
+    void draw_gui();
+
+private:
+    struct ThreadBuffer {
+        /**
+        * @brief Guards the events against the reads from the other threads. Uncontended on the recording thread.
+        */
+        mutable std::mutex mutex;
+        std::array<ProfileEvent, EVENTS_PER_THREAD> events;
+        uint64_t written{};
+        uint32_t depth{};
+        uint32_t index{};
+        std::string name;
+    };
+
+    Profiler() = default;
+
+    /**
+    * @brief Returns the buffer of the calling thread, registering it on the first call.
+    */
+    ThreadBuffer *thread_buffer();
+
+    /**
+    * @brief Registers a new buffer named `name`. Its index is the lane of its events in the trace.
+    */
+    ThreadBuffer *create_buffer(std::string name);
+
+    /**
+    * @brief Appends the `event` to the `buffer`, overwriting the oldest event if the buffer is full.
+    */
+    static void write(ThreadBuffer *buffer, ProfileEvent event);
+
+    std::atomic<bool> m_enabled{true};
+
+    mutable std::mutex m_buffers_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+
+    /**
+    * @brief The "GPU" lane, created on the first @ref Profiler::record_gpu_events.
+    */
+    ThreadBuffer *m_gpu_buffer{};
+    std::vector<ProfileEvent> m_gpu_frame_events;
+
+    /**
+    * @brief Beginnings of the last frames, indexed by the frame number modulo @ref Profiler::FRAME_HISTORY.
+    */
+    std::array<uint64_t, FRAME_HISTORY> m_frame_begins{};
+    uint64_t m_frame_count{};
+};
+
+/**
+* @class ProfileScope
+* @brief Records a @ref ProfileEvent from the construction to the destruction into the @ref Profiler.
+*/
+class ProfileScope {
+public:
+    explicit ProfileScope(std::string_view name, std::string_view detail = {});
+
+    ~ProfileScope();
+
+    ProfileScope(const ProfileScope &) = delete;
+
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    std::string_view m_name;
+    std::string_view m_detail;
+    uint64_t m_begin{};
+    Profiler::ThreadBuffer *m_buffer{};
+};
+
+/**
+* @brief Measures the rest of the enclosing block. The arguments must outlive the profiler, e.g. string literals.
+*/
+#define RG_PROFILE_SCOPE(...) engine::util::ProfileScope CONCAT(profile_scope_, __LINE__)(__VA_ARGS__)
+} // namespace engine::util
+
+#endif//MATF_RG_PROJECT_PROFILER_HPP
@@ -6,11 +6,13 @@
 #ifndef MATF_RG_PROJECT_UTILS_HPP
 #define MATF_RG_PROJECT_UTILS_HPP
 
+#include <cstdint>
 #include <format>
 #include <source_location>
 #include <vector>
 #include <mutex>
 #include <filesystem>
+#include <string_view>
 #include <functional>
 #include <unordered_set>
 #include <type_traits>
@@ -103,6 +105,21 @@ void trace(std::source_location location = std::source_location::current());
 */
 std::string read_text_file(const std::filesystem::path &path);
 
+/**
+* @brief Computes the 64-bit FNV-1a hash of the `bytes`. Used to name and validate the files in the resource caches.
+* @param bytes The data to hash.
+* @param hash The hash to continue from, to hash multiple pieces of data in a row.
+* @returns The hash of the `bytes`.
+*/
+uint64_t fnv1a(std::string_view bytes, uint64_t hash = 0xcbf29ce484222325ull);
+
+/**
+* @brief Rounds the `offset` up to the multiple of the `alignment`.
+*/
+constexpr uint64_t align_up(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
 /**
 * @brief Calls an action once.
 * @param action The action to call.
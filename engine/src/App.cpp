@@ -1,13 +1,19 @@
 #include <spdlog/spdlog.h>
 #include <engine/core/App.hpp>
+#include <engine/core/JobSystemController.hpp>
 #include <engine/platform/PlatformController.hpp>
 #include <engine/resources/ResourcesController.hpp>
 #include <engine/util/Errors.hpp>
 
 #include <engine/util/ArgParser.hpp>
 #include <engine/util/Configuration.hpp>
+#include <engine/util/Profiler.hpp>
 #include <engine/graphics/GraphicsController.hpp>
 #include <engine/util/Utils.hpp>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
 
 namespace engine::core {
 int App::run(int argc, char **argv) {
@@ -15,10 +21,13 @@ int App::run(int argc, char **argv) {
         engine_setup(argc, argv);
         app_setup();
         initialize();
+        util::Profiler::instance()->begin_frame();
         while (loop()) {
             poll_events();
+            fixed_update();
             update();
             draw();
+            util::Profiler::instance()->begin_frame();
         }
         terminate();
     } catch (const util::Error &e) {
@@ -34,11 +43,13 @@ void App::engine_setup(int argc, char **argv) {
 
     // register engine controllers
     auto begin = register_controller<EngineControllersBegin>();
+    auto jobs = register_controller<JobSystemController>();
     auto platform = register_controller<platform::PlatformController>();
     auto graphics = register_controller<graphics::GraphicsController>();
     auto resources = register_controller<resources::ResourcesController>();
     auto end = register_controller<EngineControllersEnd>();
-    begin->before(platform);
+    begin->before(jobs);
+    jobs->before(platform);
     platform->before(graphics);
     graphics->before(resources);
     resources->before(end);
@@ -54,15 +65,28 @@ void App::initialize() {
                      "Please make sure that there are no cycles in the controller dependency graph.");
         util::alg::topological_sort(range(m_controllers), adjacent_controllers);
     }
+    const auto &config = util::Configuration::config();
+    if (util::ArgParser::instance()->has_flag("--parallel-update") ||
+        config.value(nlohmann::json::json_pointer("/app/parallel_update"), false)) {
+        build_update_graph();
+        m_parallel_update = true;
+    }
+    RG_PROFILE_SCOPE("App", "initialize");
     for (auto controller: m_controllers) {
         spdlog::info("{}::initialize", controller->name());
+        util::ProfileScope scope(controller->name(), "initialize");
         controller->initialize();
     }
 }
 
 bool App::loop() {
+    RG_PROFILE_SCOPE("App", "loop");
     for (auto controller: m_controllers) {
-        if (controller->is_enabled() && !controller->loop()) {
+        if (!controller->is_enabled()) {
+            continue;
+        }
+        util::ProfileScope scope(controller->name(), "loop");
+        if (!controller->loop()) {
             return false;
         }
     }
@@ -70,34 +94,176 @@ bool App::loop() {
 }
 
 void App::poll_events() {
+    RG_PROFILE_SCOPE("App", "poll_events");
     for (auto controller: m_controllers) {
         // We don't check if the controller is enabled for poll_events because the controller may enable itself in the poll_events if it needs to.
         // For example, a GUIController may enable itself in the poll_events method if a button to enable/disable the GUI was pressed.
+        util::ProfileScope scope(controller->name(), "poll_events");
         controller->poll_events();
     }
 }
 
+void App::fixed_update() {
+    RG_PROFILE_SCOPE("App", "fixed_update");
+    const uint32_t steps = Controller::get<platform::PlatformController>()->fixed_timestep().steps;
+    for (uint32_t step = 0; step < steps; ++step) {
+        for (auto controller: m_controllers) {
+            if (controller->is_enabled()) {
+                util::ProfileScope scope(controller->name(), "fixed_update");
+                controller->fixed_update();
+            }
+        }
+    }
+}
+
 void App::update() {
+    RG_PROFILE_SCOPE("App", "update");
+    if (m_parallel_update) {
+        update_parallel();
+        return;
+    }
     for (auto controller: m_controllers) {
         if (controller->is_enabled()) {
+            util::ProfileScope scope(controller->name(), "update");
             controller->update();
         }
     }
 }
 
+void App::build_update_graph() {
+    std::unordered_map<Controller *, uint32_t> index_of;
+    for (uint32_t i = 0; i < m_controllers.size(); ++i) {
+        index_of[m_controllers[i]] = i;
+    }
+    m_update_successors.assign(m_controllers.size(), {});
+    m_update_predecessor_count.assign(m_controllers.size(), 0);
+    for (uint32_t i = 0; i < m_controllers.size(); ++i) {
+        for (auto next: m_controllers[i]->next()) {
+            if (auto it = index_of.find(next); it != index_of.end()) {
+                m_update_successors[i].push_back(it->second);
+                ++m_update_predecessor_count[it->second];
+            }
+        }
+    }
+}
+
+void App::update_parallel() {
+    JobSystem *jobs = Controller::get<JobSystemController>()->job_system();
+    const auto count = static_cast<uint32_t>(m_controllers.size());
+    std::vector<uint32_t> waiting_for = m_update_predecessor_count;
+    // Only the main thread touches the scheduling state; the workers just report the controllers they finished.
+    std::vector<uint32_t> ready;
+    std::vector<uint32_t> main_thread_ready;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (waiting_for[i] == 0) {
+            ready.push_back(i);
+        }
+    }
+    std::mutex finished_mutex;
+    std::condition_variable finished_condition;
+    std::vector<uint32_t> finished;
+    std::exception_ptr error;
+    uint32_t in_flight = 0;
+    uint32_t done = 0;
+
+    auto fail = [&](std::exception_ptr exception) {
+        std::lock_guard lock(finished_mutex);
+        if (!error) {
+            error = std::move(exception);
+        }
+    };
+    auto failed = [&] {
+        std::lock_guard lock(finished_mutex);
+        return static_cast<bool>(error);
+    };
+    auto complete = [&](uint32_t index) {
+        ++done;
+        for (auto next: m_update_successors[index]) {
+            if (--waiting_for[next] == 0) {
+                ready.push_back(next);
+            }
+        }
+    };
+
+    while (done < count) {
+        while (!failed()) {
+            // Hand out the controllers to the workers first, so that they run while the main thread updates.
+            while (!ready.empty()) {
+                const uint32_t index = ready.back();
+                ready.pop_back();
+                Controller *controller = m_controllers[index];
+                if (!controller->is_enabled()) {
+                    complete(index);
+                } else if (controller->uses_gl_context()) {
+                    main_thread_ready.push_back(index);
+                } else {
+                    ++in_flight;
+                    jobs->schedule([&, index, controller] {
+                        try {
+                            util::ProfileScope scope(controller->name(), "update");
+                            controller->update();
+                        } catch (...) {
+                            fail(std::current_exception());
+                        }
+                        // Notify under the lock, the main thread may return and destroy the condition right after.
+                        std::lock_guard lock(finished_mutex);
+                        finished.push_back(index);
+                        finished_condition.notify_one();
+                    });
+                }
+            }
+            if (main_thread_ready.empty()) {
+                break;
+            }
+            const uint32_t index = main_thread_ready.back();
+            main_thread_ready.pop_back();
+            try {
+                util::ProfileScope scope(m_controllers[index]->name(), "update");
+                m_controllers[index]->update();
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            complete(index);
+        }
+        if (in_flight == 0) {
+            break;
+        }
+        std::vector<uint32_t> newly_finished;
+        {
+            std::unique_lock lock(finished_mutex);
+            finished_condition.wait(lock, [&] {
+                return !finished.empty();
+            });
+            newly_finished.swap(finished);
+        }
+        for (auto index: newly_finished) {
+            --in_flight;
+            complete(index);
+        }
+    }
+    // The tasks reference the locals of this function, so the error is rethrown only after all of them finished.
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
 void App::draw() {
+    RG_PROFILE_SCOPE("App", "draw");
     for (auto controller: m_controllers) {
         if (controller->is_enabled()) {
+            util::ProfileScope scope(controller->name(), "begin_draw");
             controller->begin_draw();
         }
     }
     for (auto controller: m_controllers) {
         if (controller->is_enabled()) {
+            util::ProfileScope scope(controller->name(), "draw");
             controller->draw();
         }
     }
     for (auto controller: m_controllers) {
         if (controller->is_enabled()) {
+            util::ProfileScope scope(controller->name(), "end_draw");
             controller->end_draw();
         }
     }
@@ -110,6 +276,10 @@ void App::terminate() {
         controller->terminate();
         spdlog::info("{}::terminate", controller->name());
     }
+    auto trace_path = util::ArgParser::instance()->arg<std::string>("--profiler-trace");
+    if (trace_path.has_value() && !trace_path->empty()) {
+        util::Profiler::instance()->export_chrome_trace(trace_path.value());
+    }
 }
 
 void App::app_setup() {
@@ -0,0 +1,24 @@
+#include <algorithm>
+#include <cmath>
+#include <engine/graphics/Bounds.hpp>
+
+namespace engine::graphics {
+AABB AABB::transformed(const glm::mat4 &transform) const {
+    if (is_empty()) {
+        return *this;
+    }
+    // Transform the center, and project the extents onto the axes through the absolute values of the rotation/scale.
+    const glm::vec3 new_center = glm::vec3(transform * glm::vec4(center(), 1.0f));
+    const glm::mat3 linear = glm::mat3(transform);
+    const glm::mat3 absolute(glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2]));
+    const glm::vec3 new_extents = absolute * extents();
+    return AABB{new_center - new_extents, new_center + new_extents};
+}
+
+BoundingSphere BoundingSphere::transformed(const glm::mat4 &transform) const {
+    const float scale = std::sqrt(std::max({glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+                                            glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+                                            glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))}));
+    return BoundingSphere{glm::vec3(transform * glm::vec4(center, 1.0f)), radius * scale};
+}
+} // namespace engine::graphics
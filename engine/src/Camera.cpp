@@ -84,6 +84,18 @@ void Camera::zoom(float offset) {
     }
 }
 
+// turns the camera towards the target by recomputing the Euler angles from the direction
+void Camera::look_at(const glm::vec3 &target) {
+    const glm::vec3 direction = target - Position;
+    if (glm::dot(direction, direction) < 1e-12f) {
+        return;
+    }
+    const glm::vec3 front = glm::normalize(direction);
+    Yaw = glm::degrees(atan2f(front.z, front.x));
+    Pitch = glm::clamp(glm::degrees(asinf(front.y)), -89.0f, 89.0f);
+    update_camera_vectors();
+}
+
 // calculates the front vector from the Camera's (updated) Euler Angles
 void Camera::update_camera_vectors() {
     // calculate the new Front vector
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cmath>
+#include <engine/graphics/Camera.hpp>
+#include <engine/graphics/CameraPath.hpp>
+#include <engine/util/Errors.hpp>
+
+namespace engine::graphics {
+static glm::vec3 read_vec3(const nlohmann::json &json) {
+    RG_GUARANTEE(json.is_array() && json.size() == 3, "Expected an array of three numbers, got: {}", json.dump());
+    return glm::vec3(json[0].get<float>(), json[1].get<float>(), json[2].get<float>());
+}
+
+CameraPath CameraPath::from_json(const nlohmann::json &json) {
+    std::vector<CameraKeyframe> keyframes;
+    for (const auto &entry: json.at("keyframes")) {
+        CameraKeyframe keyframe;
+        keyframe.position = read_vec3(entry.at("position"));
+        if (entry.contains("target")) {
+            keyframe.target = read_vec3(entry["target"]);
+        } else {
+            const float yaw = glm::radians(entry.value("yaw", Camera::YAW));
+            const float pitch = glm::radians(entry.value("pitch", Camera::PITCH));
+            keyframe.target = keyframe.position + glm::vec3(std::cos(yaw) * std::cos(pitch), std::sin(pitch),
+                                                            std::sin(yaw) * std::cos(pitch));
+        }
+        keyframes.push_back(keyframe);
+    }
+    return CameraPath(std::move(keyframes), json.value("closed", false));
+}
+
+const CameraKeyframe &CameraPath::keyframe(int index) const {
+    const int count = static_cast<int>(m_keyframes.size());
+    if (m_closed) {
+        return m_keyframes[(index % count + count) % count];
+    }
+    return m_keyframes[std::clamp(index, 0, count - 1)];
+}
+
+static glm::vec3 catmull_rom(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3,
+                             float t) {
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    return 0.5f * (2.0f * p1 + (p2 - p0) * t + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                   (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+}
+
+CameraKeyframe CameraPath::sample(float t) const {
+    RG_GUARANTEE(!m_keyframes.empty(), "Can't sample an empty CameraPath.");
+    if (m_keyframes.size() == 1) {
+        return m_keyframes.front();
+    }
+    const int segments = static_cast<int>(m_keyframes.size()) - (m_closed ? 0 : 1);
+    const float position = std::clamp(t, 0.0f, 1.0f) * static_cast<float>(segments);
+    const int segment = std::min(static_cast<int>(position), segments - 1);
+    const float local = position - static_cast<float>(segment);
+    const auto &p0 = keyframe(segment - 1);
+    const auto &p1 = keyframe(segment);
+    const auto &p2 = keyframe(segment + 1);
+    const auto &p3 = keyframe(segment + 2);
+    CameraKeyframe result;
+    result.position = catmull_rom(p0.position, p1.position, p2.position, p3.position, local);
+    result.target = catmull_rom(p0.target, p1.target, p2.target, p3.target, local);
+    return result;
+}
+
+void CameraPath::apply(Camera *camera, float t) const {
+    const CameraKeyframe pose = sample(t);
+    camera->Position = pose.position;
+    camera->look_at(pose.target);
+}
+} // namespace engine::graphics
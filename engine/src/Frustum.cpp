@@ -0,0 +1,61 @@
+#include <cmath>
+#include <engine/graphics/Frustum.hpp>
+
+namespace engine::graphics {
+Frustum::Frustum() {
+    m_distance.fill(1.0f);
+}
+
+Frustum Frustum::from_matrix(const glm::mat4 &view_projection) {
+    // glm is column-major, so the rows of the matrix are strided across the columns.
+    auto row = [&](int i) {
+        return glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+    };
+    const std::array<glm::vec4, PLANE_COUNT> planes = {
+            row(3) + row(0), // left
+            row(3) - row(0), // right
+            row(3) + row(1), // bottom
+            row(3) - row(1), // top
+            row(3) + row(2), // near
+            row(3) - row(2), // far
+    };
+    Frustum frustum;
+    for (size_t i = 0; i < PLANE_COUNT; ++i) {
+        const float length = glm::length(glm::vec3(planes[i]));
+        const glm::vec4 plane = length > 0.0f ? planes[i] / length : planes[i];
+        frustum.m_normal_x[i] = plane.x;
+        frustum.m_normal_y[i] = plane.y;
+        frustum.m_normal_z[i] = plane.z;
+        frustum.m_distance[i] = plane.w;
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const BoundingSphere &sphere) const {
+    bool outside = false;
+    for (size_t i = 0; i < LANE_COUNT; ++i) {
+        const float distance = m_normal_x[i] * sphere.center.x + m_normal_y[i] * sphere.center.y +
+                               m_normal_z[i] * sphere.center.z + m_distance[i];
+        outside |= distance < -sphere.radius;
+    }
+    return !outside;
+}
+
+bool Frustum::intersects(const AABB &aabb) const {
+    if (aabb.is_empty()) {
+        return false;
+    }
+    const glm::vec3 center = aabb.center();
+    const glm::vec3 extents = aabb.extents();
+    bool outside = false;
+    for (size_t i = 0; i < LANE_COUNT; ++i) {
+        const float distance = m_normal_x[i] * center.x + m_normal_y[i] * center.y + m_normal_z[i] * center.z +
+                               m_distance[i];
+        // The projection of the extents onto the plane normal.
+        const float radius = std::abs(m_normal_x[i]) * extents.x + std::abs(m_normal_y[i]) * extents.y +
+                             std::abs(m_normal_z[i]) * extents.z;
+        outside |= distance < -radius;
+    }
+    return !outside;
+}
+} // namespace engine::graphics
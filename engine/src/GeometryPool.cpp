@@ -0,0 +1,194 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <engine/graphics/GeometryPool.hpp>
+#include <engine/graphics/OpenGL.hpp>
+#include <engine/resources/Mesh.hpp>
+#include <engine/util/Errors.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::graphics {
+void RangeAllocator::grow(uint32_t capacity) {
+    RG_GUARANTEE(capacity >= m_capacity, "RangeAllocator can't shrink from {} to {}.", m_capacity, capacity);
+    if (capacity == m_capacity) {
+        return;
+    }
+    const uint32_t old_capacity = m_capacity;
+    m_capacity = capacity;
+    // free() merges the new range with a free range at the old end.
+    m_used += capacity - old_capacity;
+    free(old_capacity, capacity - old_capacity);
+}
+
+std::optional<uint32_t> RangeAllocator::allocate(uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+        auto [first, size] = *it;
+        if (size < count) {
+            continue;
+        }
+        m_free.erase(it);
+        if (size > count) {
+            m_free.emplace(first + count, size - count);
+        }
+        m_used += count;
+        return first;
+    }
+    return std::nullopt;
+}
+
+void RangeAllocator::free(uint32_t first, uint32_t count) {
+    if (count == 0) {
+        return;
+    }
+    m_used -= count;
+    auto next = m_free.lower_bound(first);
+    if (next != m_free.end() && first + count == next->first) {
+        count += next->second;
+        next = m_free.erase(next);
+    }
+    if (next != m_free.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == first) {
+            previous->second += count;
+            return;
+        }
+    }
+    m_free.emplace(first, count);
+}
+
+void GeometryPool::initialize(uint32_t vertex_capacity, uint32_t index_capacity) {
+    CHECKED_GL_CALL(glGenVertexArrays, 1, &m_vertex_array);
+    CHECKED_GL_CALL(glGenBuffers, 1, &m_vertex_buffer);
+    CHECKED_GL_CALL(glGenBuffers, 1, &m_index_buffer);
+    OpenGL::bind_buffer(GL_COPY_WRITE_BUFFER, m_vertex_buffer);
+    CHECKED_GL_CALL(glBufferData, GL_COPY_WRITE_BUFFER,
+                    static_cast<GLsizeiptr>(vertex_capacity * sizeof(resources::Vertex)), nullptr, GL_STATIC_DRAW);
+    OpenGL::bind_buffer(GL_COPY_WRITE_BUFFER, m_index_buffer);
+    CHECKED_GL_CALL(glBufferData, GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(index_capacity * sizeof(uint32_t)),
+                    nullptr, GL_STATIC_DRAW);
+    m_vertices.grow(vertex_capacity);
+    m_indices.grow(index_capacity);
+    setup_vertex_array();
+}
+
+void GeometryPool::terminate() {
+    if (m_vertex_array) {
+        glDeleteVertexArrays(1, &m_vertex_array);
+        glDeleteBuffers(1, &m_vertex_buffer);
+        glDeleteBuffers(1, &m_index_buffer);
+        m_vertex_array = m_vertex_buffer = m_index_buffer = 0;
+        OpenGL::invalidate_state_cache();
+    }
+}
+
+void GeometryPool::setup_vertex_array() {
+    // NOLINTBEGIN
+    OpenGL::bind_vertex_array(m_vertex_array);
+    OpenGL::bind_buffer(GL_ARRAY_BUFFER, m_vertex_buffer);
+    OpenGL::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, m_index_buffer);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(resources::Vertex),
+                          (void *) offsetof(resources::Vertex, Position));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(resources::Vertex),
+                          (void *) offsetof(resources::Vertex, Normal));
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(resources::Vertex),
+                          (void *) offsetof(resources::Vertex, TexCoords));
+
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(resources::Vertex),
+                          (void *) offsetof(resources::Vertex, Tangent));
+
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(resources::Vertex),
+                          (void *) offsetof(resources::Vertex, Bitangent));
+    // NOLINTEND
+}
+
+void GeometryPool::grow_buffer(uint32_t &buffer, size_t old_size, size_t new_size) {
+    uint32_t grown = 0;
+    CHECKED_GL_CALL(glGenBuffers, 1, &grown);
+    OpenGL::bind_buffer(GL_COPY_WRITE_BUFFER, grown);
+    CHECKED_GL_CALL(glBufferData, GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(new_size), nullptr, GL_STATIC_DRAW);
+    OpenGL::bind_buffer(GL_COPY_READ_BUFFER, buffer);
+    CHECKED_GL_CALL(glCopyBufferSubData, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                    static_cast<GLsizeiptr>(old_size));
+    glDeleteBuffers(1, &buffer);
+    OpenGL::invalidate_state_cache();
+    buffer = grown;
+}
+
+GeometryRange GeometryPool::allocate(std::span<const resources::Vertex> vertices, std::span<const uint32_t> indices) {
+    const auto vertex_count = static_cast<uint32_t>(vertices.size());
+    const auto index_count = static_cast<uint32_t>(indices.size());
+    auto base_vertex = m_vertices.allocate(vertex_count);
+    auto first_index = m_indices.allocate(index_count);
+    if (!base_vertex || !first_index) {
+        if (base_vertex) {
+            m_vertices.free(*base_vertex, vertex_count);
+        }
+        if (first_index) {
+            m_indices.free(*first_index, index_count);
+        }
+        const uint32_t vertex_capacity = std::max(m_vertices.capacity() * 2, m_vertices.capacity() + vertex_count);
+        const uint32_t index_capacity = std::max(m_indices.capacity() * 2, m_indices.capacity() + index_count);
+        spdlog::info("GeometryPool: growing to {} vertices and {} indices.", vertex_capacity, index_capacity);
+        grow_buffer(m_vertex_buffer, m_vertices.capacity() * sizeof(resources::Vertex),
+                    vertex_capacity * sizeof(resources::Vertex));
+        grow_buffer(m_index_buffer, m_indices.capacity() * sizeof(uint32_t), index_capacity * sizeof(uint32_t));
+        m_vertices.grow(vertex_capacity);
+        m_indices.grow(index_capacity);
+        setup_vertex_array();
+        base_vertex = m_vertices.allocate(vertex_count);
+        first_index = m_indices.allocate(index_count);
+        RG_GUARANTEE(base_vertex && first_index, "GeometryPool failed to allocate {} vertices and {} indices.",
+                     vertex_count, index_count);
+    }
+    GeometryRange range{*base_vertex, vertex_count, *first_index, index_count};
+    // Upload through the copy target, binding the element array buffer would change the bound vertex array.
+    OpenGL::bind_buffer(GL_COPY_WRITE_BUFFER, m_vertex_buffer);
+    CHECKED_GL_CALL(glBufferSubData, GL_COPY_WRITE_BUFFER,
+                    static_cast<GLintptr>(range.base_vertex * sizeof(resources::Vertex)),
+                    static_cast<GLsizeiptr>(vertices.size_bytes()), vertices.data());
+    OpenGL::bind_buffer(GL_COPY_WRITE_BUFFER, m_index_buffer);
+    CHECKED_GL_CALL(glBufferSubData, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(range.first_index * sizeof(uint32_t)),
+                    static_cast<GLsizeiptr>(indices.size_bytes()), indices.data());
+    return range;
+}
+
+void GeometryPool::free(const GeometryRange &range) {
+    m_vertices.free(range.base_vertex, range.vertex_count);
+    m_indices.free(range.first_index, range.index_count);
+}
+
+void GeometryPool::bind() const {
+    OpenGL::bind_vertex_array(m_vertex_array);
+}
+
+void GeometryPool::attach_instance_buffer(uint32_t buffer, size_t offset) {
+    // NOLINTBEGIN
+    bind();
+    OpenGL::bind_buffer(GL_ARRAY_BUFFER, buffer);
+    for (uint32_t column = 0; column < 4; ++column) {
+        const uint32_t location = resources::Mesh::INSTANCE_MODEL_LOCATION + column;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                              (void *) (offset + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(location, 1);
+    }
+    // NOLINTEND
+}
+
+void GeometryPool::detach_instance_buffer() {
+    bind();
+    for (uint32_t column = 0; column < 4; ++column) {
+        glDisableVertexAttribArray(resources::Mesh::INSTANCE_MODEL_LOCATION + column);
+    }
+}
+} // namespace engine::graphics
@@ -0,0 +1,528 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <engine/graphics/GpuCulling.hpp>
+#include <engine/graphics/GpuProfiler.hpp>
+#include <engine/graphics/GraphicsController.hpp>
+#include <engine/graphics/OpenGL.hpp>
+#include <engine/resources/Shader.hpp>
+#include <engine/resources/ShaderCompiler.hpp>
+#include <engine/util/Errors.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::graphics {
+// OpenGL 4.2-4.6, not in the 3.3 core glad.
+static constexpr GLenum SHADER_STORAGE_BUFFER = 0x90D2;
+static constexpr GLenum PARAMETER_BUFFER = 0x80EE;
+static constexpr GLbitfield TEXTURE_FETCH_BARRIER_BIT = 0x0008;
+static constexpr GLbitfield SHADER_IMAGE_ACCESS_BARRIER_BIT = 0x0020;
+static constexpr GLbitfield COMMAND_BARRIER_BIT = 0x0040;
+static constexpr GLbitfield BUFFER_UPDATE_BARRIER_BIT = 0x0200;
+
+using DispatchComputeFunction = void (APIENTRYP)(GLuint groups_x, GLuint groups_y, GLuint groups_z);
+using MemoryBarrierFunction = void (APIENTRYP)(GLbitfield barriers);
+using BindImageTextureFunction = void (APIENTRYP)(GLuint unit, GLuint texture, GLint level, GLboolean layered,
+                                                   GLint layer, GLenum access, GLenum format);
+using MultiDrawElementsIndirectCountFunction = void (APIENTRYP)(GLenum mode, GLenum type, const void *indirect,
+                                                                 GLintptr draw_count, GLsizei max_draw_count,
+                                                                 GLsizei stride);
+static DispatchComputeFunction g_dispatch_compute = nullptr;
+static MemoryBarrierFunction g_memory_barrier = nullptr;
+static BindImageTextureFunction g_bind_image_texture = nullptr;
+static MultiDrawElementsIndirectCountFunction g_multi_draw_elements_indirect_count = nullptr;
+
+constexpr uint32_t g_cull_group_size = 64;
+constexpr uint32_t g_reduce_group_size = 8;
+
+constexpr std::string_view g_cull_shader_source = R"(//#shader compute
+#version 430 core
+layout (local_size_x = 64) in;
+
+struct DrawCommand {
+    uint count;
+    uint instance_count;
+    uint first_index;
+    int base_vertex;
+    uint base_instance;
+};
+
+struct Draw {
+    vec4 aabb_min;
+    vec4 aabb_max;
+    uint count;
+    uint instance_count;
+    uint first_index;
+    int base_vertex;
+    uint base_instance;
+    uint batch;
+    uint batch_first;
+    uint padding;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    Draw draws[];
+};
+layout (std430, binding = 1) readonly buffer Transforms {
+    mat4 transforms[];
+};
+layout (std430, binding = 2) writeonly buffer Commands {
+    DrawCommand commands[];
+};
+layout (std430, binding = 3) buffer Counts {
+    uint counts[];
+};
+
+uniform int draw_count;
+uniform vec4 frustum_planes[6];
+uniform bool occlusion;
+uniform mat4 pyramid_view_projection;
+uniform int pyramid_width;
+uniform int pyramid_height;
+uniform int pyramid_levels;
+uniform sampler2D depth_pyramid;
+
+bool is_in_frustum(vec3 center, vec3 extents) {
+    for (int i = 0; i < 6; ++i) {
+        vec4 plane = frustum_planes[i];
+        float distance = dot(plane.xyz, center) + plane.w;
+        float radius = dot(abs(plane.xyz), extents);
+        if (distance < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool is_occluded(vec3 center, vec3 extents) {
+    vec2 ndc_min = vec2(1.0e30);
+    vec2 ndc_max = vec2(-1.0e30);
+    float nearest = 1.0;
+    for (int i = 0; i < 8; ++i) {
+        vec3 corner = center + extents * vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0,
+                                              (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = pyramid_view_projection * vec4(corner, 1.0);
+        if (clip.w <= 0.0) {
+            return false;
+        }
+        vec3 ndc = clip.xyz / clip.w;
+        ndc_min = min(ndc_min, ndc.xy);
+        ndc_max = max(ndc_max, ndc.xy);
+        nearest = min(nearest, ndc.z * 0.5 + 0.5);
+    }
+    ivec2 size = ivec2(pyramid_width, pyramid_height);
+    ivec2 pixel_min = clamp(ivec2(floor((ndc_min * 0.5 + 0.5) * vec2(size))), ivec2(0), size - 1);
+    ivec2 pixel_max = clamp(ivec2(floor((ndc_max * 0.5 + 0.5) * vec2(size))), ivec2(0), size - 1);
+    // The level where the rectangle is at most two texels wide and high.
+    int span = max(pixel_max.x - pixel_min.x, pixel_max.y - pixel_min.y);
+    int level = min(span == 0 ? 0 : findMSB(span) + 1, pyramid_levels - 1);
+    ivec2 level_size = max(size >> level, ivec2(1));
+    ivec2 texel_min = min(pixel_min >> level, level_size - 1);
+    ivec2 texel_max = min(pixel_max >> level, level_size - 1);
+    float farthest = max(max(texelFetch(depth_pyramid, texel_min, level).r,
+                             texelFetch(depth_pyramid, ivec2(texel_max.x, texel_min.y), level).r),
+                         max(texelFetch(depth_pyramid, ivec2(texel_min.x, texel_max.y), level).r,
+                             texelFetch(depth_pyramid, texel_max, level).r));
+    return nearest > farthest;
+}
+
+void main() {
+    int index = int(gl_GlobalInvocationID.x);
+    if (index >= draw_count) {
+        return;
+    }
+    Draw draw = draws[index];
+    mat4 model = transforms[draw.base_instance];
+    vec3 local_center = (draw.aabb_min.xyz + draw.aabb_max.xyz) * 0.5;
+    vec3 local_extents = (draw.aabb_max.xyz - draw.aabb_min.xyz) * 0.5;
+    vec3 center = (model * vec4(local_center, 1.0)).xyz;
+    mat3 linear = mat3(model);
+    vec3 extents = mat3(abs(linear[0]), abs(linear[1]), abs(linear[2])) * local_extents;
+    if (!is_in_frustum(center, extents) || (occlusion && is_occluded(center, extents))) {
+        return;
+    }
+    uint slot = atomicAdd(counts[draw.batch], 1u);
+    commands[draw.batch_first + slot] = DrawCommand(draw.count, draw.instance_count, draw.first_index,
+                                                    draw.base_vertex, draw.base_instance);
+}
+)";
+
+constexpr std::string_view g_reduce_shader_source = R"(//#shader compute
+#version 430 core
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (r32f, binding = 0) uniform writeonly image2D destination;
+uniform sampler2D source;
+uniform int source_level;
+uniform bool copy;
+uniform int destination_width;
+uniform int destination_height;
+
+void main() {
+    ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 destination_size = ivec2(destination_width, destination_height);
+    if (any(greaterThanEqual(texel, destination_size))) {
+        return;
+    }
+    if (copy) {
+        imageStore(destination, texel, vec4(texelFetch(source, texel, 0).r));
+        return;
+    }
+    ivec2 size = textureSize(source, source_level);
+    ivec2 first = texel * 2;
+    ivec2 last = first + 1;
+    // An odd column or row of the source is folded into the last texel.
+    if (texel.x == destination_size.x - 1 && (size.x & 1) != 0) {
+        last.x += 1;
+    }
+    if (texel.y == destination_size.y - 1 && (size.y & 1) != 0) {
+        last.y += 1;
+    }
+    float farthest = 0.0;
+    for (int y = first.y; y <= last.y; ++y) {
+        for (int x = first.x; x <= last.x; ++x) {
+            farthest = max(farthest, texelFetch(source, min(ivec2(x, y), size - 1), source_level).r);
+        }
+    }
+    imageStore(destination, texel, vec4(farthest));
+}
+)";
+
+static uint32_t group_count(uint32_t count, uint32_t group_size) {
+    return (count + group_size - 1) / group_size;
+}
+
+DepthPyramid build_depth_pyramid_reference(std::span<const float> depth, uint32_t width, uint32_t height) {
+    RG_GUARANTEE(depth.size() == static_cast<size_t>(width) * height, "The depth buffer has {} values, not {}x{}.",
+                 depth.size(), width, height);
+    DepthPyramid pyramid;
+    pyramid.width = width;
+    pyramid.height = height;
+    const uint32_t levels = std::bit_width(std::max(width, height));
+    pyramid.levels.emplace_back(depth.begin(), depth.end());
+    for (uint32_t level = 1; level < levels; ++level) {
+        const uint32_t source_width = pyramid.level_width(level - 1);
+        const uint32_t source_height = pyramid.level_height(level - 1);
+        const uint32_t destination_width = pyramid.level_width(level);
+        const uint32_t destination_height = pyramid.level_height(level);
+        std::vector<float> destination(static_cast<size_t>(destination_width) * destination_height);
+        for (uint32_t y = 0; y < destination_height; ++y) {
+            for (uint32_t x = 0; x < destination_width; ++x) {
+                uint32_t last_x = 2 * x + 1;
+                uint32_t last_y = 2 * y + 1;
+                if (x == destination_width - 1 && source_width % 2 != 0) {
+                    ++last_x;
+                }
+                if (y == destination_height - 1 && source_height % 2 != 0) {
+                    ++last_y;
+                }
+                float farthest = 0.0f;
+                for (uint32_t source_y = 2 * y; source_y <= last_y; ++source_y) {
+                    for (uint32_t source_x = 2 * x; source_x <= last_x; ++source_x) {
+                        farthest = std::max(farthest, pyramid.texel(level - 1, std::min(source_x, source_width - 1),
+                                                                    std::min(source_y, source_height - 1)));
+                    }
+                }
+                destination[y * destination_width + x] = farthest;
+            }
+        }
+        pyramid.levels.emplace_back(std::move(destination));
+    }
+    return pyramid;
+}
+
+static bool is_in_frustum(const glm::vec3 &center, const glm::vec3 &extents, const Frustum &frustum) {
+    for (size_t i = 0; i < Frustum::PLANE_COUNT; ++i) {
+        const glm::vec4 plane = frustum.plane(i);
+        const float distance = glm::dot(glm::vec3(plane), center) + plane.w;
+        const float radius = glm::dot(glm::abs(glm::vec3(plane)), extents);
+        if (distance < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool is_occluded(const glm::vec3 &center, const glm::vec3 &extents, const glm::mat4 &view_projection,
+                        const DepthPyramid &pyramid) {
+    glm::vec2 ndc_min(1.0e30f);
+    glm::vec2 ndc_max(-1.0e30f);
+    float nearest = 1.0f;
+    for (int i = 0; i < 8; ++i) {
+        const glm::vec3 corner = center + extents * glm::vec3((i & 1) != 0 ? 1.0f : -1.0f,
+                                                              (i & 2) != 0 ? 1.0f : -1.0f,
+                                                              (i & 4) != 0 ? 1.0f : -1.0f);
+        const glm::vec4 clip = view_projection * glm::vec4(corner, 1.0f);
+        if (clip.w <= 0.0f) {
+            return false;
+        }
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        ndc_min = glm::min(ndc_min, glm::vec2(ndc));
+        ndc_max = glm::max(ndc_max, glm::vec2(ndc));
+        nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+    }
+    const glm::ivec2 size(pyramid.width, pyramid.height);
+    const glm::ivec2 pixel_min = glm::clamp(glm::ivec2(glm::floor((ndc_min * 0.5f + 0.5f) * glm::vec2(size))),
+                                            glm::ivec2(0), size - 1);
+    const glm::ivec2 pixel_max = glm::clamp(glm::ivec2(glm::floor((ndc_max * 0.5f + 0.5f) * glm::vec2(size))),
+                                            glm::ivec2(0), size - 1);
+    const int span = std::max(pixel_max.x - pixel_min.x, pixel_max.y - pixel_min.y);
+    const auto level = std::min<uint32_t>(std::bit_width(static_cast<uint32_t>(span)),
+                                          static_cast<uint32_t>(pyramid.levels.size()) - 1);
+    const glm::ivec2 level_size(pyramid.level_width(level), pyramid.level_height(level));
+    const glm::ivec2 texel_min = glm::min(pixel_min >> static_cast<int>(level), level_size - 1);
+    const glm::ivec2 texel_max = glm::min(pixel_max >> static_cast<int>(level), level_size - 1);
+    const float farthest = std::max({pyramid.texel(level, texel_min.x, texel_min.y),
+                                     pyramid.texel(level, texel_max.x, texel_min.y),
+                                     pyramid.texel(level, texel_min.x, texel_max.y),
+                                     pyramid.texel(level, texel_max.x, texel_max.y)});
+    return nearest > farthest;
+}
+
+bool is_occluded_reference(const AABB &aabb, const glm::mat4 &view_projection, const DepthPyramid &pyramid) {
+    return !aabb.is_empty() && !pyramid.levels.empty() &&
+           is_occluded(aabb.center(), aabb.extents(), view_projection, pyramid);
+}
+
+std::vector<uint32_t> GpuCulling::cull_reference(std::span<const CullingDraw> draws,
+                                                 std::span<const glm::mat4> transforms, uint32_t batch_count,
+                                                 const Frustum &frustum, const DepthPyramid *pyramid,
+                                                 const glm::mat4 &pyramid_view_projection) {
+    std::vector<uint32_t> counts(batch_count);
+    for (const auto &draw: draws) {
+        const glm::mat4 &model = transforms[draw.command.base_instance];
+        const glm::vec3 local_center = (glm::vec3(draw.aabb_min) + glm::vec3(draw.aabb_max)) * 0.5f;
+        const glm::vec3 local_extents = (glm::vec3(draw.aabb_max) - glm::vec3(draw.aabb_min)) * 0.5f;
+        const glm::vec3 center = glm::vec3(model * glm::vec4(local_center, 1.0f));
+        const glm::mat3 linear(model);
+        const glm::vec3 extents = glm::mat3(glm::abs(linear[0]), glm::abs(linear[1]), glm::abs(linear[2])) *
+                                  local_extents;
+        if (!is_in_frustum(center, extents, frustum) ||
+            (pyramid && is_occluded(center, extents, pyramid_view_projection, *pyramid))) {
+            continue;
+        }
+        ++counts[draw.batch];
+    }
+    return counts;
+}
+
+bool GpuCulling::is_supported() {
+    return OpenGL::is_version_at_least(4, 3);
+}
+
+bool GpuCulling::has_indirect_count() {
+    return g_multi_draw_elements_indirect_count != nullptr;
+}
+
+void GpuCulling::initialize(bool occlusion, bool validate) {
+    RG_GUARANTEE(is_supported(), "GpuCulling needs OpenGL 4.3.");
+    g_dispatch_compute = OpenGL::load_function<DispatchComputeFunction>("glDispatchCompute");
+    g_memory_barrier = OpenGL::load_function<MemoryBarrierFunction>("glMemoryBarrier");
+    g_bind_image_texture = OpenGL::load_function<BindImageTextureFunction>("glBindImageTexture");
+    if (OpenGL::is_version_at_least(4, 6)) {
+        g_multi_draw_elements_indirect_count = OpenGL::load_function<MultiDrawElementsIndirectCountFunction>(
+                "glMultiDrawElementsIndirectCount");
+    } else if (OpenGL::has_extension("GL_ARB_indirect_parameters")) {
+        g_multi_draw_elements_indirect_count = OpenGL::load_function<MultiDrawElementsIndirectCountFunction>(
+                "glMultiDrawElementsIndirectCountARB");
+    }
+    m_cull_shader = std::make_unique<resources::Shader>(
+            resources::ShaderCompiler::compile_from_source("gpu_culling", std::string(g_cull_shader_source)));
+    m_reduce_shader = std::make_unique<resources::Shader>(
+            resources::ShaderCompiler::compile_from_source("depth_pyramid", std::string(g_reduce_shader_source)));
+    m_cull_uniforms.draw_count = m_cull_shader->uniform("draw_count");
+    for (size_t i = 0; i < Frustum::PLANE_COUNT; ++i) {
+        m_cull_uniforms.frustum_planes[i] = m_cull_shader->uniform(std::format("frustum_planes[{}]", i));
+    }
+    m_cull_uniforms.occlusion = m_cull_shader->uniform("occlusion");
+    m_cull_uniforms.pyramid_view_projection = m_cull_shader->uniform("pyramid_view_projection");
+    m_cull_uniforms.pyramid_width = m_cull_shader->uniform("pyramid_width");
+    m_cull_uniforms.pyramid_height = m_cull_shader->uniform("pyramid_height");
+    m_cull_uniforms.pyramid_levels = m_cull_shader->uniform("pyramid_levels");
+    m_cull_uniforms.depth_pyramid = m_cull_shader->uniform("depth_pyramid");
+    m_reduce_uniforms.source = m_reduce_shader->uniform("source");
+    m_reduce_uniforms.source_level = m_reduce_shader->uniform("source_level");
+    m_reduce_uniforms.copy = m_reduce_shader->uniform("copy");
+    m_reduce_uniforms.destination_width = m_reduce_shader->uniform("destination_width");
+    m_reduce_uniforms.destination_height = m_reduce_shader->uniform("destination_height");
+    m_occlusion = occlusion;
+    m_validate = validate;
+    spdlog::info("GpuCulling: frustum{} culling, draw count from the {}.", m_occlusion ? " and occlusion" : "",
+                 has_indirect_count() ? "GPU counters" : "zeroed commands");
+}
+
+void GpuCulling::terminate() {
+    if (m_validated_frames != 0) {
+        spdlog::info("GpuCulling: {} of {} validated frames differed from the CPU reference.", m_mismatched_frames,
+                     m_validated_frames);
+    }
+    if (m_cull_shader) {
+        glDeleteProgram(m_cull_shader->id());
+        glDeleteProgram(m_reduce_shader->id());
+        m_cull_shader.reset();
+        m_reduce_shader.reset();
+    }
+    if (m_depth_texture) {
+        glDeleteTextures(1, &m_depth_texture);
+        glDeleteTextures(1, &m_pyramid_texture);
+        m_depth_texture = m_pyramid_texture = 0;
+    }
+    OpenGL::invalidate_state_cache();
+}
+
+GpuCulling::Result GpuCulling::cull(std::span<const CullingDraw> draws, const StreamAllocation &transforms,
+                                    uint32_t batch_count, const Frustum &frustum) {
+    RG_GPU_PROFILE_SCOPE("GpuCulling::cull");
+    auto &stream = core::Controller::get<GraphicsController>()->stream_buffer();
+    const auto input = stream.allocate_storage(draws.size_bytes());
+    std::memcpy(input.data, draws.data(), draws.size_bytes());
+    stream.commit(input);
+    Result result;
+    // The commands past the counter of their batch stay zero and draw nothing.
+    result.commands = stream.allocate_storage(draws.size() * sizeof(DrawElementsIndirectCommand));
+    std::memset(result.commands.data, 0, result.commands.size);
+    stream.commit(result.commands);
+    result.counts = stream.allocate_storage(batch_count * sizeof(uint32_t));
+    std::memset(result.counts.data, 0, result.counts.size);
+    stream.commit(result.counts);
+
+    OpenGL::bind_buffer_range(SHADER_STORAGE_BUFFER, DRAWS_BINDING, input.buffer, input.offset, input.size);
+    OpenGL::bind_buffer_range(SHADER_STORAGE_BUFFER, TRANSFORMS_BINDING, transforms.buffer, transforms.offset,
+                              transforms.size);
+    OpenGL::bind_buffer_range(SHADER_STORAGE_BUFFER, COMMANDS_BINDING, result.commands.buffer,
+                              result.commands.offset, result.commands.size);
+    OpenGL::bind_buffer_range(SHADER_STORAGE_BUFFER, COUNTS_BINDING, result.counts.buffer, result.counts.offset,
+                              result.counts.size);
+    m_cull_shader->use();
+    m_cull_shader->set_int(m_cull_uniforms.draw_count, static_cast<int>(draws.size()));
+    for (size_t i = 0; i < Frustum::PLANE_COUNT; ++i) {
+        m_cull_shader->set_vec4(m_cull_uniforms.frustum_planes[i], frustum.plane(i));
+    }
+    const bool occlusion = m_occlusion && m_pyramid_valid;
+    m_cull_shader->set_bool(m_cull_uniforms.occlusion, occlusion);
+    if (occlusion) {
+        m_cull_shader->set_mat4(m_cull_uniforms.pyramid_view_projection, m_pyramid_view_projection);
+        m_cull_shader->set_int(m_cull_uniforms.pyramid_width, m_width);
+        m_cull_shader->set_int(m_cull_uniforms.pyramid_height, m_height);
+        m_cull_shader->set_int(m_cull_uniforms.pyramid_levels, static_cast<int>(m_pyramid_levels));
+        m_cull_shader->set_int(m_cull_uniforms.depth_pyramid, 0);
+        OpenGL::bind_texture(0, GL_TEXTURE_2D, m_pyramid_texture);
+    }
+    CHECKED_GL_CALL(g_dispatch_compute, group_count(static_cast<uint32_t>(draws.size()), g_cull_group_size), 1, 1);
+    CHECKED_GL_CALL(g_memory_barrier, COMMAND_BARRIER_BIT);
+    return result;
+}
+
+void GpuCulling::multi_draw_indirect_count(size_t command_offset, uint32_t count_buffer, size_t count_offset,
+                                           uint32_t max_draw_count) {
+    OpenGL::bind_buffer(PARAMETER_BUFFER, count_buffer);
+    // NOLINTNEXTLINE
+    CHECKED_GL_CALL(g_multi_draw_elements_indirect_count, GL_TRIANGLES, GL_UNSIGNED_INT,
+                    (const void *) command_offset, static_cast<GLintptr>(count_offset),
+                    static_cast<GLsizei>(max_draw_count), 0);
+}
+
+void GpuCulling::resize(int width, int height) {
+    if (m_depth_texture) {
+        glDeleteTextures(1, &m_depth_texture);
+        glDeleteTextures(1, &m_pyramid_texture);
+        OpenGL::invalidate_state_cache();
+    }
+    m_width = width;
+    m_height = height;
+    m_pyramid_levels = std::bit_width(static_cast<uint32_t>(std::max(width, height)));
+    m_pyramid_valid = false;
+
+    CHECKED_GL_CALL(glGenTextures, 1, &m_depth_texture);
+    OpenGL::bind_texture(0, GL_TEXTURE_2D, m_depth_texture);
+    CHECKED_GL_CALL(glTexImage2D, GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, width, height, 0, GL_DEPTH_COMPONENT,
+                    GL_FLOAT, nullptr);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    CHECKED_GL_CALL(glGenTextures, 1, &m_pyramid_texture);
+    OpenGL::bind_texture(0, GL_TEXTURE_2D, m_pyramid_texture);
+    for (uint32_t level = 0; level < m_pyramid_levels; ++level) {
+        CHECKED_GL_CALL(glTexImage2D, GL_TEXTURE_2D, static_cast<GLint>(level), GL_R32F, std::max(1, width >> level),
+                        std::max(1, height >> level), 0, GL_RED, GL_FLOAT, nullptr);
+    }
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(m_pyramid_levels - 1));
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    spdlog::info("GpuCulling: {}x{} depth pyramid with {} levels.", width, height, m_pyramid_levels);
+}
+
+void GpuCulling::build_depth_pyramid(int width, int height, const glm::mat4 &view_projection) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    RG_GPU_PROFILE_SCOPE("GpuCulling::build_depth_pyramid");
+    if (width != m_width || height != m_height) {
+        resize(width, height);
+    }
+    OpenGL::bind_texture(0, GL_TEXTURE_2D, m_depth_texture);
+    CHECKED_GL_CALL(glCopyTexSubImage2D, GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+    m_reduce_shader->use();
+    m_reduce_shader->set_int(m_reduce_uniforms.source, 0);
+    for (uint32_t level = 0; level < m_pyramid_levels; ++level) {
+        const int destination_width = std::max(1, width >> level);
+        const int destination_height = std::max(1, height >> level);
+        m_reduce_shader->set_bool(m_reduce_uniforms.copy, level == 0);
+        m_reduce_shader->set_int(m_reduce_uniforms.source_level, level == 0 ? 0 : static_cast<int>(level) - 1);
+        m_reduce_shader->set_int(m_reduce_uniforms.destination_width, destination_width);
+        m_reduce_shader->set_int(m_reduce_uniforms.destination_height, destination_height);
+        if (level == 1) {
+            OpenGL::bind_texture(0, GL_TEXTURE_2D, m_pyramid_texture);
+        }
+        CHECKED_GL_CALL(g_bind_image_texture, 0, m_pyramid_texture, static_cast<GLint>(level), GL_FALSE, 0,
+                        GL_WRITE_ONLY, GL_R32F);
+        CHECKED_GL_CALL(g_dispatch_compute, group_count(destination_width, g_reduce_group_size),
+                        group_count(destination_height, g_reduce_group_size), 1);
+        CHECKED_GL_CALL(g_memory_barrier, TEXTURE_FETCH_BARRIER_BIT | SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+    m_pyramid_view_projection = view_projection;
+    m_pyramid_valid = true;
+
+    if (!m_validate) {
+        return;
+    }
+    std::vector<float> depth(static_cast<size_t>(width) * height);
+    OpenGL::bind_texture(0, GL_TEXTURE_2D, m_depth_texture);
+    CHECKED_GL_CALL(glGetTexImage, GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_FLOAT, depth.data());
+    m_pyramid_copy = build_depth_pyramid_reference(depth, width, height);
+    OpenGL::bind_texture(0, GL_TEXTURE_2D, m_pyramid_texture);
+    for (uint32_t level = 0; level < m_pyramid_levels; ++level) {
+        std::vector<float> texels(m_pyramid_copy.levels[level].size());
+        CHECKED_GL_CALL(glGetTexImage, GL_TEXTURE_2D, static_cast<GLint>(level), GL_RED, GL_FLOAT, texels.data());
+        if (texels != m_pyramid_copy.levels[level]) {
+            spdlog::warn("GpuCulling: level {} of the depth pyramid differs from the CPU reference.", level);
+        }
+    }
+}
+
+void GpuCulling::validate(const Result &result, std::span<const CullingDraw> draws,
+                          std::span<const glm::mat4> transforms, uint32_t batch_count, const Frustum &frustum) {
+    std::vector<uint32_t> counts(batch_count);
+    CHECKED_GL_CALL(g_memory_barrier, BUFFER_UPDATE_BARRIER_BIT);
+    OpenGL::bind_buffer(GL_COPY_READ_BUFFER, result.counts.buffer);
+    CHECKED_GL_CALL(glGetBufferSubData, GL_COPY_READ_BUFFER, static_cast<GLintptr>(result.counts.offset),
+                    static_cast<GLsizeiptr>(counts.size() * sizeof(uint32_t)), counts.data());
+    const bool occlusion = m_occlusion && m_pyramid_valid;
+    const auto expected = cull_reference(draws, transforms, batch_count, frustum,
+                                         occlusion ? &m_pyramid_copy : nullptr, m_pyramid_view_projection);
+    ++m_validated_frames;
+    if (counts == expected) {
+        return;
+    }
+    ++m_mismatched_frames;
+    for (uint32_t batch = 0; batch < batch_count; ++batch) {
+        if (counts[batch] != expected[batch]) {
+            spdlog::warn("GpuCulling: batch {} drew {} of its draws, the CPU reference {}.", batch, counts[batch],
+                         expected[batch]);
+        }
+    }
+}
+} // namespace engine::graphics
@@ -0,0 +1,113 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <engine/graphics/GpuProfiler.hpp>
+#include <engine/graphics/OpenGL.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::graphics {
+GpuProfiler *GpuProfiler::instance() {
+    static GpuProfiler profiler;
+    return &profiler;
+}
+
+void GpuProfiler::initialize() {
+    int32_t counter_bits = 0;
+    CHECKED_GL_CALL(glGetQueryiv, GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counter_bits);
+    if (counter_bits == 0) {
+        spdlog::info("GpuProfiler: the driver doesn't count GL_TIMESTAMP, GPU timings are disabled.");
+        return;
+    }
+    for (auto &frame: m_frames) {
+        frame.queries.resize(2 * MAX_SCOPES_PER_FRAME);
+        CHECKED_GL_CALL(glGenQueries, static_cast<int32_t>(frame.queries.size()), frame.queries.data());
+        frame.scopes.reserve(MAX_SCOPES_PER_FRAME);
+    }
+    m_supported = true;
+}
+
+void GpuProfiler::terminate() {
+    for (auto &frame: m_frames) {
+        if (!frame.queries.empty()) {
+            CHECKED_GL_CALL(glDeleteQueries, static_cast<int32_t>(frame.queries.size()), frame.queries.data());
+        }
+        frame = Frame{};
+    }
+    m_current = nullptr;
+    m_supported = false;
+}
+
+void GpuProfiler::begin_frame() {
+    m_current = nullptr;
+    if (!m_supported || !util::Profiler::instance()->is_enabled()) {
+        return;
+    }
+    Frame &frame = m_frames[m_frame_index % FRAME_LATENCY];
+    ++m_frame_index;
+    if (frame.in_flight) {
+        collect(frame);
+    }
+    frame.scopes.clear();
+    frame.in_flight = true;
+    int64_t gpu_now = 0;
+    CHECKED_GL_CALL(glGetInteger64v, GL_TIMESTAMP, &gpu_now);
+    frame.clock_offset = static_cast<int64_t>(util::Profiler::now()) - gpu_now;
+    m_current = &frame;
+    m_depth = 0;
+    begin_scope("Frame");
+}
+
+void GpuProfiler::end_frame() {
+    if (m_current == nullptr) {
+        return;
+    }
+    // The frame scope is always the first one.
+    end_scope(0);
+    m_current = nullptr;
+}
+
+uint32_t GpuProfiler::begin_scope(std::string_view name) {
+    if (m_current == nullptr || m_current->scopes.size() == MAX_SCOPES_PER_FRAME) {
+        return INVALID_SCOPE;
+    }
+    const auto scope = static_cast<uint32_t>(m_current->scopes.size());
+    m_current->scopes.push_back(Scope{name, m_depth++});
+    CHECKED_GL_CALL(glQueryCounter, m_current->queries[2 * scope], GL_TIMESTAMP);
+    return scope;
+}
+
+void GpuProfiler::end_scope(uint32_t scope) {
+    if (m_current == nullptr || scope == INVALID_SCOPE) {
+        return;
+    }
+    --m_depth;
+    CHECKED_GL_CALL(glQueryCounter, m_current->queries[2 * scope + 1], GL_TIMESTAMP);
+}
+
+void GpuProfiler::collect(Frame &frame) {
+    frame.in_flight = false;
+    if (frame.scopes.empty()) {
+        return;
+    }
+    // The end of the frame scope is the last query of the frame, and the queries complete in order.
+    int32_t available = 0;
+    CHECKED_GL_CALL(glGetQueryObjectiv, frame.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        ++m_dropped_frames;
+        return;
+    }
+    m_events.clear();
+    for (uint32_t i = 0; i < frame.scopes.size(); ++i) {
+        uint64_t begin = 0, end = 0;
+        CHECKED_GL_CALL(glGetQueryObjectui64v, frame.queries[2 * i], GL_QUERY_RESULT, &begin);
+        CHECKED_GL_CALL(glGetQueryObjectui64v, frame.queries[2 * i + 1], GL_QUERY_RESULT, &end);
+        util::ProfileEvent event;
+        event.name = frame.scopes[i].name;
+        event.begin = static_cast<uint64_t>(static_cast<int64_t>(begin) + frame.clock_offset);
+        event.end = static_cast<uint64_t>(static_cast<int64_t>(std::max(begin, end)) + frame.clock_offset);
+        event.depth = frame.scopes[i].depth;
+        m_events.push_back(event);
+    }
+    m_last_frame_time = m_events.front().end - m_events.front().begin;
+    util::Profiler::instance()->record_gpu_events(m_events);
+}
+} // namespace engine::graphics
@@ -4,10 +4,19 @@
 #include <imgui_impl_opengl3.h>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <engine/graphics/GpuCulling.hpp>
+#include <engine/graphics/GpuProfiler.hpp>
 #include <engine/graphics/GraphicsController.hpp>
 #include <engine/graphics/OpenGL.hpp>
 #include <engine/platform/PlatformController.hpp>
+#include <engine/resources/Shader.hpp>
 #include <engine/resources/Skybox.hpp>
+#include <engine/util/ArgParser.hpp>
+#include <engine/util/Configuration.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <spdlog/spdlog.h>
 
 namespace engine::graphics {
 
@@ -39,15 +48,181 @@ void GraphicsController::initialize() {
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
     ImGuiIO &io = ImGui::GetIO();
-    (void) io;
-    RG_GUARANTEE(ImGui_ImplGlfw_InitForOpenGL(handle, true), "ImGUI failed to initialize for OpenGL");
-    RG_GUARANTEE(ImGui_ImplOpenGL3_Init("#version 330 core"), "ImGUI failed to initialize for OpenGL");
+    m_gui_enabled = !util::ArgParser::instance()->has_flag("--no-gui");
+    if (m_gui_enabled) {
+        RG_GUARANTEE(ImGui_ImplGlfw_InitForOpenGL(handle, true), "ImGUI failed to initialize for OpenGL");
+        RG_GUARANTEE(ImGui_ImplOpenGL3_Init("#version 330 core"), "ImGUI failed to initialize for OpenGL");
+    } else {
+        // Without the OpenGL backend nobody builds the font atlas, which ImGui::NewFrame requires.
+        unsigned char *pixels;
+        int width, height;
+        io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+    }
+
+    if (platform->is_headless()) {
+        create_offscreen_framebuffer(platform->window()
+                                             ->width(), platform->window()
+                                                                ->height());
+    }
+
+    const auto &config = util::Configuration::config();
+    m_stream_buffer.initialize(config.value(nlohmann::json::json_pointer("/graphics/stream_buffer_kib"), 1024u) * 1024,
+                               config.value(nlohmann::json::json_pointer("/graphics/persistent_mapping"), true));
+    m_geometry_pool.initialize(config.value(nlohmann::json::json_pointer("/graphics/geometry_pool/vertices"), 1u << 18),
+                               config.value(nlohmann::json::json_pointer("/graphics/geometry_pool/indices"), 1u << 20));
+    RenderQueueSettings render_queue_settings;
+    render_queue_settings.multi_draw_indirect = config.value(
+            nlohmann::json::json_pointer("/graphics/multi_draw_indirect"), true);
+    render_queue_settings.gpu_culling = config.value(nlohmann::json::json_pointer("/graphics/gpu_culling/enabled"),
+                                                     true);
+    render_queue_settings.occlusion_culling = config.value(
+            nlohmann::json::json_pointer("/graphics/gpu_culling/occlusion"), true);
+    render_queue_settings.validate_culling = config.value(
+            nlohmann::json::json_pointer("/graphics/gpu_culling/validate"), false);
+    render_queue_settings.software_occlusion = config.value(
+            nlohmann::json::json_pointer("/graphics/software_occlusion/enabled"), true);
+    render_queue_settings.software_occlusion_width = config.value(
+            nlohmann::json::json_pointer("/graphics/software_occlusion/width"), 256u);
+    render_queue_settings.software_occlusion_height = config.value(
+            nlohmann::json::json_pointer("/graphics/software_occlusion/height"), 144u);
+    m_render_queue.initialize(render_queue_settings);
+    if (config.value(nlohmann::json::json_pointer("/profiler/gpu"), true)) {
+        GpuProfiler::instance()->initialize();
+    }
+}
+
+void GraphicsController::begin_draw() {
+    OpenGL::begin_state_cache_frame();
+    GpuProfiler::instance()->begin_frame();
+    m_stream_buffer.begin_frame();
+    if (m_offscreen_framebuffer) {
+        CHECKED_GL_CALL(glBindFramebuffer, GL_FRAMEBUFFER, m_offscreen_framebuffer);
+    }
+    auto platform = engine::core::Controller::get<platform::PlatformController>();
+    m_frame_uniforms.view = m_camera.view_matrix();
+    m_frame_uniforms.projection = projection_matrix<>();
+    m_frame_uniforms.view_projection = m_frame_uniforms.projection * m_frame_uniforms.view;
+    m_frame_uniforms.camera_position = glm::vec4(m_camera.Position, 1.0f);
+    m_frame_uniforms.time = platform->frame_time().current;
+    const auto frame_uniforms = m_stream_buffer.allocate_uniform(sizeof(FrameUniforms));
+    std::memcpy(frame_uniforms.data, &m_frame_uniforms, sizeof(FrameUniforms));
+    m_stream_buffer.commit(frame_uniforms);
+    OpenGL::bind_buffer_range(GL_UNIFORM_BUFFER, FrameUniforms::BINDING, frame_uniforms.buffer, frame_uniforms.offset,
+                              frame_uniforms.size);
+    m_frustum = Frustum::from_matrix(m_frame_uniforms.view_projection);
+    m_render_queue.begin(m_frame_uniforms.view, m_frame_uniforms.view_projection, m_frustum, m_perspective_params.Near,
+                         m_perspective_params.Far);
+}
+
+void GraphicsController::end_draw() {
+    {
+        RG_GPU_PROFILE_SCOPE("RenderQueue");
+        m_render_queue.flush();
+    }
+    if (m_render_queue.is_gpu_culling_enabled() && m_render_queue.gpu_culling()
+                                                                  ->is_occlusion_enabled()) {
+        auto window = engine::core::Controller::get<platform::PlatformController>()->window();
+        const int width = m_offscreen_framebuffer ? m_offscreen_width : window->width();
+        const int height = m_offscreen_framebuffer ? m_offscreen_height : window->height();
+        m_render_queue.gpu_culling()
+                      ->build_depth_pyramid(width, height, m_frame_uniforms.view_projection);
+    }
+    if (m_gui_pending) {
+        RG_GPU_PROFILE_SCOPE("ImGui");
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        // ImGui binds its own program, vertex array and texture behind the state cache. It restores them afterwards,
+        // but rebinding once per frame is cheaper than depending on that.
+        OpenGL::invalidate_state_cache();
+        m_gui_pending = false;
+    }
+    m_stream_buffer.end_frame();
+    GpuProfiler::instance()->end_frame();
+}
+
+void GraphicsController::create_offscreen_framebuffer(int width, int height) {
+    m_offscreen_width = width;
+    m_offscreen_height = height;
+    CHECKED_GL_CALL(glGenRenderbuffers, 1, &m_offscreen_color);
+    CHECKED_GL_CALL(glBindRenderbuffer, GL_RENDERBUFFER, m_offscreen_color);
+    CHECKED_GL_CALL(glRenderbufferStorage, GL_RENDERBUFFER, GL_RGBA8, width, height);
+    CHECKED_GL_CALL(glGenRenderbuffers, 1, &m_offscreen_depth);
+    CHECKED_GL_CALL(glBindRenderbuffer, GL_RENDERBUFFER, m_offscreen_depth);
+    CHECKED_GL_CALL(glRenderbufferStorage, GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    CHECKED_GL_CALL(glBindRenderbuffer, GL_RENDERBUFFER, 0);
+
+    CHECKED_GL_CALL(glGenFramebuffers, 1, &m_offscreen_framebuffer);
+    CHECKED_GL_CALL(glBindFramebuffer, GL_FRAMEBUFFER, m_offscreen_framebuffer);
+    CHECKED_GL_CALL(glFramebufferRenderbuffer, GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                    m_offscreen_color);
+    CHECKED_GL_CALL(glFramebufferRenderbuffer, GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                    m_offscreen_depth);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    RG_GUARANTEE(status == GL_FRAMEBUFFER_COMPLETE, "Offscreen framebuffer is incomplete: {:#x}", status);
+    CHECKED_GL_CALL(glViewport, 0, 0, width, height);
+    spdlog::info("Graphics rendering into an offscreen {}x{} framebuffer.", width, height);
+}
+
+void GraphicsController::destroy_offscreen_framebuffer() {
+    if (!m_offscreen_framebuffer) {
+        return;
+    }
+    CHECKED_GL_CALL(glBindFramebuffer, GL_FRAMEBUFFER, 0);
+    CHECKED_GL_CALL(glDeleteFramebuffers, 1, &m_offscreen_framebuffer);
+    CHECKED_GL_CALL(glDeleteRenderbuffers, 1, &m_offscreen_color);
+    CHECKED_GL_CALL(glDeleteRenderbuffers, 1, &m_offscreen_depth);
+    m_offscreen_framebuffer = m_offscreen_color = m_offscreen_depth = 0;
+}
+
+std::vector<uint8_t> GraphicsController::read_pixels() const {
+    auto window = engine::core::Controller::get<platform::PlatformController>()->window();
+    const int width = m_offscreen_framebuffer ? m_offscreen_width : window->width();
+    const int height = m_offscreen_framebuffer ? m_offscreen_height : window->height();
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    CHECKED_GL_CALL(glBindFramebuffer, GL_READ_FRAMEBUFFER, m_offscreen_framebuffer);
+    CHECKED_GL_CALL(glPixelStorei, GL_PACK_ALIGNMENT, 1);
+    CHECKED_GL_CALL(glReadPixels, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+/**
+ * @brief Writes the bottom-up RGBA `pixels` into a binary PPM file, which every image viewer and diff tool reads.
+ */
+static bool write_ppm(const std::string &path, int width, int height, const std::vector<uint8_t> &pixels) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file << "P6\n" << width << ' ' << height << "\n255\n";
+    for (int y = height - 1; y >= 0; --y) {
+        for (int x = 0; x < width; ++x) {
+            file.write(reinterpret_cast<const char *>(&pixels[(static_cast<size_t>(y) * width + x) * 4]), 3);
+        }
+    }
+    return static_cast<bool>(file);
 }
 
 void GraphicsController::terminate() {
+    if (m_offscreen_framebuffer) {
+        auto capture_path = util::ArgParser::instance()->arg<std::string>("--capture");
+        if (capture_path.has_value() && !capture_path->empty()) {
+            if (write_ppm(capture_path.value(), m_offscreen_width, m_offscreen_height, read_pixels())) {
+                spdlog::info("Graphics captured the last frame into {}", capture_path.value());
+            } else {
+                spdlog::warn("Graphics failed to capture the last frame into {}", capture_path.value());
+            }
+        }
+    }
+    destroy_offscreen_framebuffer();
+    GpuProfiler::instance()->terminate();
+    m_render_queue.terminate();
+    m_stream_buffer.terminate();
+    m_geometry_pool.terminate();
+    OpenGL::invalidate_state_cache();
     if (ImGui::GetCurrentContext()) {
-        ImGui_ImplOpenGL3_Shutdown();
-        ImGui_ImplGlfw_Shutdown();
+        if (m_gui_enabled) {
+            ImGui_ImplOpenGL3_Shutdown();
+            ImGui_ImplGlfw_Shutdown();
+        }
         ImGui::DestroyContext();
     }
 }
@@ -69,28 +244,33 @@ std::string_view GraphicsController::name() const {
 }
 
 void GraphicsController::begin_gui() {
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplGlfw_NewFrame();
+    if (m_gui_enabled) {
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplGlfw_NewFrame();
+    } else {
+        ImGuiIO &io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(m_perspective_params.Width, m_perspective_params.Height);
+        io.DeltaTime = std::max(engine::core::Controller::get<platform::PlatformController>()->dt(), 1e-4f);
+    }
     ImGui::NewFrame();
 }
 
 void GraphicsController::end_gui() {
+    if (!m_gui_enabled) {
+        ImGui::EndFrame();
+        return;
+    }
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    m_gui_pending = true;
 }
 
 void GraphicsController::draw_skybox(const resources::Shader *shader, const resources::Skybox *skybox) {
-    glm::mat4 view = glm::mat4(glm::mat3(m_camera.view_matrix()));
     shader->use();
-    shader->set_mat4("view", view);
-    shader->set_mat4("projection", projection_matrix<>());
-    CHECKED_GL_CALL(glDepthFunc, GL_LEQUAL);
-    CHECKED_GL_CALL(glBindVertexArray, skybox->vao());
-    CHECKED_GL_CALL(glActiveTexture, GL_TEXTURE0);
-    CHECKED_GL_CALL(glBindTexture, GL_TEXTURE_CUBE_MAP, skybox->texture());
-    CHECKED_GL_CALL(glDrawArrays, GL_TRIANGLES, 0, 36);
-    CHECKED_GL_CALL(glBindVertexArray, 0);
-    CHECKED_GL_CALL(glDepthFunc, GL_LESS); // set depth function back to default
-    CHECKED_GL_CALL(glBindTexture, GL_TEXTURE_CUBE_MAP, 0);
+    // Skybox shaders that declare the FrameData block remove the translation from the view themselves.
+    if (auto view = shader->uniform("view"); view.is_valid()) {
+        shader->set_mat4(view, glm::mat4(glm::mat3(m_camera.view_matrix())));
+        shader->set_mat4("projection", projection_matrix<>());
+    }
+    m_render_queue.submit(shader, skybox);
 }
 }
@@ -0,0 +1,200 @@
+#include <chrono>
+#include <utility>
+#include <format>
+#include <engine/core/JobSystem.hpp>
+#include <engine/util/Errors.hpp>
+#include <engine/util/Profiler.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::core {
+/**
+ * @brief The system whose worker the calling thread is, and its index, or null on the other threads.
+ */
+static thread_local const JobSystem *t_job_system = nullptr;
+static thread_local uint32_t t_worker_index = 0;
+
+JobSystem::JobSystem(uint32_t number_of_workers) {
+    number_of_workers = std::max(number_of_workers, 1u);
+    m_workers.reserve(number_of_workers);
+    for (uint32_t i = 0; i < number_of_workers; ++i) {
+        m_workers.emplace_back(std::make_unique<Worker>());
+    }
+    // Start the threads only after all the deques exist, the workers steal from each other right away.
+    for (uint32_t i = 0; i < number_of_workers; ++i) {
+        m_workers[i]->thread = std::thread([this, i] {
+            t_job_system = this;
+            t_worker_index = i;
+            util::Profiler::instance()->set_thread_name(std::format("JobSystem worker {}", i));
+            worker_loop(i);
+        });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(m_sleep_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto &worker: m_workers) {
+        worker->thread.join();
+    }
+}
+
+uint32_t JobSystem::default_number_of_workers() {
+    uint32_t hardware_threads = std::thread::hardware_concurrency();
+    return std::max(hardware_threads, 2u) - 1;
+}
+
+uint32_t JobSystem::current_worker() const {
+    return t_job_system == this ? t_worker_index : NOT_A_WORKER;
+}
+
+void JobSystem::schedule(Job job, JobCounter *counter) {
+    if (counter) {
+        std::lock_guard lock(counter->m_mutex);
+        ++counter->m_pending;
+    }
+    uint32_t index = current_worker();
+    if (index == NOT_A_WORKER) {
+        index = m_next_worker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    }
+    {
+        std::lock_guard lock(m_workers[index]->mutex);
+        m_workers[index]->jobs.push_back(QueuedJob{std::move(job), counter});
+    }
+    m_queued.fetch_add(1, std::memory_order_release);
+    {
+        // A worker that has just seen no jobs either sleeps already or checks m_queued again under this lock.
+        std::lock_guard lock(m_sleep_mutex);
+    }
+    m_wake.notify_one();
+}
+
+std::optional<JobSystem::QueuedJob> JobSystem::find_job(uint32_t index) {
+    if (m_queued.load(std::memory_order_acquire) == 0) {
+        return std::nullopt;
+    }
+    const auto count = static_cast<uint32_t>(m_workers.size());
+    if (index != NOT_A_WORKER) {
+        Worker &own = *m_workers[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty()) {
+            QueuedJob job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    const uint32_t first_victim = index == NOT_A_WORKER ? 0 : index + 1;
+    for (uint32_t i = 0; i < count; ++i) {
+        Worker &victim = *m_workers[(first_victim + i) % count];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            QueuedJob job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            m_queued.fetch_sub(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return std::nullopt;
+}
+
+void JobSystem::run(QueuedJob &job) {
+    std::exception_ptr error;
+    {
+        RG_PROFILE_SCOPE("JobSystem", "job");
+        try {
+            job.function();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    if (!job.counter) {
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const util::Error &e) {
+                spdlog::error("JobSystem: a job failed: {}", e.report());
+            } catch (const std::exception &e) {
+                spdlog::error("JobSystem: a job failed: {}", e.what());
+            } catch (...) {
+                spdlog::error("JobSystem: a job failed with an unknown exception.");
+            }
+        }
+        return;
+    }
+    // Notify under the lock: the waiting thread may destroy the counter as soon as it sees zero.
+    std::lock_guard lock(job.counter->m_mutex);
+    if (error && !job.counter->m_error) {
+        job.counter->m_error = error;
+    }
+    if (--job.counter->m_pending == 0) {
+        job.counter->m_done.notify_all();
+    }
+}
+
+void JobSystem::worker_loop(uint32_t index) {
+    while (!m_stopping.load(std::memory_order_relaxed)) {
+        if (auto job = find_job(index)) {
+            run(*job);
+            continue;
+        }
+        std::unique_lock lock(m_sleep_mutex);
+        m_wake.wait(lock, [this] {
+            return m_stopping || m_queued.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+void JobSystem::wait(JobCounter &counter) {
+    const uint32_t index = current_worker();
+    while (true) {
+        if (counter.is_done()) {
+            break;
+        }
+        if (auto job = find_job(index)) {
+            run(*job);
+            continue;
+        }
+        // The remaining jobs are running on the other threads. Check for new jobs to help with now and then.
+        std::unique_lock lock(counter.m_mutex);
+        counter.m_done.wait_for(lock, std::chrono::microseconds(200), [&counter] {
+            return counter.m_pending == 0;
+        });
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard lock(counter.m_mutex);
+        error = std::exchange(counter.m_error, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void JobSystem::run_on_main_thread(Job job) {
+    std::lock_guard lock(m_main_thread_mutex);
+    m_main_thread_jobs.emplace_back(std::move(job));
+}
+
+void JobSystem::execute_main_thread_jobs() {
+    std::vector<Job> jobs;
+    {
+        std::lock_guard lock(m_main_thread_mutex);
+        jobs.swap(m_main_thread_jobs);
+    }
+    // A failing job must not take the rest of the batch with it.
+    for (auto &job: jobs) {
+        try {
+            job();
+        } catch (const util::Error &e) {
+            spdlog::error("JobSystem: a main thread job failed: {}", e.report());
+        } catch (const std::exception &e) {
+            spdlog::error("JobSystem: a main thread job failed: {}", e.what());
+        } catch (...) {
+            spdlog::error("JobSystem: a main thread job failed with an unknown exception.");
+        }
+    }
+}
+} // namespace engine::core
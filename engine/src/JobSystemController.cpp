@@ -0,0 +1,24 @@
+#include <engine/core/JobSystemController.hpp>
+#include <engine/util/Configuration.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::core {
+void JobSystemController::initialize() {
+    const auto &config = util::Configuration::config();
+    uint32_t workers = config.value(nlohmann::json::json_pointer("/jobs/workers"), 0u);
+    if (workers == 0) {
+        workers = JobSystem::default_number_of_workers();
+    }
+    m_job_system = std::make_unique<JobSystem>(workers);
+    spdlog::info("JobSystem started {} workers.", m_job_system->number_of_workers());
+}
+
+bool JobSystemController::loop() {
+    m_job_system->execute_main_thread_jobs();
+    return true;
+}
+
+void JobSystemController::terminate() {
+    m_job_system.reset();
+}
+} // namespace engine::core
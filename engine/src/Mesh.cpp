@@ -1,70 +1,99 @@
 #include<glad/glad.h>
 #include <engine/util/Utils.hpp>
+#include <engine/graphics/GraphicsController.hpp>
+#include <engine/graphics/OpenGL.hpp>
 #include <engine/resources/Mesh.hpp>
 #include <engine/resources/Shader.hpp>
+#include <algorithm>
+#include <cmath>
+#include <format>
 #include <unordered_map>
 
 namespace engine::resources {
 
-Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
-           std::vector<Texture *> textures) {
-    // NOLINTBEGIN
-    static_assert(std::is_trivial_v<Vertex>);
-    uint32_t VAO, VBO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(indices[0]), indices.data(), GL_STATIC_DRAW);
+MeshBounds compute_bounds(const std::vector<Vertex> &vertices, const graphics::AABB &aabb) {
+    MeshBounds bounds;
+    bounds.aabb = aabb;
+    bounds.sphere.center = aabb.center();
+    float radius_squared = 0.0f;
+    for (const auto &vertex: vertices) {
+        const glm::vec3 offset = vertex.Position - bounds.sphere.center;
+        radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+    }
+    bounds.sphere.radius = std::sqrt(radius_squared);
+    return bounds;
+}
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Position));
+MeshBounds compute_bounds(const std::vector<Vertex> &vertices) {
+    graphics::AABB aabb;
+    for (const auto &vertex: vertices) {
+        aabb.expand(vertex.Position);
+    }
+    return compute_bounds(vertices, aabb);
+}
 
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Normal));
+Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<uint32_t> &indices,
+           std::vector<Texture *> textures, const MeshBounds &bounds) : m_bounds(bounds) {
+    static_assert(std::is_trivial_v<Vertex>);
+    m_geometry = core::Controller::get<graphics::GraphicsController>()->geometry_pool()
+                                                                       .allocate(vertices, indices);
+    m_textures = std::move(textures);
 
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, TexCoords));
+    std::unordered_map<std::string_view, uint32_t> counts;
+    m_sampler_names.reserve(m_textures.size());
+    for (const auto texture: m_textures) {
+        const auto &texture_type = Texture::uniform_name_convention(texture->type());
+        const auto count = (counts[texture_type] += 1);
+        m_sampler_names.emplace_back(std::format("{}{}", texture_type, count));
+    }
+}
 
-    glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Tangent));
+void Mesh::draw(const Shader *shader) {
+    bind_textures(shader);
+    core::Controller::get<graphics::GraphicsController>()->geometry_pool()
+                                                         .bind();
+    // NOLINTNEXTLINE
+    glDrawElementsBaseVertex(GL_TRIANGLES, m_geometry.index_count, GL_UNSIGNED_INT,
+                             (void *) (m_geometry.first_index * sizeof(uint32_t)), m_geometry.base_vertex);
+}
 
-    glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) offsetof(Vertex, Bitangent));
+void Mesh::draw_instanced(const Shader *shader, uint32_t instance_count) {
+    bind_textures(shader);
+    core::Controller::get<graphics::GraphicsController>()->geometry_pool()
+                                                         .bind();
+    // NOLINTNEXTLINE
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_geometry.index_count, GL_UNSIGNED_INT,
+                                      (void *) (m_geometry.first_index * sizeof(uint32_t)), instance_count,
+                                      m_geometry.base_vertex);
+}
 
-    glBindVertexArray(0);
-    // NOLINTEND
-    m_vao = VAO;
-    m_num_indices = indices.size();
-    m_textures = std::move(textures);
+uint16_t Mesh::material_key() const {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const auto texture: m_textures) {
+        const uint32_t id = texture->id();
+        hash = util::fnv1a(std::string_view(reinterpret_cast<const char *>(&id), sizeof(id)), hash);
+    }
+    return static_cast<uint16_t>(hash ^ (hash >> 16) ^ (hash >> 32) ^ (hash >> 48));
 }
 
-void Mesh::draw(const Shader *shader) {
-    std::unordered_map<std::string_view, uint32_t> counts;
-    std::string uniform_name;
-    uniform_name.reserve(32);
+void Mesh::bind_textures(const Shader *shader) {
+    if (m_sampler_shader_id != shader->id() || m_sampler_uniforms.size() != m_sampler_names.size()) {
+        m_sampler_uniforms.clear();
+        for (const auto &sampler_name: m_sampler_names) {
+            m_sampler_uniforms.emplace_back(shader->uniform(sampler_name));
+        }
+        m_sampler_shader_id = shader->id();
+    }
     for (int i = 0; i < m_textures.size(); i++) {
-        glActiveTexture(GL_TEXTURE0 + i);
-        const auto &texture_type = Texture::uniform_name_convention(m_textures[i]->type());
-        uniform_name.append(texture_type);
-        const auto count = (counts[texture_type] += 1);
-        uniform_name.append(std::to_string(count));
-        shader->set_int(uniform_name, i);
-        glBindTexture(GL_TEXTURE_2D, m_textures[i]->id());
-        uniform_name.clear();
+        shader->set_int(m_sampler_uniforms[i], i);
+        graphics::OpenGL::bind_texture(i, GL_TEXTURE_2D, m_textures[i]->id());
     }
-    glBindVertexArray(m_vao);
-    glDrawElements(GL_TRIANGLES, m_num_indices, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
 }
 
 void Mesh::destroy() {
-    glDeleteVertexArrays(1, &m_vao);
+    core::Controller::get<graphics::GraphicsController>()->geometry_pool()
+                                                         .free(m_geometry);
+    m_geometry = graphics::GeometryRange{};
 }
 
 }
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <engine/resources/MeshCache.hpp>
+#include <engine/resources/ModelImporter.hpp>
+#include <engine/util/Utils.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::resources {
+static_assert(std::endian::native == std::endian::little, "MeshCache files are stored in little-endian.");
+static_assert(std::is_trivially_copyable_v<Vertex>);
+
+struct MeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t vertex_size;
+    uint32_t import_flags;
+    uint32_t mesh_count;
+    int64_t source_mtime;
+    uint64_t source_size;
+    uint64_t source_path_hash;
+    uint32_t node_count;
+    uint32_t padding[3];
+};
+
+struct MeshCacheRecord {
+    uint64_t vertex_count;
+    uint64_t index_count;
+    uint32_t texture_count;
+    float aabb_min[3];
+    float aabb_max[3];
+    float sphere_center[3];
+    float sphere_radius;
+    uint32_t padding;
+};
+
+struct MeshCacheNodeRecord {
+    float transform[16];
+    int32_t parent;
+    uint32_t mesh_count;
+    uint32_t name_length;
+    uint32_t padding;
+};
+
+static_assert(sizeof(MeshCacheHeader) % 16 == 0);
+static_assert(sizeof(MeshCacheRecord) % 16 == 0);
+static_assert(sizeof(MeshCacheNodeRecord) % 16 == 0);
+
+constexpr char g_mesh_cache_magic[8] = {'R', 'G', 'M', 'E', 'S', 'H', 0, 0};
+constexpr std::streamoff g_section_alignment = 16;
+
+static uint64_t source_path_hash(const std::filesystem::path &model_path, uint32_t import_flags) {
+    uint64_t hash = util::fnv1a(model_path.lexically_normal()
+                                          .generic_string());
+    return util::fnv1a(std::string_view(reinterpret_cast<const char *>(&import_flags), sizeof(import_flags)), hash);
+}
+
+static MeshCacheHeader make_header(const std::filesystem::path &model_path, bool flip_uvs) {
+    MeshCacheHeader header{};
+    std::memcpy(header.magic, g_mesh_cache_magic, sizeof(header.magic));
+    header.version = MeshCache::VERSION;
+    header.vertex_size = sizeof(Vertex);
+    header.import_flags = ModelImporter::import_flags(flip_uvs);
+    header.source_mtime = std::filesystem::last_write_time(model_path)
+                          .time_since_epoch()
+                          .count();
+    header.source_size = std::filesystem::file_size(model_path);
+    header.source_path_hash = source_path_hash(model_path, header.import_flags);
+    return header;
+}
+
+static void pad_to_alignment(std::ofstream &file) {
+    static constexpr char zeros[g_section_alignment] = {};
+    std::streamoff offset = file.tellp();
+    file.write(zeros, util::align_up(offset, g_section_alignment) - offset);
+}
+
+static void skip_to_alignment(std::ifstream &file) {
+    file.seekg(util::align_up(file.tellg(), g_section_alignment));
+}
+
+std::filesystem::path MeshCache::cache_file_path(const std::filesystem::path &model_path, bool flip_uvs) const {
+    uint64_t hash = source_path_hash(model_path, ModelImporter::import_flags(flip_uvs));
+    return m_cache_directory / std::format("{}-{:016x}.rgmesh", model_path.stem()
+                                                                     .string(), hash);
+}
+
+ModelData MeshCache::import(const std::filesystem::path &model_path, bool flip_uvs) const {
+    if (!m_enabled) {
+        return ModelImporter::import(model_path, flip_uvs);
+    }
+    if (auto cached = load(model_path, flip_uvs)) {
+        spdlog::info("MeshCache: loaded {} from {}", model_path.string(),
+                     cache_file_path(model_path, flip_uvs).string());
+        return std::move(cached.value());
+    }
+    ModelData model = ModelImporter::import(model_path, flip_uvs);
+    store(model_path, flip_uvs, model);
+    return model;
+}
+
+std::optional<ModelData> MeshCache::load(const std::filesystem::path &model_path, bool flip_uvs) const {
+    std::error_code error;
+    auto cache_path = cache_file_path(model_path, flip_uvs);
+    if (!std::filesystem::exists(cache_path, error) || !std::filesystem::exists(model_path, error)) {
+        return std::nullopt;
+    }
+    const auto cache_size = static_cast<uint64_t>(std::filesystem::file_size(cache_path, error));
+    std::ifstream file(cache_path, std::ios::binary);
+    if (error || !file.is_open()) {
+        return std::nullopt;
+    }
+
+    const MeshCacheHeader expected = make_header(model_path, flip_uvs);
+    MeshCacheHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+        header.version != expected.version || header.vertex_size != expected.vertex_size ||
+        header.import_flags != expected.import_flags || header.source_mtime != expected.source_mtime ||
+        header.source_size != expected.source_size || header.source_path_hash != expected.source_path_hash) {
+        spdlog::info("MeshCache: {} is stale, importing {} again", cache_path.string(), model_path.string());
+        return std::nullopt;
+    }
+
+    // Every mesh and node has at least its record in the file, so the counts can't be bigger than that.
+    if (header.mesh_count > cache_size / sizeof(MeshCacheRecord) ||
+        header.node_count > cache_size / sizeof(MeshCacheNodeRecord)) {
+        spdlog::warn("MeshCache: {} is corrupted", cache_path.string());
+        return std::nullopt;
+    }
+
+    ModelData model;
+    model.meshes.resize(header.mesh_count);
+    for (auto &mesh: model.meshes) {
+        MeshCacheRecord record{};
+        file.read(reinterpret_cast<char *>(&record), sizeof(record));
+        if (!file || record.vertex_count * sizeof(Vertex) > cache_size ||
+            record.index_count * sizeof(uint32_t) > cache_size ||
+            record.texture_count * 2 * sizeof(uint32_t) > cache_size) {
+            spdlog::warn("MeshCache: {} is corrupted", cache_path.string());
+            return std::nullopt;
+        }
+        mesh.bounds.aabb.min = glm::vec3(record.aabb_min[0], record.aabb_min[1], record.aabb_min[2]);
+        mesh.bounds.aabb.max = glm::vec3(record.aabb_max[0], record.aabb_max[1], record.aabb_max[2]);
+        mesh.bounds.sphere.center = glm::vec3(record.sphere_center[0], record.sphere_center[1],
+                                              record.sphere_center[2]);
+        mesh.bounds.sphere.radius = record.sphere_radius;
+        mesh.textures.reserve(record.texture_count);
+        for (uint32_t i = 0; i < record.texture_count; ++i) {
+            uint32_t type = 0, path_length = 0;
+            file.read(reinterpret_cast<char *>(&type), sizeof(type));
+            file.read(reinterpret_cast<char *>(&path_length), sizeof(path_length));
+            if (!file || path_length > cache_size || type > static_cast<uint32_t>(TextureType::Height)) {
+                spdlog::warn("MeshCache: {} is corrupted", cache_path.string());
+                return std::nullopt;
+            }
+            std::string path(path_length, '\0');
+            file.read(path.data(), path_length);
+            mesh.textures.emplace_back(std::filesystem::path(path), static_cast<TextureType>(type));
+        }
+        skip_to_alignment(file);
+        mesh.vertices.resize(record.vertex_count);
+        file.read(reinterpret_cast<char *>(mesh.vertices.data()), record.vertex_count * sizeof(Vertex));
+        skip_to_alignment(file);
+        mesh.indices.resize(record.index_count);
+        file.read(reinterpret_cast<char *>(mesh.indices.data()), record.index_count * sizeof(uint32_t));
+        skip_to_alignment(file);
+        // The indices go straight into the GeometryPool, so they must be whole triangles of this mesh.
+        if (!file || record.index_count % 3 != 0 || std::ranges::any_of(mesh.indices, [&record](uint32_t index) {
+            return index >= record.vertex_count;
+        })) {
+            spdlog::warn("MeshCache: {} is corrupted", cache_path.string());
+            return std::nullopt;
+        }
+    }
+    model.nodes.resize(header.node_count);
+    for (size_t i = 0; i < model.nodes.size(); ++i) {
+        auto &node = model.nodes[i];
+        MeshCacheNodeRecord record{};
+        file.read(reinterpret_cast<char *>(&record), sizeof(record));
+        // The parents must come before their children, as the Model expects.
+        if (!file || record.parent >= static_cast<int64_t>(i) || record.parent < -1 ||
+            record.mesh_count * sizeof(uint32_t) > cache_size || record.name_length > cache_size) {
+            spdlog::warn("MeshCache: {} is corrupted", cache_path.string());
+            return std::nullopt;
+        }
+        std::memcpy(&node.transform[0][0], record.transform, sizeof(record.transform));
+        node.parent = record.parent;
+        node.meshes.resize(record.mesh_count);
+        file.read(reinterpret_cast<char *>(node.meshes.data()), record.mesh_count * sizeof(uint32_t));
+        node.name.resize(record.name_length);
+        file.read(node.name.data(), record.name_length);
+        skip_to_alignment(file);
+        if (!file || std::ranges::any_of(node.meshes, [&header](uint32_t mesh) {
+            return mesh >= header.mesh_count;
+        })) {
+            spdlog::warn("MeshCache: {} is corrupted", cache_path.string());
+            return std::nullopt;
+        }
+    }
+    return model;
+}
+
+bool MeshCache::store(const std::filesystem::path &model_path, bool flip_uvs,
+                      const ModelData &model) const {
+    std::error_code error;
+    std::filesystem::create_directories(m_cache_directory, error);
+    auto cache_path = cache_file_path(model_path, flip_uvs);
+    // Write into a file unique to this thread and rename it, so that concurrent imports of the same model
+    // never leave a partially written cache file behind.
+    auto temporary_path = cache_path;
+    temporary_path += std::format(".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            spdlog::warn("MeshCache: failed to open {} for writing", temporary_path.string());
+            return false;
+        }
+        MeshCacheHeader header = make_header(model_path, flip_uvs);
+        header.mesh_count = model.meshes.size();
+        header.node_count = model.nodes.size();
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (const auto &mesh: model.meshes) {
+            MeshCacheRecord record{};
+            record.vertex_count = mesh.vertices.size();
+            record.index_count = mesh.indices.size();
+            record.texture_count = mesh.textures.size();
+            for (int i = 0; i < 3; ++i) {
+                record.aabb_min[i] = mesh.bounds.aabb.min[i];
+                record.aabb_max[i] = mesh.bounds.aabb.max[i];
+                record.sphere_center[i] = mesh.bounds.sphere.center[i];
+            }
+            record.sphere_radius = mesh.bounds.sphere.radius;
+            file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            for (const auto &texture: mesh.textures) {
+                const std::string path = texture.path.string();
+                const auto type = static_cast<uint32_t>(texture.type);
+                const auto path_length = static_cast<uint32_t>(path.size());
+                file.write(reinterpret_cast<const char *>(&type), sizeof(type));
+                file.write(reinterpret_cast<const char *>(&path_length), sizeof(path_length));
+                file.write(path.data(), path_length);
+            }
+            pad_to_alignment(file);
+            file.write(reinterpret_cast<const char *>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+            pad_to_alignment(file);
+            file.write(reinterpret_cast<const char *>(mesh.indices.data()), mesh.indices.size() * sizeof(uint32_t));
+            pad_to_alignment(file);
+        }
+        for (const auto &node: model.nodes) {
+            MeshCacheNodeRecord record{};
+            std::memcpy(record.transform, &node.transform[0][0], sizeof(record.transform));
+            record.parent = node.parent;
+            record.mesh_count = node.meshes.size();
+            record.name_length = node.name.size();
+            file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            file.write(reinterpret_cast<const char *>(node.meshes.data()), node.meshes.size() * sizeof(uint32_t));
+            file.write(node.name.data(), node.name.size());
+            pad_to_alignment(file);
+        }
+        if (!file) {
+            spdlog::warn("MeshCache: failed to write {}", temporary_path.string());
+            file.close();
+            std::filesystem::remove(temporary_path, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary_path, cache_path, error);
+    if (error) {
+        spdlog::warn("MeshCache: failed to write {}: {}", cache_path.string(), error.message());
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    spdlog::info("MeshCache: stored {} into {}", model_path.string(), cache_path.string());
+    return true;
+}
+} // namespace engine::resources
@@ -1,16 +1,177 @@
-
+#include <glad/glad.h>
+#include <engine/graphics/GpuProfiler.hpp>
+#include <engine/graphics/GraphicsController.hpp>
+#include <engine/graphics/OpenGL.hpp>
 #include <engine/resources/Model.hpp>
 #include <engine/resources/Shader.hpp>
+#include <engine/util/Errors.hpp>
 
 namespace engine::resources {
 
+Model::Model(std::vector<Mesh> meshes, const std::vector<NodeData> &nodes, std::filesystem::path path,
+             std::string name) : m_meshes(std::move(meshes))
+                                 , m_path(std::move(path))
+                                 , m_name(std::move(name)) {
+    if (nodes.empty()) {
+        m_node_names.emplace_back(m_name);
+        m_parents.push_back(-1);
+        m_local_transforms.emplace_back(1.0f);
+        for (uint32_t i = 0; i < m_meshes.size(); ++i) {
+            m_instances.push_back(MeshInstance{i, 0});
+        }
+    }
+    for (uint32_t node = 0; node < nodes.size(); ++node) {
+        const auto &data = nodes[node];
+        RG_GUARANTEE(data.parent < static_cast<int32_t>(node), "Node {} of the model {} comes before its parent.",
+                     node, m_name);
+        m_node_names.push_back(data.name);
+        m_parents.push_back(data.parent);
+        m_local_transforms.push_back(data.transform);
+        for (uint32_t mesh: data.meshes) {
+            RG_GUARANTEE(mesh < m_meshes.size(), "Node {} of the model {} references the mesh {} out of {}.", node,
+                         m_name, mesh, m_meshes.size());
+            m_instances.push_back(MeshInstance{mesh, node});
+        }
+    }
+    std::stable_sort(m_instances.begin(), m_instances.end(), [](const MeshInstance &a, const MeshInstance &b) {
+        return a.mesh < b.mesh;
+    });
+    // Walking backwards, every node has seen all its descendants, which extend the subtree of its parent.
+    m_subtree_ends.resize(m_parents.size());
+    for (size_t node = m_parents.size(); node-- > 0;) {
+        m_subtree_ends[node] = std::max(m_subtree_ends[node], static_cast<uint32_t>(node + 1));
+        if (m_parents[node] >= 0) {
+            auto &parent_end = m_subtree_ends[m_parents[node]];
+            parent_end = std::max(parent_end, m_subtree_ends[node]);
+        }
+    }
+    m_world_transforms.resize(m_parents.size(), glm::mat4(1.0f));
+    for (uint32_t node = 0; node < m_parents.size(); ++node) {
+        if (m_parents[node] < 0) {
+            m_dirty_nodes.push_back(node);
+        }
+    }
+    update_transforms();
+}
+
+std::optional<uint32_t> Model::find_node(std::string_view name) const {
+    auto it = std::find(m_node_names.begin(), m_node_names.end(), name);
+    if (it == m_node_names.end()) {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(it - m_node_names.begin());
+}
+
+void Model::set_local_transform(uint32_t node, const glm::mat4 &transform) {
+    RG_GUARANTEE(node < m_local_transforms.size(), "Node {} is out of {} in the model {}.", node,
+                 m_local_transforms.size(), m_name);
+    m_local_transforms[node] = transform;
+    m_dirty_nodes.push_back(node);
+    m_occluder_stale = true;
+}
+
+void Model::update_transforms() {
+    if (m_dirty_nodes.empty()) {
+        return;
+    }
+    // In the index order, a changed node inside a subtree that was already swept was updated with it. Otherwise its
+    // parent is up to date, and the sweep over its subtree meets every parent before its children.
+    std::sort(m_dirty_nodes.begin(), m_dirty_nodes.end());
+    uint32_t swept_end = 0;
+    for (uint32_t dirty: m_dirty_nodes) {
+        if (dirty < swept_end) {
+            continue;
+        }
+        swept_end = m_subtree_ends[dirty];
+        for (uint32_t node = dirty; node < swept_end; ++node) {
+            const int32_t parent = m_parents[node];
+            m_world_transforms[node] = parent < 0
+                                       ? m_local_transforms[node]
+                                       : m_world_transforms[parent] * m_local_transforms[node];
+        }
+    }
+    m_dirty_nodes.clear();
+    m_bounds_dirty = true;
+}
+
 void Model::draw(const Shader *shader) {
+    RG_GPU_PROFILE_SCOPE("Model::draw");
     shader->use();
     for (auto &mesh: m_meshes) {
         mesh.draw(shader);
     }
 }
 
+void Model::draw(const Shader *shader, const glm::mat4 &transform) {
+    RG_GPU_PROFILE_SCOPE("Model::draw");
+    update_transforms();
+    shader->use();
+    if (shader->reads_instance_model()) {
+        draw_mesh_instances(shader, std::span(&transform, 1));
+        return;
+    }
+    const auto model_uniform = shader->uniform("model");
+    for (const auto &instance: m_instances) {
+        shader->set_mat4(model_uniform, transform * m_world_transforms[instance.node]);
+        m_meshes[instance.mesh].draw(shader);
+    }
+}
+
+void Model::draw_instanced(const Shader *shader, std::span<const glm::mat4> transforms) {
+    if (transforms.empty()) {
+        return;
+    }
+    update_transforms();
+    shader->use();
+    draw_mesh_instances(shader, transforms);
+}
+
+void Model::draw_mesh_instances(const Shader *shader, std::span<const glm::mat4> transforms) {
+    auto &stream = core::Controller::get<graphics::GraphicsController>()->stream_buffer();
+    auto &geometry_pool = core::Controller::get<graphics::GraphicsController>()->geometry_pool();
+    // The instances are sorted by mesh, so every mesh is drawn once for all its nodes and all the transforms.
+    for (size_t first = 0; first < m_instances.size();) {
+        const uint32_t mesh = m_instances[first].mesh;
+        size_t last = first + 1;
+        while (last < m_instances.size() && m_instances[last].mesh == mesh) {
+            ++last;
+        }
+        const size_t instance_count = (last - first) * transforms.size();
+        const auto instances = stream.allocate(instance_count * sizeof(glm::mat4), alignof(glm::mat4));
+        auto *data = static_cast<glm::mat4 *>(instances.data);
+        for (size_t i = first; i < last; ++i) {
+            const glm::mat4 &world = m_world_transforms[m_instances[i].node];
+            for (const auto &transform: transforms) {
+                *data++ = transform * world;
+            }
+        }
+        stream.commit(instances);
+        geometry_pool.attach_instance_buffer(instances.buffer, instances.offset);
+        m_meshes[mesh].draw_instanced(shader, static_cast<uint32_t>(instance_count));
+        first = last;
+    }
+    geometry_pool.detach_instance_buffer();
+}
+
+void Model::update_bounds() const {
+    m_bounds_dirty = false;
+    m_bounds = MeshBounds{};
+    for (const auto &instance: m_instances) {
+        const auto &world = m_world_transforms[instance.node];
+        m_bounds.aabb.expand(m_meshes[instance.mesh].bounds().aabb.transformed(world));
+    }
+    if (m_bounds.aabb.is_empty()) {
+        return;
+    }
+    m_bounds.sphere.center = m_bounds.aabb.center();
+    for (const auto &instance: m_instances) {
+        const auto &world = m_world_transforms[instance.node];
+        const auto sphere = m_meshes[instance.mesh].bounds().sphere.transformed(world);
+        m_bounds.sphere.radius = std::max(m_bounds.sphere.radius,
+                                          glm::length(sphere.center - m_bounds.sphere.center) + sphere.radius);
+    }
+}
+
 void Model::destroy() {
     for (auto &mesh: m_meshes) {
         mesh.destroy();
@@ -0,0 +1,212 @@
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <engine/resources/ModelImporter.hpp>
+#include <engine/util/Errors.hpp>
+
+namespace engine::resources {
+
+/**
+ * @class AssimpSceneProcessor
+ * @brief Processes the meshes in an Assimp scene into the CPU memory. Doesn't touch the OpenGL context.
+ */
+class AssimpSceneProcessor {
+public:
+    /**
+     * @brief Processes the meshes and the node hierarchy of the scene.
+     * @returns The meshes and the nodes of the scene.
+     */
+    ModelData process_scene();
+
+    explicit AssimpSceneProcessor(const aiScene *scene, std::filesystem::path model_path) :
+            m_scene(scene), m_model_path(std::move(model_path)) {
+    }
+
+private:
+    /**
+     * @brief Appends the `node` to the node table, after its `parent`, and then its children.
+     */
+    void process_node(const aiNode *node, int32_t parent);
+
+    void process_mesh(aiMesh *mesh);
+
+    std::vector<TextureReference> process_materials(const aiMaterial *material);
+
+    void process_material_type(std::vector<TextureReference> &textures, const aiMaterial *material,
+                               aiTextureType type);
+
+    static TextureType assimp_texture_type_to_engine(aiTextureType type);
+
+    ModelData m_model;
+    /**
+     * @brief The index in the @ref ModelData::meshes of every aiMesh of the scene, or -1 until a node references it.
+     */
+    std::vector<int32_t> m_mesh_indices;
+    const aiScene *m_scene;
+    std::filesystem::path m_model_path;
+};
+
+uint32_t ModelImporter::import_flags(bool flip_uvs) {
+    uint32_t flags = aiProcess_Triangulate | aiProcess_GenSmoothNormals |
+                     aiProcess_CalcTangentSpace | aiProcess_GenBoundingBoxes;
+    if (flip_uvs) {
+        flags |= aiProcess_FlipUVs;
+    }
+    return flags;
+}
+
+ModelData ModelImporter::import(const std::filesystem::path &model_path, bool flip_uvs) {
+    Assimp::Importer importer;
+    const aiScene *scene =
+            importer.ReadFile(model_path, import_flags(flip_uvs));
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        throw util::EngineError(util::EngineError::Type::AssetLoadingError,
+                                std::format("Assimp error while reading model from path {}.",
+                                            model_path.string()));
+    }
+    AssimpSceneProcessor scene_processor(scene, model_path);
+    return scene_processor.process_scene();
+}
+
+ModelData AssimpSceneProcessor::process_scene() {
+    m_model = ModelData{};
+    m_mesh_indices.assign(m_scene->mNumMeshes, -1);
+    process_node(m_scene->mRootNode, -1);
+    return std::move(m_model);
+}
+
+/**
+ * @brief Converts the row-major Assimp matrix into the column-major glm one.
+ */
+static glm::mat4 to_glm(const aiMatrix4x4 &matrix) {
+    return glm::transpose(glm::mat4(matrix.a1, matrix.a2, matrix.a3, matrix.a4, matrix.b1, matrix.b2, matrix.b3,
+                                    matrix.b4, matrix.c1, matrix.c2, matrix.c3, matrix.c4, matrix.d1, matrix.d2,
+                                    matrix.d3, matrix.d4));
+}
+
+void AssimpSceneProcessor::process_node(const aiNode *node, int32_t parent) {
+    const auto index = static_cast<int32_t>(m_model.nodes.size());
+    NodeData node_data;
+    node_data.name = node->mName.C_Str();
+    node_data.transform = to_glm(node->mTransformation);
+    node_data.parent = parent;
+    // A mesh referenced by many nodes is converted once, and the nodes become its instances.
+    for (uint32_t i = 0; i < node->mNumMeshes; ++i) {
+        auto &mesh_index = m_mesh_indices[node->mMeshes[i]];
+        if (mesh_index < 0) {
+            mesh_index = static_cast<int32_t>(m_model.meshes.size());
+            process_mesh(m_scene->mMeshes[node->mMeshes[i]]);
+        }
+        node_data.meshes.push_back(static_cast<uint32_t>(mesh_index));
+    }
+    m_model.nodes.push_back(std::move(node_data));
+    for (uint32_t i = 0; i < node->mNumChildren; ++i) {
+        process_node(node->mChildren[i], index);
+    }
+}
+
+void AssimpSceneProcessor::process_mesh(aiMesh *mesh) {
+    std::vector<Vertex> vertices;
+    vertices.reserve(mesh->mNumVertices);
+    for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
+        Vertex vertex{};
+        vertex.Position
+              .x = mesh->mVertices[i].x;
+        vertex.Position
+              .y = mesh->mVertices[i].y;
+        vertex.Position
+              .z = mesh->mVertices[i].z;
+
+        if (mesh->HasNormals()) {
+            vertex.Normal
+                  .x = mesh->mNormals[i].x;
+            vertex.Normal
+                  .y = mesh->mNormals[i].y;
+            vertex.Normal
+                  .z = mesh->mNormals[i].z;
+        }
+
+        if (mesh->mTextureCoords[0]) {
+            vertex.TexCoords
+                  .x = mesh->mTextureCoords[0][i].x;
+            vertex.TexCoords
+                  .y = mesh->mTextureCoords[0][i].y;
+
+            vertex.Tangent
+                  .x = mesh->mTangents[i].x;
+            vertex.Tangent
+                  .y = mesh->mTangents[i].y;
+            vertex.Tangent
+                  .z = mesh->mTangents[i].z;
+
+            vertex.Bitangent
+                  .x = mesh->mBitangents[i].x;
+            vertex.Bitangent
+                  .y = mesh->mBitangents[i].y;
+            vertex.Bitangent
+                  .z = mesh->mBitangents[i].z;
+        }
+        vertices.push_back(vertex);
+    }
+
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < mesh->mNumFaces; ++i) {
+        aiFace face = mesh->mFaces[i];
+        // The meshes are drawn as triangles; the points and lines that triangulation leaves are skipped.
+        if (face.mNumIndices != 3) {
+            continue;
+        }
+        for (uint32_t j = 0; j < face.mNumIndices; ++j) {
+            indices.push_back(face.mIndices[j]);
+        }
+    }
+
+    graphics::AABB aabb;
+    aabb.min = glm::vec3(mesh->mAABB.mMin.x, mesh->mAABB.mMin.y, mesh->mAABB.mMin.z);
+    aabb.max = glm::vec3(mesh->mAABB.mMax.x, mesh->mAABB.mMax.y, mesh->mAABB.mMax.z);
+    MeshBounds bounds = compute_bounds(vertices, aabb);
+
+    auto material = m_scene->mMaterials[mesh->mMaterialIndex];
+    m_model.meshes.emplace_back(MeshData{std::move(vertices), std::move(indices), process_materials(material), bounds});
+}
+
+std::vector<TextureReference> AssimpSceneProcessor::process_materials(const aiMaterial *material) {
+    std::vector<TextureReference> textures;
+    auto ai_texture_types = {
+            aiTextureType_DIFFUSE,
+            aiTextureType_SPECULAR,
+            aiTextureType_NORMALS,
+            aiTextureType_HEIGHT,
+    };
+
+    for (auto ai_texture_type: ai_texture_types) {
+        process_material_type(textures, material, ai_texture_type);
+    }
+    return textures;
+}
+
+void AssimpSceneProcessor::process_material_type(std::vector<TextureReference> &textures,
+                                                 const aiMaterial *material,
+                                                 aiTextureType type) {
+    auto material_count = material->GetTextureCount(type);
+    for (uint32_t i = 0; i < material_count; ++i) {
+        aiString ai_texture_path_string;
+        material->GetTexture(type, i, &ai_texture_path_string);
+        std::filesystem::path texture_path = m_model_path.parent_path() / ai_texture_path_string.C_Str();
+        textures.emplace_back(texture_path, assimp_texture_type_to_engine(type));
+    }
+}
+
+TextureType AssimpSceneProcessor::assimp_texture_type_to_engine(aiTextureType type) {
+    switch (type) {
+        case aiTextureType_DIFFUSE: return TextureType::Diffuse;
+        case aiTextureType_SPECULAR: return TextureType::Specular;
+        case aiTextureType_HEIGHT: return TextureType::Height;
+        case aiTextureType_NORMALS: return TextureType::Normal;
+        default: RG_SHOULD_NOT_REACH_HERE("Engine currently doesn't support the aiTextureType: {}",
+                                          static_cast<int>(type));
+    }
+}
+
+} // namespace engine
@@ -0,0 +1,683 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <tuple>
+#include <engine/core/JobSystem.hpp>
+#include <engine/graphics/OcclusionCuller.hpp>
+#include <engine/util/Errors.hpp>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace engine::graphics {
+/**
+* @brief The pixel kernels are written once against these operations on 8, 4 or 1 lanes of floats. A mask has all
+* the bits of a lane set where the comparison holds, so that it can select a value with @ref both.
+*/
+#if defined(__AVX__)
+using Lanes = __m256;
+static constexpr uint32_t LANE_COUNT = 8;
+static constexpr const char *KERNEL_NAME = "AVX";
+
+static Lanes splat(float value) {
+    return _mm256_set1_ps(value);
+}
+
+static Lanes lane_offsets() {
+    return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+}
+
+static Lanes load(const float *values) {
+    return _mm256_loadu_ps(values);
+}
+
+static void store(float *values, Lanes lanes) {
+    _mm256_storeu_ps(values, lanes);
+}
+
+static Lanes add(Lanes a, Lanes b) {
+    return _mm256_add_ps(a, b);
+}
+
+static Lanes multiply(Lanes a, Lanes b) {
+    return _mm256_mul_ps(a, b);
+}
+
+static Lanes maximum(Lanes a, Lanes b) {
+    return _mm256_max_ps(a, b);
+}
+
+static Lanes minimum(Lanes a, Lanes b) {
+    return _mm256_min_ps(a, b);
+}
+
+static Lanes greater_equal(Lanes a, Lanes b) {
+    return _mm256_cmp_ps(a, b, _CMP_GE_OQ);
+}
+
+static Lanes less_equal(Lanes a, Lanes b) {
+    return _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+}
+
+static Lanes both(Lanes a, Lanes b) {
+    return _mm256_and_ps(a, b);
+}
+
+static uint32_t mask_bits(Lanes mask) {
+    return static_cast<uint32_t>(_mm256_movemask_ps(mask));
+}
+#elif defined(__SSE2__) || defined(_M_X64)
+using Lanes = __m128;
+static constexpr uint32_t LANE_COUNT = 4;
+static constexpr const char *KERNEL_NAME = "SSE2";
+
+static Lanes splat(float value) {
+    return _mm_set1_ps(value);
+}
+
+static Lanes lane_offsets() {
+    return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+}
+
+static Lanes load(const float *values) {
+    return _mm_loadu_ps(values);
+}
+
+static void store(float *values, Lanes lanes) {
+    _mm_storeu_ps(values, lanes);
+}
+
+static Lanes add(Lanes a, Lanes b) {
+    return _mm_add_ps(a, b);
+}
+
+static Lanes multiply(Lanes a, Lanes b) {
+    return _mm_mul_ps(a, b);
+}
+
+static Lanes maximum(Lanes a, Lanes b) {
+    return _mm_max_ps(a, b);
+}
+
+static Lanes minimum(Lanes a, Lanes b) {
+    return _mm_min_ps(a, b);
+}
+
+static Lanes greater_equal(Lanes a, Lanes b) {
+    return _mm_cmpge_ps(a, b);
+}
+
+static Lanes less_equal(Lanes a, Lanes b) {
+    return _mm_cmple_ps(a, b);
+}
+
+static Lanes both(Lanes a, Lanes b) {
+    return _mm_and_ps(a, b);
+}
+
+static uint32_t mask_bits(Lanes mask) {
+    return static_cast<uint32_t>(_mm_movemask_ps(mask));
+}
+#else
+using Lanes = float;
+static constexpr uint32_t LANE_COUNT = 1;
+static constexpr const char *KERNEL_NAME = "scalar";
+
+static Lanes splat(float value) {
+    return value;
+}
+
+static Lanes lane_offsets() {
+    return 0.0f;
+}
+
+static Lanes load(const float *values) {
+    return *values;
+}
+
+static void store(float *values, Lanes lanes) {
+    *values = lanes;
+}
+
+static Lanes add(Lanes a, Lanes b) {
+    return a + b;
+}
+
+static Lanes multiply(Lanes a, Lanes b) {
+    return a * b;
+}
+
+static Lanes maximum(Lanes a, Lanes b) {
+    return std::max(a, b);
+}
+
+static Lanes minimum(Lanes a, Lanes b) {
+    return std::min(a, b);
+}
+
+static Lanes greater_equal(Lanes a, Lanes b) {
+    return std::bit_cast<float>(a >= b ? ~0u : 0u);
+}
+
+static Lanes less_equal(Lanes a, Lanes b) {
+    return std::bit_cast<float>(a <= b ? ~0u : 0u);
+}
+
+static Lanes both(Lanes a, Lanes b) {
+    return std::bit_cast<float>(std::bit_cast<uint32_t>(a) & std::bit_cast<uint32_t>(b));
+}
+
+static uint32_t mask_bits(Lanes mask) {
+    return std::bit_cast<uint32_t>(mask) >> 31;
+}
+#endif
+
+static_assert(OcclusionCuller::TILE_SIZE % LANE_COUNT == 0, "A tile row must be a whole number of lanes.");
+
+/**
+* @brief The mesh boxes are moved this much, relative to their 1/w, towards the camera before the test, so that the
+* rounding doesn't let a mesh hide behind its own occluder proxy.
+*/
+static constexpr float DEPTH_BIAS = 1e-4f;
+
+/**
+* @brief The most vertices a triangle has after the clipping by the five planes.
+*/
+static constexpr size_t MAX_CLIPPED_VERTICES = 3 + 5;
+
+/**
+* @brief Two triangles of a cluster are coplanar if their normals are closer than about 2.5 degrees.
+*/
+static constexpr float COPLANAR_COSINE = 0.999f;
+
+/**
+* @brief Returns true if the `point`, in the plane of the triangle `a`, `b`, `c` with the unit `normal`, is inside the
+* triangle or less than the `tolerance` outside.
+*/
+static bool is_inside_triangle(const glm::vec3 &point, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c,
+                               const glm::vec3 &normal, float tolerance) {
+    const std::array<glm::vec3, 3> corners{a, b, c};
+    for (size_t i = 0; i < 3; ++i) {
+        const glm::vec3 edge = corners[(i + 1) % 3] - corners[i];
+        if (glm::dot(glm::cross(edge, point - corners[i]), normal) < -tolerance * glm::length(edge)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+OccluderMesh build_occluder_mesh(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                                 uint32_t grid) {
+    OccluderMesh result;
+    for (const auto &position: positions) {
+        result.aabb.expand(position);
+    }
+    if (result.aabb.is_empty() || indices.size() < 3) {
+        return result;
+    }
+    // Three cell coordinates of 7 bits each identify a cell.
+    grid = std::clamp(grid, 1u, 128u);
+    const glm::vec3 extent = glm::max(result.aabb.max - result.aabb.min, glm::vec3(1e-6f));
+    const float tolerance = 1e-4f * glm::length(extent);
+    const auto cells = static_cast<float>(grid);
+
+    // Weld the vertices split by the texture and normal seams, so that the edges are shared by position.
+    std::vector<uint32_t> order(positions.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    auto less = [&positions](uint32_t a, uint32_t b) {
+        const auto &p = positions[a], &q = positions[b];
+        return std::tie(p.x, p.y, p.z) < std::tie(q.x, q.y, q.z);
+    };
+    std::sort(order.begin(), order.end(), less);
+    std::vector<uint32_t> welded(positions.size());
+    std::vector<glm::vec3> welded_positions;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i == 0 || less(order[i - 1], order[i])) {
+            welded_positions.push_back(positions[order[i]]);
+        }
+        welded[order[i]] = static_cast<uint32_t>(welded_positions.size() - 1);
+    }
+    const auto welded_count = static_cast<uint32_t>(welded_positions.size());
+
+    // The triangles without area cover nothing, so they are dropped.
+    std::vector<std::array<uint32_t, 3> > triangles;
+    std::vector<glm::vec3> normals;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const std::array<uint32_t, 3> triangle{welded[indices[i]], welded[indices[i + 1]], welded[indices[i + 2]]};
+        const glm::vec3 normal = glm::cross(welded_positions[triangle[1]] - welded_positions[triangle[0]],
+                                            welded_positions[triangle[2]] - welded_positions[triangle[0]]);
+        const float length = glm::length(normal);
+        if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2] ||
+            !(length > tolerance * tolerance)) {
+            continue;
+        }
+        triangles.push_back(triangle);
+        normals.push_back(normal / length);
+    }
+
+    // A vertex on an open or a non-manifold edge is on the outline of a surface, e.g. around a window.
+    std::unordered_map<uint64_t, uint32_t> edge_counts;
+    for (const auto &triangle: triangles) {
+        for (size_t i = 0; i < 3; ++i) {
+            const uint32_t a = triangle[i], b = triangle[(i + 1) % 3];
+            ++edge_counts[static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b)];
+        }
+    }
+    std::vector<uint8_t> on_outline(welded_count, 0);
+    for (const auto &[edge, count]: edge_counts) {
+        if (count != 2) {
+            on_outline[edge >> 32] = on_outline[edge & 0xffffffffu] = 1;
+        }
+    }
+
+    // The triangles around every vertex, as ranges of one array.
+    std::vector<uint32_t> first_incident(welded_count + 1, 0);
+    for (const auto &triangle: triangles) {
+        for (uint32_t vertex: triangle) {
+            ++first_incident[vertex + 1];
+        }
+    }
+    for (uint32_t i = 0; i < welded_count; ++i) {
+        first_incident[i + 1] += first_incident[i];
+    }
+    std::vector<uint32_t> incident(first_incident.back());
+    std::vector<uint32_t> filled(first_incident.begin(), first_incident.end() - 1);
+    for (uint32_t t = 0; t < triangles.size(); ++t) {
+        for (uint32_t vertex: triangles[t]) {
+            incident[filled[vertex]++] = t;
+        }
+    }
+
+    // A vertex can move within its plane if it isn't on an outline and all the triangles around it lie in one plane.
+    // The triangles around a moved vertex stay in that plane, so they stay on the source surface; the vertices on
+    // the outlines, the corners and the thin parts stay where they are.
+    std::vector<uint8_t> movable(welded_count, 0);
+    for (uint32_t vertex = 0; vertex < welded_count; ++vertex) {
+        if (on_outline[vertex] || first_incident[vertex] == first_incident[vertex + 1]) {
+            continue;
+        }
+        const uint32_t reference = incident[first_incident[vertex]];
+        const glm::vec3 &normal = normals[reference];
+        bool coplanar = true;
+        for (uint32_t j = first_incident[vertex]; j < first_incident[vertex + 1] && coplanar; ++j) {
+            coplanar = glm::dot(normals[incident[j]], normal) >= COPLANAR_COSINE;
+            for (uint32_t corner: triangles[incident[j]]) {
+                coplanar = coplanar && std::abs(glm::dot(welded_positions[corner] - welded_positions[vertex], normal))
+                                       <= tolerance;
+            }
+        }
+        movable[vertex] = coplanar;
+    }
+
+    // The movable vertices of a cell that share a plane are merged into their average, if it lies on one of their
+    // triangles; the average of a cell with a hole or a notch in the middle can miss them.
+    std::vector<std::pair<uint32_t, uint32_t> > cell_vertices(welded_count);
+    for (uint32_t i = 0; i < welded_count; ++i) {
+        const glm::uvec3 cell = glm::min(glm::uvec3((welded_positions[i] - result.aabb.min) / extent * cells),
+                                         glm::uvec3(grid - 1));
+        cell_vertices[i] = {(cell.x * grid + cell.y) * grid + cell.z, i};
+    }
+    std::sort(cell_vertices.begin(), cell_vertices.end());
+    std::vector<uint32_t> group(welded_count);
+    std::vector<glm::vec3> group_positions;
+    std::vector<uint32_t> members;
+    std::vector<uint8_t> grouped;
+    for (size_t first = 0; first < cell_vertices.size();) {
+        size_t last = first + 1;
+        while (last < cell_vertices.size() && cell_vertices[last].first == cell_vertices[first].first) {
+            ++last;
+        }
+        grouped.assign(last - first, 0);
+        for (size_t i = first; i < last; ++i) {
+            const uint32_t vertex = cell_vertices[i].second;
+            if (grouped[i - first]) {
+                continue;
+            }
+            members.assign(1, vertex);
+            if (movable[vertex]) {
+                const glm::vec3 &normal = normals[incident[first_incident[vertex]]];
+                for (size_t k = i + 1; k < last; ++k) {
+                    const uint32_t other = cell_vertices[k].second;
+                    if (!grouped[k - first] && movable[other] &&
+                        glm::dot(normals[incident[first_incident[other]]], normal) >= COPLANAR_COSINE &&
+                        std::abs(glm::dot(welded_positions[other] - welded_positions[vertex], normal)) <= tolerance) {
+                        grouped[k - first] = 1;
+                        members.push_back(other);
+                    }
+                }
+            }
+            glm::dvec3 sum(0.0);
+            for (uint32_t member: members) {
+                sum += glm::dvec3(welded_positions[member]);
+            }
+            const glm::vec3 average(sum / static_cast<double>(members.size()));
+            bool on_triangle = members.size() > 1 && [&] {
+                for (uint32_t member: members) {
+                    for (uint32_t j = first_incident[member]; j < first_incident[member + 1]; ++j) {
+                        const auto &triangle = triangles[incident[j]];
+                        if (is_inside_triangle(average, welded_positions[triangle[0]], welded_positions[triangle[1]],
+                                               welded_positions[triangle[2]], normals[incident[j]], tolerance)) {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }();
+            if (on_triangle) {
+                for (uint32_t member: members) {
+                    group[member] = static_cast<uint32_t>(group_positions.size());
+                }
+                group_positions.push_back(average);
+            } else {
+                for (uint32_t member: members) {
+                    group[member] = static_cast<uint32_t>(group_positions.size());
+                    group_positions.push_back(welded_positions[member]);
+                }
+            }
+        }
+        first = last;
+    }
+
+    std::vector<std::array<uint32_t, 3> > collapsed;
+    collapsed.reserve(triangles.size());
+    for (const auto &triangle: triangles) {
+        std::array<uint32_t, 3> merged{group[triangle[0]], group[triangle[1]], group[triangle[2]]};
+        if (merged[0] == merged[1] || merged[1] == merged[2] || merged[0] == merged[2]) {
+            continue;
+        }
+        // Rotate the smallest index first, so the same triangle looks the same, keeping the winding.
+        std::rotate(merged.begin(), std::min_element(merged.begin(), merged.end()), merged.end());
+        collapsed.push_back(merged);
+    }
+    std::sort(collapsed.begin(), collapsed.end());
+    collapsed.erase(std::unique(collapsed.begin(), collapsed.end()), collapsed.end());
+
+    // Keep only the vertices of the remaining triangles.
+    std::vector<uint32_t> output(group_positions.size(), std::numeric_limits<uint32_t>::max());
+    result.indices.reserve(collapsed.size() * 3);
+    for (const auto &triangle: collapsed) {
+        for (uint32_t vertex: triangle) {
+            if (output[vertex] == std::numeric_limits<uint32_t>::max()) {
+                output[vertex] = static_cast<uint32_t>(result.vertices.size());
+                result.vertices.push_back(group_positions[vertex]);
+            }
+            result.indices.push_back(output[vertex]);
+        }
+    }
+    return result;
+}
+
+const char *OcclusionCuller::kernel_name() {
+    return KERNEL_NAME;
+}
+
+void OcclusionCuller::initialize(uint32_t width, uint32_t height) {
+    RG_GUARANTEE(width > 0 && height > 0, "OcclusionCuller: the depth buffer can't be {}x{}.", width, height);
+    m_tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+    m_width = m_tiles_x * TILE_SIZE;
+    m_height = m_tiles_y * TILE_SIZE;
+    m_depth.assign(static_cast<size_t>(m_width) * m_height, 0.0f);
+    m_tile_depth.assign(static_cast<size_t>(m_tiles_x) * m_tiles_y, 0.0f);
+}
+
+void OcclusionCuller::begin(const glm::mat4 &view_projection) {
+    m_view_projection = view_projection;
+    m_occluders.clear();
+    m_triangles.clear();
+}
+
+void OcclusionCuller::add_occluder(const OccluderMesh &occluder, const glm::mat4 &model) {
+    if (occluder.triangle_count() > 0) {
+        m_occluders.push_back(Occluder{&occluder, model});
+    }
+}
+
+/**
+* @brief Returns the signed distance of the clip space `vertex` from the `plane`: the near plane, and the left,
+* right, bottom and top planes. The vertex is inside where it's not negative.
+*/
+static float clip_distance(const glm::vec4 &vertex, uint32_t plane) {
+    switch (plane) {
+        case 0: return vertex.z + vertex.w;
+        case 1: return vertex.w + vertex.x;
+        case 2: return vertex.w - vertex.x;
+        case 3: return vertex.w + vertex.y;
+        case 4: return vertex.w - vertex.y;
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled clip plane {}", plane);
+    }
+}
+
+/**
+* @brief Clips the triangle `a`, `b`, `c` by the planes of @ref clip_distance with Sutherland-Hodgman, and appends the
+* triangle fan of what's left to the `triangles`, in pixels of a `width` by `height` buffer.
+*/
+static void clip_triangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c, float width, float height,
+                          std::vector<OcclusionCuller::ScreenTriangle> &triangles) {
+    std::array<glm::vec4, MAX_CLIPPED_VERTICES> polygon{a, b, c};
+    std::array<glm::vec4, MAX_CLIPPED_VERTICES> clipped{};
+    size_t count = 3;
+    for (uint32_t plane = 0; plane < 5 && count >= 3; ++plane) {
+        size_t clipped_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec4 &current = polygon[i];
+            const glm::vec4 &next = polygon[(i + 1) % count];
+            const float current_distance = clip_distance(current, plane);
+            const float next_distance = clip_distance(next, plane);
+            if (current_distance >= 0.0f) {
+                clipped[clipped_count++] = current;
+            }
+            if ((current_distance >= 0.0f) != (next_distance >= 0.0f)) {
+                const float t = current_distance / (current_distance - next_distance);
+                clipped[clipped_count++] = glm::mix(current, next, t);
+            }
+        }
+        polygon = clipped;
+        count = clipped_count;
+    }
+    if (count < 3) {
+        return;
+    }
+    std::array<glm::vec3, MAX_CLIPPED_VERTICES> screen{};
+    for (size_t i = 0; i < count; ++i) {
+        if (polygon[i].w <= 0.0f) {
+            return;
+        }
+        const float inverse_w = 1.0f / polygon[i].w;
+        screen[i] = glm::vec3((polygon[i].x * inverse_w * 0.5f + 0.5f) * width,
+                              (polygon[i].y * inverse_w * 0.5f + 0.5f) * height, inverse_w);
+    }
+    for (size_t i = 1; i + 1 < count; ++i) {
+        triangles.push_back(OcclusionCuller::ScreenTriangle{{screen[0], screen[i], screen[i + 1]}});
+    }
+}
+
+void OcclusionCuller::rasterize(core::JobSystem &jobs) {
+    m_occluder_triangles.resize(m_occluders.size());
+    const auto width = static_cast<float>(m_width);
+    const auto height = static_cast<float>(m_height);
+    jobs.parallel_for(0, m_occluders.size(), 1, [this, width, height](size_t first, size_t last) {
+        std::vector<glm::vec4> clip_space;
+        for (size_t i = first; i < last; ++i) {
+            const OccluderMesh &mesh = *m_occluders[i].mesh;
+            const glm::mat4 model_view_projection = m_view_projection * m_occluders[i].model;
+            clip_space.clear();
+            for (const auto &vertex: mesh.vertices) {
+                clip_space.push_back(model_view_projection * glm::vec4(vertex, 1.0f));
+            }
+            auto &triangles = m_occluder_triangles[i];
+            triangles.clear();
+            for (size_t j = 0; j + 2 < mesh.indices.size(); j += 3) {
+                clip_triangle(clip_space[mesh.indices[j]], clip_space[mesh.indices[j + 1]],
+                              clip_space[mesh.indices[j + 2]], width, height, triangles);
+            }
+        }
+    });
+    // Concatenated in the order of the occluders, whatever worker clipped them.
+    m_triangles.clear();
+    for (const auto &triangles: m_occluder_triangles) {
+        m_triangles.insert(m_triangles.end(), triangles.begin(), triangles.end());
+    }
+    constexpr uint32_t tile_rows_per_job = 4;
+    jobs.parallel_for(0, m_tiles_y, tile_rows_per_job, [this](size_t first, size_t last) {
+        rasterize_rows(static_cast<uint32_t>(first) * TILE_SIZE, static_cast<uint32_t>(last) * TILE_SIZE);
+    });
+}
+
+void OcclusionCuller::rasterize_rows(uint32_t first_row, uint32_t last_row) {
+    float *depth = m_depth.data();
+    std::fill(depth + static_cast<size_t>(first_row) * m_width, depth + static_cast<size_t>(last_row) * m_width, 0.0f);
+    const Lanes offsets = lane_offsets();
+    const Lanes zero = splat(0.0f);
+    for (const auto &triangle: m_triangles) {
+        glm::vec3 v0 = triangle.vertices[0];
+        glm::vec3 v1 = triangle.vertices[1];
+        glm::vec3 v2 = triangle.vertices[2];
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+        if (area < 0.0f) {
+            std::swap(v1, v2);
+            area = -area;
+        }
+        if (area < 1e-6f) {
+            continue;
+        }
+        // The pixels whose centers are in the box of the triangle.
+        const auto min_x = static_cast<int64_t>(std::ceil(std::min({v0.x, v1.x, v2.x}) - 0.5f));
+        const auto max_x = static_cast<int64_t>(std::floor(std::max({v0.x, v1.x, v2.x}) - 0.5f));
+        const auto min_y = static_cast<int64_t>(std::ceil(std::min({v0.y, v1.y, v2.y}) - 0.5f));
+        const auto max_y = static_cast<int64_t>(std::floor(std::max({v0.y, v1.y, v2.y}) - 0.5f));
+        const auto x_begin = static_cast<uint32_t>(std::max<int64_t>(min_x, 0));
+        const auto x_end = static_cast<uint32_t>(std::min<int64_t>(max_x + 1, m_width));
+        const auto y_begin = static_cast<uint32_t>(std::max<int64_t>(min_y, first_row));
+        const auto y_end = static_cast<uint32_t>(std::min<int64_t>(max_y + 1, last_row));
+        if (x_begin >= x_end || y_begin >= y_end) {
+            continue;
+        }
+
+        // The edge functions are positive inside. A shared edge gets the exactly negated coefficients in the other
+        // triangle, so a pixel center on it is covered by both and no cracks open between the triangles.
+        const glm::vec3 *edges[3][2] = {{&v0, &v1}, {&v1, &v2}, {&v2, &v0}};
+        float edge_x[3];
+        float edge_y[3];
+        float edge_constant[3];
+        for (int i = 0; i < 3; ++i) {
+            const glm::vec3 &a = *edges[i][0];
+            const glm::vec3 &b = *edges[i][1];
+            edge_x[i] = a.y - b.y;
+            edge_y[i] = b.x - a.x;
+            edge_constant[i] = a.x * b.y - a.y * b.x;
+        }
+        // 1/w is a plane in the screen space; moving it away by half a pixel gives the farthest value of the pixel.
+        const float depth_x = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+        const float depth_y = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+        const float depth_constant = v0.z - depth_x * v0.x - depth_y * v0.y -
+                                     0.5f * (std::abs(depth_x) + std::abs(depth_y));
+
+        // Every lane is evaluated from its own pixel center rather than stepped, so the result doesn't depend on
+        // the number of lanes.
+        const Lanes edge_x_lanes[3] = {splat(edge_x[0]), splat(edge_x[1]), splat(edge_x[2])};
+        const Lanes depth_x_lanes = splat(depth_x);
+        const uint32_t x_first = x_begin - x_begin % LANE_COUNT;
+        for (uint32_t y = y_begin; y < y_end; ++y) {
+            const float center_y = static_cast<float>(y) + 0.5f;
+            const Lanes edge_row[3] = {splat(edge_y[0] * center_y + edge_constant[0]),
+                                       splat(edge_y[1] * center_y + edge_constant[1]),
+                                       splat(edge_y[2] * center_y + edge_constant[2])};
+            const Lanes depth_row = splat(depth_y * center_y + depth_constant);
+            float *row = depth + static_cast<size_t>(y) * m_width;
+            for (uint32_t x = x_first; x < x_end; x += LANE_COUNT) {
+                const Lanes center_x = add(splat(static_cast<float>(x) + 0.5f), offsets);
+                Lanes inside = greater_equal(add(multiply(edge_x_lanes[0], center_x), edge_row[0]), zero);
+                inside = both(inside, greater_equal(add(multiply(edge_x_lanes[1], center_x), edge_row[1]), zero));
+                inside = both(inside, greater_equal(add(multiply(edge_x_lanes[2], center_x), edge_row[2]), zero));
+                const Lanes pixel_depth = add(multiply(depth_x_lanes, center_x), depth_row);
+                // The uncovered lanes offer 0, which never wins against the buffer.
+                store(row + x, maximum(load(row + x), both(inside, pixel_depth)));
+            }
+        }
+    }
+
+    for (uint32_t tile_y = first_row / TILE_SIZE; tile_y < last_row / TILE_SIZE; ++tile_y) {
+        for (uint32_t tile_x = 0; tile_x < m_tiles_x; ++tile_x) {
+            Lanes farthest = load(depth + static_cast<size_t>(tile_y * TILE_SIZE) * m_width + tile_x * TILE_SIZE);
+            for (uint32_t y = tile_y * TILE_SIZE; y < (tile_y + 1) * TILE_SIZE; ++y) {
+                for (uint32_t x = tile_x * TILE_SIZE; x < (tile_x + 1) * TILE_SIZE; x += LANE_COUNT) {
+                    farthest = minimum(farthest, load(depth + static_cast<size_t>(y) * m_width + x));
+                }
+            }
+            std::array<float, LANE_COUNT> lanes{};
+            store(lanes.data(), farthest);
+            m_tile_depth[tile_y * m_tiles_x + tile_x] = *std::min_element(lanes.begin(), lanes.end());
+        }
+    }
+}
+
+bool OcclusionCuller::is_occluded(const AABB &aabb) const {
+    if (m_triangles.empty() || aabb.is_empty()) {
+        return false;
+    }
+    const auto width = static_cast<float>(m_width);
+    const auto height = static_cast<float>(m_height);
+    glm::vec2 screen_min(std::numeric_limits<float>::max());
+    glm::vec2 screen_max(std::numeric_limits<float>::lowest());
+    float nearest = 0.0f;
+    for (uint32_t corner = 0; corner < 8; ++corner) {
+        const glm::vec3 position((corner & 1) ? aabb.max.x : aabb.min.x, (corner & 2) ? aabb.max.y : aabb.min.y,
+                                 (corner & 4) ? aabb.max.z : aabb.min.z);
+        const glm::vec4 clip = m_view_projection * glm::vec4(position, 1.0f);
+        if (clip.z < -clip.w || clip.w <= 0.0f) {
+            return false;
+        }
+        const float inverse_w = 1.0f / clip.w;
+        const glm::vec2 screen((clip.x * inverse_w * 0.5f + 0.5f) * width, (clip.y * inverse_w * 0.5f + 0.5f) * height);
+        screen_min = glm::min(screen_min, screen);
+        screen_max = glm::max(screen_max, screen);
+        nearest = std::max(nearest, inverse_w);
+    }
+    // Every pixel the rectangle touches, even partially.
+    const auto x_begin = static_cast<uint32_t>(std::clamp(std::floor(screen_min.x), 0.0f, width));
+    const auto x_end = static_cast<uint32_t>(std::clamp(std::ceil(screen_max.x), 0.0f, width));
+    const auto y_begin = static_cast<uint32_t>(std::clamp(std::floor(screen_min.y), 0.0f, height));
+    const auto y_end = static_cast<uint32_t>(std::clamp(std::ceil(screen_max.y), 0.0f, height));
+    if (x_begin >= x_end || y_begin >= y_end) {
+        // Off the screen, the frustum culling decides.
+        return false;
+    }
+    nearest *= 1.0f + DEPTH_BIAS;
+    const Lanes nearest_lanes = splat(nearest);
+    constexpr uint32_t all_lanes = (1u << LANE_COUNT) - 1;
+    for (uint32_t tile_y = y_begin / TILE_SIZE; tile_y <= (y_end - 1) / TILE_SIZE; ++tile_y) {
+        for (uint32_t tile_x = x_begin / TILE_SIZE; tile_x <= (x_end - 1) / TILE_SIZE; ++tile_x) {
+            if (nearest < m_tile_depth[tile_y * m_tiles_x + tile_x]) {
+                continue;
+            }
+            const uint32_t row_begin = std::max(y_begin, tile_y * TILE_SIZE);
+            const uint32_t row_end = std::min(y_end, (tile_y + 1) * TILE_SIZE);
+            for (uint32_t x = tile_x * TILE_SIZE; x < (tile_x + 1) * TILE_SIZE; x += LANE_COUNT) {
+                // The lanes inside [x_begin, x_end).
+                const uint32_t skipped = std::min(x_begin - std::min(x_begin, x), LANE_COUNT);
+                const uint32_t kept = std::min(x_end - std::min(x_end, x), LANE_COUNT);
+                const uint32_t rectangle = all_lanes >> (LANE_COUNT - kept) & (all_lanes << skipped);
+                if (kept == 0 || rectangle == 0) {
+                    continue;
+                }
+                for (uint32_t y = row_begin; y < row_end; ++y) {
+                    const Lanes pixels = load(m_depth.data() + static_cast<size_t>(y) * m_width + x);
+                    if (mask_bits(less_equal(pixels, nearest_lanes)) & rectangle) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+} // namespace engine::graphics
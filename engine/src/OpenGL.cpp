@@ -1,55 +1,151 @@
 #include <glad/glad.h>
+#include <GLFW/glfw3.h>
 #include <filesystem>
 #include <array>
-#include <stb_image.h>
+#include <string>
+#include <unordered_set>
 #include <engine/graphics/OpenGL.hpp>
 #include <engine/resources/Shader.hpp>
 #include <engine/resources/ShaderCompiler.hpp>
 #include <engine/resources/Skybox.hpp>
+#include <engine/resources/TextureCompressor.hpp>
 #include <engine/util/Errors.hpp>
 #include <engine/util/Utils.hpp>
+#include <spdlog/spdlog.h>
 
 namespace engine::graphics {
+// OpenGL 4.3, not in the 3.3 core glad.
+static constexpr GLenum COMPUTE_SHADER = 0x91B9;
+
 int32_t OpenGL::shader_type_to_opengl_type(resources::ShaderType type) {
     switch (type) {
         case resources::ShaderType::Vertex: return GL_VERTEX_SHADER;
         case resources::ShaderType::Fragment: return GL_FRAGMENT_SHADER;
         case resources::ShaderType::Geometry: return GL_GEOMETRY_SHADER;
+        case resources::ShaderType::Compute: return COMPUTE_SHADER;
         default: RG_SHOULD_NOT_REACH_HERE("Unhandled ShaderType");
     }
 }
 
 uint32_t OpenGL::generate_texture(const std::filesystem::path &path, bool flip_uvs) {
+    return generate_texture(resources::load_image(path, flip_uvs));
+}
+
+uint32_t OpenGL::generate_texture(const resources::ImageData &image) {
     uint32_t texture_id = 0;
     CHECKED_GL_CALL(glGenTextures, 1, &texture_id);
 
-    int32_t width, height, nr_components;
-    stbi_set_flip_vertically_on_load(flip_uvs);
-    uint8_t *data = stbi_load(path.c_str(), &width, &height, &nr_components, 0);
-    defer {
-        stbi_image_free(data);
-    };
-    if (data) {
-        int32_t format = texture_format(nr_components);
+    int32_t format = texture_format(image.channels);
+    bind_texture(0, GL_TEXTURE_2D, texture_id);
+    CHECKED_GL_CALL(glTexImage2D, GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE,
+                    image.pixels.get());
+    CHECKED_GL_CALL(glGenerateMipmap, GL_TEXTURE_2D);
 
-        CHECKED_GL_CALL(glBindTexture, GL_TEXTURE_2D, texture_id);
-        CHECKED_GL_CALL(glTexImage2D, GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        CHECKED_GL_CALL(glGenerateMipmap, GL_TEXTURE_2D);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return texture_id;
+}
+
+// GL_EXT_texture_compression_s3tc isn't part of the core profile that glad is generated for.
+constexpr int32_t GL_COMPRESSED_RGB_S3TC_DXT1_EXT = 0x83F0;
+constexpr int32_t GL_COMPRESSED_RGBA_S3TC_DXT5_EXT = 0x83F3;
+
+static int32_t compressed_texture_format(resources::TextureFormat format) {
+    switch (format) {
+        case resources::TextureFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case resources::TextureFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case resources::TextureFormat::BC4: return GL_COMPRESSED_RED_RGTC1;
+        case resources::TextureFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled TextureFormat {}", to_string(format));
+    }
+}
 
-        CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+uint32_t OpenGL::generate_texture(const resources::TextureData &texture) {
+    RG_GUARANTEE(!texture.levels.empty(), "Texture {} has no levels", texture.path.string());
+    if (texture.format != resources::TextureFormat::Raw && !is_texture_format_supported(texture.format)) {
+        util::once([format = texture.format] {
+            spdlog::warn("OpenGL: {} textures aren't supported by the driver, uploading them uncompressed.",
+                         to_string(format));
+        });
+        return generate_texture(resources::TextureCompressor::decompress(texture));
+    }
+
+    uint32_t texture_id = 0;
+    CHECKED_GL_CALL(glGenTextures, 1, &texture_id);
+    bind_texture(0, GL_TEXTURE_2D, texture_id);
+    // Levels are tightly packed, so rows of the small mips and of RGB images aren't 4 byte aligned.
+    CHECKED_GL_CALL(glPixelStorei, GL_UNPACK_ALIGNMENT, 1);
+    for (size_t i = 0; i < texture.levels.size(); ++i) {
+        const auto &level = texture.levels[i];
+        if (texture.format == resources::TextureFormat::Raw) {
+            int32_t format = texture_format(texture.channels);
+            CHECKED_GL_CALL(glTexImage2D, GL_TEXTURE_2D, i, format, level.width, level.height, 0, format,
+                            GL_UNSIGNED_BYTE, level.data.data());
+        } else {
+            CHECKED_GL_CALL(glCompressedTexImage2D, GL_TEXTURE_2D, i, compressed_texture_format(texture.format),
+                            level.width, level.height, 0, level.data.size(), level.data.data());
+        }
+    }
+    CHECKED_GL_CALL(glPixelStorei, GL_UNPACK_ALIGNMENT, 4);
+    if (texture.levels.size() == 1) {
+        CHECKED_GL_CALL(glGenerateMipmap, GL_TEXTURE_2D);
     } else {
-        throw util::EngineError(util::EngineError::Type::AssetLoadingError,
-                                std::format("Failed to load texture {}", path.string()));
+        CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.levels.size() - 1);
     }
+
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     return texture_id;
 }
 
+bool OpenGL::is_texture_format_supported(resources::TextureFormat format) {
+    switch (format) {
+        case resources::TextureFormat::Raw:
+        case resources::TextureFormat::BC4:
+        case resources::TextureFormat::BC5: return true; // RGTC is core since OpenGL 3.0
+        case resources::TextureFormat::BC1:
+        case resources::TextureFormat::BC3: return has_extension("GL_EXT_texture_compression_s3tc");
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled TextureFormat {}", to_string(format));
+    }
+}
+
+bool OpenGL::has_extension(std::string_view name) {
+    static std::unordered_set<std::string> extensions = [] {
+        std::unordered_set<std::string> result;
+        int32_t number_of_extensions = 0;
+        CHECKED_GL_CALL(glGetIntegerv, GL_NUM_EXTENSIONS, &number_of_extensions);
+        for (int32_t i = 0; i < number_of_extensions; ++i) {
+            result.emplace(reinterpret_cast<const char *>(CHECKED_GL_CALL(glGetStringi, GL_EXTENSIONS, i)));
+        }
+        return result;
+    }();
+    return extensions.contains(std::string(name));
+}
+
+bool OpenGL::is_version_at_least(int major, int minor) {
+    return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+void *OpenGL::load_function_address(const char *name) {
+    return reinterpret_cast<void *>(glfwGetProcAddress(name));
+}
+
+std::string OpenGL::renderer_description() {
+    auto get_string = [](GLenum name) {
+        auto value = reinterpret_cast<const char *>(CHECKED_GL_CALL(glGetString, name));
+        return std::string(value ? value : "unknown");
+    };
+    return std::format("{} {} (OpenGL {})", get_string(GL_VENDOR), get_string(GL_RENDERER), get_string(GL_VERSION));
+}
+
 int32_t OpenGL::texture_format(int32_t number_of_channels) {
     switch (number_of_channels) {
         case 1: return GL_RED;
+        case 2: return GL_RG;
         case 3: return GL_RGB;
         case 4: return GL_RGBA;
         default: RG_SHOULD_NOT_REACH_HERE("Unknown channels {}", number_of_channels);
@@ -69,8 +165,8 @@ uint32_t OpenGL::init_skybox_cube() {
     uint32_t skybox_vbo = 0;
     CHECKED_GL_CALL(glGenVertexArrays, 1, &skybox_vao);
     CHECKED_GL_CALL(glGenBuffers, 1, &skybox_vbo);
-    CHECKED_GL_CALL(glBindVertexArray, skybox_vao);
-    CHECKED_GL_CALL(glBindBuffer, GL_ARRAY_BUFFER, skybox_vbo);
+    bind_vertex_array(skybox_vao);
+    bind_buffer(GL_ARRAY_BUFFER, skybox_vbo);
     CHECKED_GL_CALL(glBufferData, GL_ARRAY_BUFFER, sizeof(vertices), &vertices, GL_STATIC_DRAW);
     CHECKED_GL_CALL(glEnableVertexAttribArray, 0);
     CHECKED_GL_CALL(glVertexAttribPointer, 0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *) 0); // NOLINT
@@ -137,28 +233,25 @@ uint32_t OpenGL::load_skybox_textures(const std::filesystem::path &path, bool fl
     RG_GUARANTEE(std::filesystem::is_directory(path),
                  "Directory '{}' doesn't exist. Please specify path to be a directory to where the cubemap textures are located. The cubemap textures should be named: right, left, top, bottom, front, back; by their respective faces in the cubemap.",
                  path.string());
+    std::vector<resources::ImageData> faces;
+    for (const auto &file: std::filesystem::directory_iterator(path)) {
+        faces.emplace_back(resources::load_image(absolute(file), flip_uvs));
+    }
+    return load_skybox_textures(faces);
+}
+
+uint32_t OpenGL::load_skybox_textures(const std::vector<resources::ImageData> &faces) {
     uint32_t texture_id;
     CHECKED_GL_CALL(glGenTextures, 1, &texture_id);
-    CHECKED_GL_CALL(glBindTexture, GL_TEXTURE_CUBE_MAP, texture_id);
+    bind_texture(0, GL_TEXTURE_CUBE_MAP, texture_id);
 
-    int width, height, nr_channels;
-    for (const auto &file: std::filesystem::directory_iterator(path)) {
-        stbi_set_flip_vertically_on_load(flip_uvs);
-        unsigned char *data = stbi_load(absolute(file).c_str(), &width, &height, &nr_channels, 0);
-        defer {
-            stbi_image_free(data);
-        };
-        if (data) {
-            uint32_t i = face_index(file.path()
-                                        .stem()
-                                        .c_str());
-            CHECKED_GL_CALL(glTexImage2D, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB,
-                            GL_UNSIGNED_BYTE,
-                            data);
-        } else {
-            throw util::EngineError(util::EngineError::Type::AssetLoadingError,
-                                    std::format("Failed to load skybox texture {}", path.string()));
-        }
+    for (const auto &face: faces) {
+        uint32_t i = face_index(face.path
+                                    .stem()
+                                    .c_str());
+        CHECKED_GL_CALL(glTexImage2D, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, face.width, face.height, 0, GL_RGB,
+                        GL_UNSIGNED_BYTE,
+                        face.pixels.get());
     }
     CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     CHECKED_GL_CALL(glTexParameteri, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -170,11 +263,180 @@ uint32_t OpenGL::load_skybox_textures(const std::filesystem::path &path, bool fl
 }
 
 void OpenGL::enable_depth_testing() {
-    CHECKED_GL_CALL(glEnable, GL_DEPTH_TEST);
+    set_depth_test(true);
 }
 
 void OpenGL::disable_depth_testing() {
-    CHECKED_GL_CALL(glDisable, GL_DEPTH_TEST);
+    set_depth_test(false);
+}
+
+constexpr uint32_t g_unknown_state = UINT32_MAX;
+constexpr uint32_t g_max_texture_units = 32;
+
+/**
+ * @brief The OpenGL state as last set through the state functions of the @ref OpenGL class.
+ * @ref g_unknown_state means that the value is unknown and the next call has to reach the driver.
+ */
+struct StateCache {
+    uint32_t program = g_unknown_state;
+    uint32_t vertex_array = g_unknown_state;
+    uint32_t active_texture_unit = g_unknown_state;
+    std::array<uint32_t, g_max_texture_units> textures_2d = filled(g_unknown_state);
+    std::array<uint32_t, g_max_texture_units> texture_cube_maps = filled(g_unknown_state);
+    uint32_t array_buffer = g_unknown_state;
+    uint32_t uniform_buffer = g_unknown_state;
+    uint32_t depth_test = g_unknown_state;
+    uint32_t depth_func = g_unknown_state;
+    uint32_t depth_mask = g_unknown_state;
+    uint32_t blend = g_unknown_state;
+    uint32_t blend_source = g_unknown_state;
+    uint32_t blend_destination = g_unknown_state;
+
+    static constexpr std::array<uint32_t, g_max_texture_units> filled(uint32_t value) {
+        std::array<uint32_t, g_max_texture_units> result{};
+        result.fill(value);
+        return result;
+    }
+};
+
+static StateCache g_state_cache;
+static OpenGL::StateCacheStats g_state_cache_stats;
+static OpenGL::StateCacheStats g_previous_frame_state_cache_stats;
+
+/**
+ * @brief Calls `apply` and remembers the `value` unless the `cached` state already has the `value`.
+ */
+template<typename TApply>
+static void set_cached(uint32_t &cached, uint32_t value, TApply apply) {
+    if (cached == value) {
+        ++g_state_cache_stats.skipped;
+        return;
+    }
+    apply();
+    cached = value;
+    ++g_state_cache_stats.issued;
+}
+
+static void set_capability(uint32_t &cached, uint32_t capability, bool enabled) {
+    set_cached(cached, enabled, [&] {
+        if (enabled) {
+            CHECKED_GL_CALL(glEnable, capability);
+        } else {
+            CHECKED_GL_CALL(glDisable, capability);
+        }
+    });
+}
+
+void OpenGL::use_program(uint32_t program) {
+    set_cached(g_state_cache.program, program, [&] {
+        CHECKED_GL_CALL(glUseProgram, program);
+    });
+}
+
+void OpenGL::bind_vertex_array(uint32_t vertex_array) {
+    set_cached(g_state_cache.vertex_array, vertex_array, [&] {
+        CHECKED_GL_CALL(glBindVertexArray, vertex_array);
+    });
+}
+
+void OpenGL::bind_texture(uint32_t unit, uint32_t target, uint32_t texture) {
+    RG_GUARANTEE(unit < g_max_texture_units, "Texture unit {} out of range", unit);
+    uint32_t *cached = nullptr;
+    switch (target) {
+        case GL_TEXTURE_2D: cached = &g_state_cache.textures_2d[unit];
+            break;
+        case GL_TEXTURE_CUBE_MAP: cached = &g_state_cache.texture_cube_maps[unit];
+            break;
+        default: RG_SHOULD_NOT_REACH_HERE("Unsupported texture target {}", target);
+    }
+    if (*cached == texture) {
+        ++g_state_cache_stats.skipped;
+        return;
+    }
+    set_cached(g_state_cache.active_texture_unit, unit, [&] {
+        CHECKED_GL_CALL(glActiveTexture, GL_TEXTURE0 + unit);
+    });
+    set_cached(*cached, texture, [&] {
+        CHECKED_GL_CALL(glBindTexture, target, texture);
+    });
+}
+
+void OpenGL::bind_buffer(uint32_t target, uint32_t buffer) {
+    uint32_t *cached = nullptr;
+    switch (target) {
+        case GL_ARRAY_BUFFER: cached = &g_state_cache.array_buffer;
+            break;
+        case GL_UNIFORM_BUFFER: cached = &g_state_cache.uniform_buffer;
+            break;
+        default: CHECKED_GL_CALL(glBindBuffer, target, buffer);
+            ++g_state_cache_stats.issued;
+            return;
+    }
+    set_cached(*cached, buffer, [&] {
+        CHECKED_GL_CALL(glBindBuffer, target, buffer);
+    });
+}
+
+void OpenGL::bind_buffer_base(uint32_t target, uint32_t index, uint32_t buffer) {
+    CHECKED_GL_CALL(glBindBufferBase, target, index, buffer);
+    ++g_state_cache_stats.issued;
+    // Binding to an indexed binding point binds to the generic binding point as well.
+    if (target == GL_UNIFORM_BUFFER) {
+        g_state_cache.uniform_buffer = buffer;
+    }
+}
+
+void OpenGL::bind_buffer_range(uint32_t target, uint32_t index, uint32_t buffer, size_t offset, size_t size) {
+    CHECKED_GL_CALL(glBindBufferRange, target, index, buffer, static_cast<GLintptr>(offset),
+                    static_cast<GLsizeiptr>(size));
+    ++g_state_cache_stats.issued;
+    if (target == GL_UNIFORM_BUFFER) {
+        g_state_cache.uniform_buffer = buffer;
+    }
+}
+
+void OpenGL::set_depth_test(bool enabled) {
+    set_capability(g_state_cache.depth_test, GL_DEPTH_TEST, enabled);
+}
+
+void OpenGL::set_depth_func(uint32_t func) {
+    set_cached(g_state_cache.depth_func, func, [&] {
+        CHECKED_GL_CALL(glDepthFunc, func);
+    });
+}
+
+void OpenGL::set_depth_mask(bool enabled) {
+    set_cached(g_state_cache.depth_mask, enabled, [&] {
+        CHECKED_GL_CALL(glDepthMask, enabled ? GL_TRUE : GL_FALSE);
+    });
+}
+
+void OpenGL::set_blend(bool enabled) {
+    set_capability(g_state_cache.blend, GL_BLEND, enabled);
+}
+
+void OpenGL::set_blend_func(uint32_t source, uint32_t destination) {
+    if (g_state_cache.blend_source == source && g_state_cache.blend_destination == destination) {
+        ++g_state_cache_stats.skipped;
+        return;
+    }
+    CHECKED_GL_CALL(glBlendFunc, source, destination);
+    g_state_cache.blend_source = source;
+    g_state_cache.blend_destination = destination;
+    ++g_state_cache_stats.issued;
+}
+
+void OpenGL::invalidate_state_cache() {
+    g_state_cache = StateCache{};
+}
+
+void OpenGL::begin_state_cache_frame() {
+    g_previous_frame_state_cache_stats = g_state_cache_stats;
+    g_state_cache_stats = StateCacheStats{};
+}
+
+const OpenGL::StateCacheStats &OpenGL::state_cache_stats() {
+    return g_previous_frame_state_cache_stats;
 }
 
 void OpenGL::clear_buffers() {
@@ -7,8 +7,15 @@
 #include <engine/util/Utils.hpp>
 
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
 #include <utility>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <engine/util/ArgParser.hpp>
 #include <engine/util/Configuration.hpp>
+#include <engine/util/Profiler.hpp>
 
 namespace engine::platform {
 static std::array<std::string_view, KEY_COUNT> g_engine_key_to_string;
@@ -32,8 +39,48 @@ static int glfw_platform_action(GLFWwindow *window, int glfw_key_code);
 
 void initialize_key_maps();
 
+static VSync read_vsync(const std::string &value) {
+    if (value == "off") {
+        return VSync::Off;
+    }
+    if (value == "on") {
+        return VSync::On;
+    }
+    if (value == "adaptive") {
+        return VSync::Adaptive;
+    }
+    throw util::EngineError(util::EngineError::Type::ConfigurationError,
+                            std::format("window.vsync must be \"on\", \"off\" or \"adaptive\", got \"{}\".", value));
+}
+
+static FramePacing read_frame_pacing(const util::Configuration::json &config) {
+    FramePacing frame_pacing;
+    frame_pacing.vsync = read_vsync(config.value(nlohmann::json::json_pointer("/window/vsync"), std::string("on")));
+    frame_pacing.max_fps = config.value(nlohmann::json::json_pointer("/window/max_fps"), 0.0f);
+    frame_pacing.background_fps = config.value(nlohmann::json::json_pointer("/window/background_fps"), 0.0f);
+    RG_GUARANTEE(frame_pacing.max_fps >= 0.0f && frame_pacing.background_fps >= 0.0f,
+                 "window.max_fps and window.background_fps can't be negative.");
+    return frame_pacing;
+}
+
+/**
+ * @brief Returns false on Linux if neither an X11 nor a Wayland display is available, e.g. on a build machine.
+ */
+static bool has_display() {
+    if (glfwPlatformSupported(GLFW_PLATFORM_WIN32)) {
+        return true;
+    }
+    return std::getenv("DISPLAY") != nullptr || std::getenv("WAYLAND_DISPLAY") != nullptr;
+}
+
 void PlatformController::initialize() {
-    if (glfwPlatformSupported(GLFW_PLATFORM_X11)) {
+    auto arg_parser = util::ArgParser::instance();
+    m_headless = arg_parser->has_flag("--headless");
+    m_frame_limit = arg_parser->arg<long long>("--frames", m_headless ? DEFAULT_HEADLESS_FRAMES : 0)
+                              .value();
+    if (m_headless && !has_display() && glfwPlatformSupported(GLFW_PLATFORM_NULL)) {
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+    } else if (glfwPlatformSupported(GLFW_PLATFORM_X11)) {
         glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11);
     } else if (glfwPlatformSupported(GLFW_PLATFORM_WAYLAND)) {
         glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_WAYLAND);
@@ -42,19 +89,28 @@ void PlatformController::initialize() {
     }
     bool glfw_initialized = glfwInit();
     RG_GUARANTEE(glfw_initialized, "GLFW platform failed to initialize_controllers.");
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     util::Configuration::json &config = util::Configuration::config();
+    const float fixed_update_rate = config.value(nlohmann::json::json_pointer("/app/fixed_update/rate"), 60.0f);
+    RG_GUARANTEE(fixed_update_rate > 0.0f, "app.fixed_update.rate must be positive, got {}.", fixed_update_rate);
+    m_fixed_timestep.step = 1.0f / fixed_update_rate;
+    m_fixed_timestep.max_steps = config.value(nlohmann::json::json_pointer("/app/fixed_update/max_steps"), 5u);
+    m_frame_pacing = read_frame_pacing(config);
     int window_width = config["window"]["width"];
     int window_height = config["window"]["height"];
     std::string window_title = config["window"]["title"];
-    GLFWwindow *handle = glfwCreateWindow(window_width, window_height, window_title.c_str(), nullptr, nullptr);
+    GLFWwindow *handle = create_window(window_width, window_height, window_title);
     RG_GUARANTEE(handle, "GLFW3 platform failed to create a Window.");
     m_window = Window(handle, window_width, window_height, window_title);
 
     glfwMakeContextCurrent(m_window.handle_());
+    if (m_headless) {
+        // Nobody looks at the frames, so don't wait for the vertical blank.
+        m_frame_pacing.vsync = VSync::Off;
+        spdlog::info("Platform running headless for {} frames.", m_frame_limit);
+    }
+    apply_vsync();
     glfwSetCursorPosCallback(m_window.handle_(), glfw_mouse_callback);
     glfwSetScrollCallback(m_window.handle_(), glfw_scroll_callback);
     glfwSetKeyCallback(m_window.handle_(), glfw_key_callback);
@@ -72,7 +128,41 @@ void PlatformController::initialize() {
     }
 }
 
+GLFWwindow *PlatformController::create_window(int width, int height, const std::string &title) {
+    constexpr std::array<std::pair<int, int>, 3> context_versions{{{4, 6}, {4, 3}, {3, 3}}};
+    for (const auto &[major, minor]: context_versions) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
+        GLFWwindow *handle = m_headless
+                             ? create_headless_window(width, height, title)
+                             : glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+        if (handle) {
+            spdlog::info("Platform created an OpenGL {}.{} core context.", major, minor);
+            return handle;
+        }
+        spdlog::info("Platform failed to create an OpenGL {}.{} core context.", major, minor);
+    }
+    return nullptr;
+}
+
+GLFWwindow *PlatformController::create_headless_window(int width, int height, const std::string &title) {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_NATIVE_CONTEXT_API);
+    // The native context API of the null platform is EGL, which needs EGL_MESA_platform_surfaceless.
+    GLFWwindow *handle = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+    if (!handle) {
+        spdlog::warn("Platform failed to create a headless window with the native context API, trying OSMesa.");
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        handle = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+    }
+    return handle;
+}
+
 void PlatformController::terminate() {
+    if (const auto stats = frame_pacing_stats(); stats.frames != 0) {
+        spdlog::info("Platform frame pacing over the last {} frames: mean {:.2f} ms, jitter {:.2f} ms, max {:.2f} ms, "
+                     "{} late.", stats.frames, stats.mean_ms, stats.jitter_ms, stats.max_ms, stats.late_frames);
+    }
     m_platform_event_observers.clear();
     if (m_window.handle_()) {
         glfwDestroyWindow(m_window.handle_());
@@ -84,10 +174,30 @@ bool PlatformController::loop() {
     m_frame_time.previous = m_frame_time.current;
     m_frame_time.current = glfwGetTime();
     m_frame_time.dt = m_frame_time.current - m_frame_time.previous;
+    advance_fixed_timestep(m_frame_time.dt);
 
+    if (m_frame_limit != 0 && m_frame_count >= m_frame_limit) {
+        return false;
+    }
+    ++m_frame_count;
     return !glfwWindowShouldClose(m_window.handle_());
 }
 
+void PlatformController::advance_fixed_timestep(float dt) {
+    FixedTimestep &timestep = m_fixed_timestep;
+    timestep.accumulator += dt;
+    const auto due = static_cast<uint64_t>(timestep.accumulator / timestep.step);
+    timestep.steps = static_cast<uint32_t>(std::min<uint64_t>(due, timestep.max_steps));
+    timestep.accumulator -= static_cast<float>(timestep.steps) * timestep.step;
+    if (due > timestep.steps) {
+        // The simulation can't keep up, e.g. after a hitch or a breakpoint. Let it run slower than the real time
+        // instead of catching up with more and more steps per frame.
+        timestep.dropped_steps += due - timestep.steps;
+        timestep.accumulator = std::fmod(timestep.accumulator, timestep.step);
+    }
+    timestep.alpha = std::clamp(timestep.accumulator / timestep.step, 0.0f, 1.0f);
+}
+
 void PlatformController::poll_events() {
     g_mouse_position.dx = g_mouse_position.dy = 0.0f;
     g_mouse_position.scroll = 0.0f;
@@ -99,6 +209,122 @@ void PlatformController::poll_events() {
 
 void PlatformController::swap_buffers() {
     glfwSwapBuffers(m_window.handle_());
+    pace_frame();
+}
+
+void PlatformController::set_frame_pacing(const FramePacing &frame_pacing) {
+    m_frame_pacing = frame_pacing;
+    if (m_headless) {
+        m_frame_pacing.vsync = VSync::Off;
+    }
+    apply_vsync();
+}
+
+void PlatformController::apply_vsync() {
+    int interval = 0;
+    switch (m_frame_pacing.vsync) {
+        case VSync::Off: interval = 0;
+            break;
+        case VSync::On: interval = 1;
+            break;
+        case VSync::Adaptive:
+            // A negative interval lets a late frame swap right away instead of waiting for the next vertical blank.
+            if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+                interval = -1;
+            } else {
+                spdlog::warn("Platform: adaptive vsync isn't supported by the driver, using vsync on.");
+                interval = 1;
+            }
+            break;
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled VSync mode.");
+    }
+    glfwSwapInterval(interval);
+}
+
+bool PlatformController::is_in_background() const {
+    // The window of a headless app is never focused, but it isn't in the background either.
+    return !m_headless && (!glfwGetWindowAttrib(m_window.handle_(), GLFW_FOCUSED) ||
+                           glfwGetWindowAttrib(m_window.handle_(), GLFW_ICONIFIED));
+}
+
+/**
+ * @brief Sleeps until about a millisecond before the `deadline`, because the sleep may oversleep by that much, and
+ * spins for the rest.
+ */
+static void wait_until(double deadline) {
+    constexpr double SPIN_SECONDS = 0.0015;
+    while (true) {
+        const double remaining = deadline - glfwGetTime();
+        if (remaining <= 0.0) {
+            return;
+        }
+        if (remaining > SPIN_SECONDS) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(remaining - SPIN_SECONDS));
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+float PlatformController::frame_rate_limit() const {
+    if (is_in_background() && m_frame_pacing.background_fps > 0.0f) {
+        return m_frame_pacing.background_fps;
+    }
+    return m_frame_pacing.max_fps;
+}
+
+void PlatformController::pace_frame() {
+    const float fps = frame_rate_limit();
+    double now = glfwGetTime();
+    if (!m_pacing_started) {
+        // Start measuring at the first presented frame, the startup before it isn't a frame interval.
+        m_pacing_started = true;
+        m_last_present = m_previous_present = now;
+        return;
+    }
+    if (fps > 0.0f) {
+        const double period = 1.0 / fps;
+        const double deadline = m_last_present + period;
+        {
+            RG_PROFILE_SCOPE("PlatformController", "frame_limiter");
+            wait_until(deadline);
+        }
+        now = glfwGetTime();
+        // Aim at the ideal moments so that the oversleeping doesn't accumulate, unless a slow frame
+        // fell a whole period behind; catching up would present the next frames in a burst.
+        m_last_present = now - deadline < period ? deadline : now;
+    } else {
+        m_last_present = now;
+    }
+    m_present_intervals[m_present_count % FRAME_PACING_HISTORY] = static_cast<float>(now - m_previous_present);
+    ++m_present_count;
+    m_previous_present = now;
+}
+
+FramePacingStats PlatformController::frame_pacing_stats() const {
+    FramePacingStats stats;
+    const float fps = frame_rate_limit();
+    stats.target_ms = fps > 0.0f ? 1000.0f / fps : 0.0f;
+    stats.frames = std::min(m_present_count, FRAME_PACING_HISTORY);
+    if (stats.frames == 0) {
+        return stats;
+    }
+    double sum = 0.0;
+    double sum_of_squares = 0.0;
+    for (uint32_t i = 0; i < stats.frames; ++i) {
+        const double milliseconds = m_present_intervals[i] * 1000.0;
+        sum += milliseconds;
+        sum_of_squares += milliseconds * milliseconds;
+        stats.max_ms = std::max(stats.max_ms, static_cast<float>(milliseconds));
+        if (stats.target_ms > 0.0f && milliseconds > 1.5 * stats.target_ms) {
+            ++stats.late_frames;
+        }
+    }
+    const double mean = sum / stats.frames;
+    stats.mean_ms = static_cast<float>(mean);
+    stats.jitter_ms = static_cast<float>(std::sqrt(std::max(sum_of_squares / stats.frames - mean * mean, 0.0)));
+    return stats;
 }
 
 int glfw_platform_action(GLFWwindow *window, int glfw_key_code) {
@@ -0,0 +1,291 @@
+#include <imgui.h>
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <map>
+#include <engine/util/Profiler.hpp>
+#include <json.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::util {
+static const auto g_profiler_epoch = std::chrono::steady_clock::now();
+
+Profiler *Profiler::instance() {
+    static Profiler profiler;
+    return &profiler;
+}
+
+uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_profiler_epoch)
+            .count();
+}
+
+Profiler::ThreadBuffer *Profiler::create_buffer(std::string name) {
+    std::lock_guard lock(m_buffers_mutex);
+    auto buffer = std::make_unique<ThreadBuffer>();
+    buffer->index = m_buffers.size();
+    buffer->name = std::move(name);
+    return m_buffers.emplace_back(std::move(buffer))
+                    .get();
+}
+
+Profiler::ThreadBuffer *Profiler::thread_buffer() {
+    thread_local ThreadBuffer *t_thread_buffer = nullptr;
+    if (t_thread_buffer == nullptr) {
+        t_thread_buffer = create_buffer("");
+        t_thread_buffer->name = t_thread_buffer->index == 0
+                                ? "main"
+                                : std::format("thread {}", t_thread_buffer->index);
+    }
+    return t_thread_buffer;
+}
+
+void Profiler::write(ThreadBuffer *buffer, ProfileEvent event) {
+    event.thread = buffer->index;
+    std::lock_guard lock(buffer->mutex);
+    buffer->events[buffer->written % EVENTS_PER_THREAD] = event;
+    ++buffer->written;
+}
+
+void Profiler::record_gpu_events(std::span<const ProfileEvent> events) {
+    if (m_gpu_buffer == nullptr) {
+        m_gpu_buffer = create_buffer("GPU");
+    }
+    m_gpu_frame_events.assign(events.begin(), events.end());
+    for (const auto &event: events) {
+        write(m_gpu_buffer, event);
+    }
+}
+
+void Profiler::set_thread_name(std::string name) {
+    auto buffer = thread_buffer();
+    std::lock_guard lock(buffer->mutex);
+    buffer->name = std::move(name);
+}
+
+void Profiler::begin_frame() {
+    m_frame_begins[m_frame_count % FRAME_HISTORY] = now();
+    ++m_frame_count;
+}
+
+std::vector<ProfileEvent> Profiler::events_between(uint64_t from, uint64_t to) const {
+    std::vector<ProfileEvent> result;
+    std::lock_guard lock(m_buffers_mutex);
+    for (const auto &buffer: m_buffers) {
+        std::lock_guard buffer_lock(buffer->mutex);
+        const uint64_t first = buffer->written > EVENTS_PER_THREAD ? buffer->written - EVENTS_PER_THREAD : 0;
+        for (uint64_t i = first; i < buffer->written; ++i) {
+            const ProfileEvent &event = buffer->events[i % EVENTS_PER_THREAD];
+            if (event.begin >= from && event.begin < to) {
+                result.push_back(event);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const ProfileEvent &lhs, const ProfileEvent &rhs) {
+        return lhs.begin < rhs.begin;
+    });
+    return result;
+}
+
+std::vector<ProfileEvent> Profiler::last_frame_events() const {
+    if (m_frame_count < 2) {
+        return {};
+    }
+    const uint64_t from = m_frame_begins[(m_frame_count - 2) % FRAME_HISTORY];
+    const uint64_t to = m_frame_begins[(m_frame_count - 1) % FRAME_HISTORY];
+    auto events = events_between(from, to);
+    if (m_gpu_buffer != nullptr) {
+        std::erase_if(events, [gpu = m_gpu_buffer->index](const ProfileEvent &event) {
+            return event.thread == gpu;
+        });
+    }
+    return events;
+}
+
+std::vector<uint64_t> Profiler::frame_durations() const {
+    std::vector<uint64_t> result;
+    const uint64_t count = std::min<uint64_t>(m_frame_count, FRAME_HISTORY);
+    for (uint64_t frame = m_frame_count - count + 1; frame < m_frame_count; ++frame) {
+        result.push_back(m_frame_begins[frame % FRAME_HISTORY] - m_frame_begins[(frame - 1) % FRAME_HISTORY]);
+    }
+    return result;
+}
+
+bool Profiler::export_chrome_trace(const std::filesystem::path &path) const {
+    nlohmann::json trace_events = nlohmann::json::array();
+    {
+        std::lock_guard lock(m_buffers_mutex);
+        for (const auto &buffer: m_buffers) {
+            std::lock_guard buffer_lock(buffer->mutex);
+            trace_events.push_back({
+                    {"name", "thread_name"},
+                    {"ph", "M"},
+                    {"pid", 0},
+                    {"tid", buffer->index},
+                    {"args", {{"name", buffer->name}}},
+            });
+        }
+    }
+    for (const auto &event: events_between(0, UINT64_MAX)) {
+        std::string name(event.name);
+        if (!event.detail.empty()) {
+            name = std::format("{}::{}", event.name, event.detail);
+        }
+        // The trace event format expects microseconds.
+        trace_events.push_back({
+                {"name", std::move(name)},
+                {"cat", event.detail.empty() ? "scope" : std::string(event.detail)},
+                {"ph", "X"},
+                {"pid", 0},
+                {"tid", event.thread},
+                {"ts", static_cast<double>(event.begin) / 1000.0},
+                {"dur", static_cast<double>(event.end - event.begin) / 1000.0},
+        });
+    }
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        spdlog::warn("Profiler: failed to open {} for writing", path.string());
+        return false;
+    }
+    file << nlohmann::json{{"traceEvents", std::move(trace_events)}, {"displayTimeUnit", "ms"}}.dump();
+    spdlog::info("Profiler: exported the trace into {}", path.string());
+    return static_cast<bool>(file);
+}
+
+static ImU32 event_color(std::string_view name) {
+    const uint64_t hash = fnv1a(name);
+    return IM_COL32(80 + hash % 150, 80 + (hash >> 8) % 150, 80 + (hash >> 16) % 150, 255);
+}
+
+static double to_milliseconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1e6;
+}
+
+void Profiler::draw_gui() {
+    ImGui::Begin("Profiler");
+    bool enabled = is_enabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) {
+        set_enabled(enabled);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export Chrome trace")) {
+        export_chrome_trace("profiler-trace.json");
+    }
+
+    const auto durations = frame_durations();
+    std::vector<float> frame_times;
+    frame_times.reserve(durations.size());
+    for (auto duration: durations) {
+        frame_times.push_back(static_cast<float>(to_milliseconds(duration)));
+    }
+    if (!frame_times.empty()) {
+        ImGui::PlotLines("##frame_times", frame_times.data(), static_cast<int>(frame_times.size()), 0,
+                         std::format("frame {:.2f} ms", frame_times.back()).c_str(), 0.0f, 50.0f,
+                         ImVec2(ImGui::GetContentRegionAvail().x, 60.0f));
+    }
+    if (!m_gpu_frame_events.empty()) {
+        const auto &gpu_frame = m_gpu_frame_events.front();
+        ImGui::Text("GPU frame: %.3f ms", to_milliseconds(gpu_frame.end - gpu_frame.begin));
+    }
+
+    const auto events = last_frame_events();
+    if (events.empty()) {
+        ImGui::End();
+        return;
+    }
+    const uint64_t frame_begin = m_frame_begins[(m_frame_count - 2) % FRAME_HISTORY];
+    const uint64_t frame_end = m_frame_begins[(m_frame_count - 1) % FRAME_HISTORY];
+    const double frame_length = static_cast<double>(std::max<uint64_t>(frame_end - frame_begin, 1));
+
+    // Timeline of the last frame: one lane per thread, one row per nesting depth.
+    constexpr float row_height = 18.0f;
+    uint32_t thread_count = 0;
+    uint32_t max_depth = 0;
+    for (const auto &event: events) {
+        thread_count = std::max(thread_count, event.thread + 1);
+        max_depth = std::max(max_depth, event.depth);
+    }
+    const float lane_height = row_height * static_cast<float>(max_depth + 1) + 4.0f;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    ImGui::InvisibleButton("##timeline", ImVec2(width, lane_height * static_cast<float>(thread_count)));
+    ImDrawList *draw_list = ImGui::GetWindowDrawList();
+    const ImVec2 mouse = ImGui::GetMousePos();
+    for (const auto &event: events) {
+        const auto x0 = static_cast<float>(static_cast<double>(event.begin - frame_begin) / frame_length * width);
+        const auto x1 = static_cast<float>(static_cast<double>(std::min(event.end, frame_end) - frame_begin) /
+                                           frame_length * width);
+        const ImVec2 min(origin.x + x0,
+                         origin.y + lane_height * static_cast<float>(event.thread) + row_height *
+                                                                                     static_cast<float>(event.depth));
+        const ImVec2 max(origin.x + std::max(x1, x0 + 1.0f), min.y + row_height - 1.0f);
+        draw_list->AddRectFilled(min, max, event_color(event.name));
+        const std::string label = event.detail.empty()
+                                  ? std::string(event.name)
+                                  : std::format("{}::{}", event.name, event.detail);
+        if (ImGui::CalcTextSize(label.c_str()).x < max.x - min.x - 4.0f) {
+            draw_list->AddText(ImVec2(min.x + 2.0f, min.y + 2.0f), IM_COL32_WHITE, label.c_str());
+        }
+        if (ImGui::IsItemHovered() && mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y) {
+            ImGui::SetTooltip("%s\n%.3f ms", label.c_str(), to_milliseconds(event.end - event.begin));
+        }
+    }
+
+    // Total time of every scope in the last frame, the most expensive first. The GPU scopes are from the last frame
+    // whose GPU results were read.
+    std::map<std::pair<std::string_view, std::string_view>, uint64_t> totals;
+    for (const auto &event: events) {
+        totals[{event.name, event.detail}] += event.end - event.begin;
+    }
+    for (const auto &event: m_gpu_frame_events) {
+        totals[{event.name, "GPU"}] += event.end - event.begin;
+    }
+    std::vector<std::pair<uint64_t, std::string>> sorted_totals;
+    for (const auto &[key, total]: totals) {
+        sorted_totals.emplace_back(total, key.second.empty()
+                                          ? std::string(key.first)
+                                          : std::format("{}::{}", key.first, key.second));
+    }
+    std::sort(sorted_totals.rbegin(), sorted_totals.rend());
+    if (ImGui::BeginTable("##totals", 2, ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Scope");
+        ImGui::TableSetupColumn("ms");
+        ImGui::TableHeadersRow();
+        for (const auto &[total, label]: sorted_totals) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(label.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", to_milliseconds(total));
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+ProfileScope::ProfileScope(std::string_view name, std::string_view detail) {
+    auto profiler = Profiler::instance();
+    if (!profiler->is_enabled()) {
+        return;
+    }
+    m_name = name;
+    m_detail = detail;
+    m_buffer = profiler->thread_buffer();
+    ++m_buffer->depth;
+    m_begin = Profiler::now();
+}
+
+ProfileScope::~ProfileScope() {
+    if (m_buffer == nullptr) {
+        return;
+    }
+    ProfileEvent event;
+    event.end = Profiler::now();
+    event.name = m_name;
+    event.detail = m_detail;
+    event.begin = m_begin;
+    event.depth = --m_buffer->depth;
+    Profiler::write(m_buffer, event);
+}
+} // namespace engine::util
@@ -0,0 +1,395 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <engine/core/JobSystemController.hpp>
+#include <engine/graphics/GpuCulling.hpp>
+#include <engine/graphics/GpuProfiler.hpp>
+#include <engine/graphics/GraphicsController.hpp>
+#include <engine/graphics/OpenGL.hpp>
+#include <engine/graphics/RenderQueue.hpp>
+#include <engine/resources/Mesh.hpp>
+#include <engine/resources/Model.hpp>
+#include <engine/resources/Shader.hpp>
+#include <engine/resources/Skybox.hpp>
+#include <engine/util/Errors.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::graphics {
+constexpr uint64_t g_shader_bits = 12;
+constexpr uint64_t g_material_bits = 16;
+constexpr uint64_t g_depth_bits = 24;
+constexpr uint64_t g_unused_bits = 10;
+
+static_assert(2 + g_shader_bits + g_material_bits + g_depth_bits + g_unused_bits == 64);
+
+// OpenGL 4.0, not in the 3.3 core glad.
+static constexpr GLenum DRAW_INDIRECT_BUFFER = 0x8F3F;
+
+using MultiDrawElementsIndirectFunction = void (APIENTRYP)(GLenum mode, GLenum type, const void *indirect,
+                                                            GLsizei draw_count, GLsizei stride);
+static MultiDrawElementsIndirectFunction g_multi_draw_elements_indirect = nullptr;
+
+static uint64_t bits(uint64_t value, uint64_t count) {
+    return value & ((1ull << count) - 1);
+}
+
+static RenderPass pass_of(uint64_t key) {
+    return static_cast<RenderPass>(key >> 62);
+}
+
+uint64_t RenderQueue::sort_key(RenderPass pass, uint32_t shader_id, uint32_t material, float depth) {
+    const uint64_t max_depth = (1ull << g_depth_bits) - 1;
+    const auto quantized_depth = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * static_cast<float>(max_depth));
+    const uint64_t shader = bits(shader_id, g_shader_bits);
+    const uint64_t state = shader << g_material_bits | bits(material, g_material_bits);
+    uint64_t key = static_cast<uint64_t>(pass) << 62;
+    if (pass == RenderPass::Transparent) {
+        key |= (max_depth - quantized_depth) << (g_shader_bits + g_material_bits + g_unused_bits);
+        key |= state << g_unused_bits;
+    } else {
+        key |= state << (g_depth_bits + g_unused_bits);
+        key |= quantized_depth << g_unused_bits;
+    }
+    return key;
+}
+
+RenderQueue::RenderQueue() = default;
+
+RenderQueue::~RenderQueue() = default;
+
+void RenderQueue::initialize(const RenderQueueSettings &settings) {
+    // The draws of a multi-draw select their model matrix with the base instance, which needs GL_ARB_base_instance.
+    if (OpenGL::is_version_at_least(4, 3) ||
+        (OpenGL::has_extension("GL_ARB_multi_draw_indirect") && OpenGL::has_extension("GL_ARB_base_instance"))) {
+        g_multi_draw_elements_indirect = OpenGL::load_function<MultiDrawElementsIndirectFunction>(
+                "glMultiDrawElementsIndirect");
+    }
+    m_multi_draw_indirect_supported = g_multi_draw_elements_indirect != nullptr;
+    m_multi_draw_indirect_enabled = settings.multi_draw_indirect && m_multi_draw_indirect_supported;
+    spdlog::info("RenderQueue: multi-draw indirect {}.", !m_multi_draw_indirect_supported
+                                                         ? "not supported"
+                                                         : m_multi_draw_indirect_enabled ? "enabled" : "disabled");
+    if (m_multi_draw_indirect_supported && GpuCulling::is_supported()) {
+        m_gpu_culling = std::make_unique<GpuCulling>();
+        m_gpu_culling->initialize(settings.occlusion_culling, settings.validate_culling);
+        m_gpu_culling_enabled = settings.gpu_culling;
+    }
+    m_occlusion_culler.initialize(settings.software_occlusion_width, settings.software_occlusion_height);
+    m_software_occlusion_enabled = settings.software_occlusion;
+    spdlog::info("RenderQueue: software occlusion culling {}, {}x{} with the {} kernels.",
+                 m_software_occlusion_enabled ? "enabled" : "disabled", m_occlusion_culler.width(),
+                 m_occlusion_culler.height(), OcclusionCuller::kernel_name());
+}
+
+void RenderQueue::terminate() {
+    if (m_gpu_culling) {
+        m_gpu_culling->terminate();
+    }
+}
+
+void RenderQueue::begin(const glm::mat4 &view, const glm::mat4 &view_projection, const Frustum &frustum, float near,
+                        float far) {
+    m_packets.clear();
+    m_occlusion_culler.begin(view_projection);
+    m_frame_stats = RenderQueueStats{};
+    m_view = view;
+    m_frustum = frustum;
+    m_near = near;
+    m_far = far;
+}
+
+float RenderQueue::normalized_depth(const glm::vec3 &position) const {
+    // The camera looks down the negative z axis of the view space.
+    const float distance = -(m_view * glm::vec4(position, 1.0f)).z;
+    return (distance - m_near) / (m_far - m_near);
+}
+
+bool RenderQueue::is_visible(const resources::MeshBounds &bounds, const glm::mat4 &model) const {
+    return m_frustum.intersects(bounds.sphere.transformed(model)) &&
+           m_frustum.intersects(bounds.aabb.transformed(model));
+}
+
+void RenderQueue::submit(const resources::Shader *shader, resources::Mesh *mesh, const glm::mat4 &model,
+                         RenderPass pass) {
+    const bool culled_on_gpu = is_gpu_culling_enabled() && shader->reads_instance_model();
+    if (m_culling_enabled && !culled_on_gpu && !is_visible(mesh->bounds(), model)) {
+        ++m_frame_stats.culled;
+        return;
+    }
+    ++m_frame_stats.visible;
+    DrawPacket packet;
+    packet.key = sort_key(pass, shader->id(), mesh->material_key(), normalized_depth(glm::vec3(model[3])));
+    packet.shader = shader;
+    packet.mesh = mesh;
+    packet.model = model;
+    m_packets.push_back(packet);
+}
+
+void RenderQueue::submit(const resources::Shader *shader, resources::Model *model, const glm::mat4 &transform,
+                         RenderPass pass) {
+    model->update_transforms();
+    if (m_culling_enabled && !is_visible(model->bounds(), transform)) {
+        m_frame_stats.culled += model->instances()
+                                     .size();
+        return;
+    }
+    if (pass == RenderPass::Opaque && model->occluder() && is_software_occlusion_enabled()) {
+        m_occlusion_culler.add_occluder(*model->occluder(), transform);
+    }
+    for (const auto &instance: model->instances()) {
+        submit(shader, &model->meshes()[instance.mesh], transform * model->world_transform(instance.node), pass);
+    }
+}
+
+void RenderQueue::submit(const resources::Shader *shader, const resources::Skybox *skybox) {
+    DrawPacket packet;
+    packet.key = sort_key(RenderPass::Skybox, shader->id(), 0, 1.0f);
+    packet.shader = shader;
+    packet.skybox = skybox;
+    m_packets.push_back(packet);
+}
+
+static void begin_pass(RenderPass pass) {
+    switch (pass) {
+        case RenderPass::Opaque: break;
+        case RenderPass::Skybox: {
+            // The skybox is drawn at the far plane, where the depth buffer was cleared to.
+            OpenGL::set_depth_func(GL_LEQUAL);
+            break;
+        }
+        case RenderPass::Transparent: {
+            OpenGL::set_depth_func(GL_LESS);
+            OpenGL::set_depth_mask(false);
+            OpenGL::set_blend(true);
+            OpenGL::set_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            break;
+        }
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled RenderPass");
+    }
+}
+
+static void end_passes() {
+    OpenGL::set_depth_func(GL_LESS);
+    OpenGL::set_depth_mask(true);
+    OpenGL::set_blend(false);
+}
+
+void RenderQueue::draw_skybox(const DrawPacket &packet) const {
+    RG_GPU_PROFILE_SCOPE("draw_skybox");
+    OpenGL::bind_vertex_array(packet.skybox->vao());
+    OpenGL::bind_texture(0, GL_TEXTURE_CUBE_MAP, packet.skybox->texture());
+    CHECKED_GL_CALL(glDrawArrays, GL_TRIANGLES, 0, 36);
+}
+
+void RenderQueue::cull_occluded() {
+    if (!is_software_occlusion_enabled()) {
+        return;
+    }
+    auto jobs = core::Controller::get<core::JobSystemController>()->job_system();
+    m_occlusion_culler.rasterize(*jobs);
+    m_frame_stats.occluder_triangles = m_occlusion_culler.triangle_count();
+    if (!m_occlusion_culler.has_occluders()) {
+        return;
+    }
+    m_occluded.assign(m_packets.size(), 0);
+    jobs->parallel_for(0, m_packets.size(), 256, [this](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            const DrawPacket &packet = m_packets[i];
+            if (packet.mesh) {
+                m_occluded[i] = m_occlusion_culler.is_occluded(packet.mesh->bounds().aabb.transformed(packet.model));
+            }
+        }
+    });
+    size_t kept = 0;
+    for (size_t i = 0; i < m_packets.size(); ++i) {
+        if (!m_occluded[i]) {
+            m_packets[kept++] = m_packets[i];
+        }
+    }
+    const auto occluded = static_cast<uint32_t>(m_packets.size() - kept);
+    m_frame_stats.occluded += occluded;
+    m_frame_stats.visible -= occluded;
+    m_packets.resize(kept);
+}
+
+static void set_instance_model(const glm::mat4 &model) {
+    // With the attribute arrays disabled, every vertex reads the constant value of the attributes.
+    for (uint32_t column = 0; column < 4; ++column) {
+        glVertexAttrib4fv(resources::Mesh::INSTANCE_MODEL_LOCATION + column, &model[column][0]);
+    }
+}
+
+bool RenderQueue::is_indirect(const DrawPacket &packet) const {
+    return m_multi_draw_indirect_enabled && packet.mesh && packet.shader->reads_instance_model();
+}
+
+void RenderQueue::prepare_indirect_draws() {
+    m_indirect_batches.clear();
+    m_indirect_transforms.clear();
+    m_indirect_commands.clear();
+    for (size_t i = 0; i < m_sorted.size();) {
+        const auto [key, index] = m_sorted[i];
+        const DrawPacket &packet = m_packets[index];
+        if (!is_indirect(packet)) {
+            ++i;
+            continue;
+        }
+        IndirectBatch batch{i, i + 1, static_cast<uint32_t>(m_indirect_commands.size())};
+        while (batch.last < m_sorted.size()) {
+            const auto [next_key, next_index] = m_sorted[batch.last];
+            const DrawPacket &next = m_packets[next_index];
+            if (pass_of(next_key) != pass_of(key) || next.shader != packet.shader || !next.mesh ||
+                !next.mesh->has_same_material(*packet.mesh)) {
+                break;
+            }
+            ++batch.last;
+        }
+        for (size_t j = batch.first; j < batch.last; ++j) {
+            const DrawPacket &draw = m_packets[m_sorted[j].second];
+            const auto &geometry = draw.mesh->geometry();
+            const auto slot = static_cast<uint32_t>(m_indirect_commands.size());
+            m_indirect_transforms.push_back(draw.model);
+            m_indirect_commands.push_back(DrawElementsIndirectCommand{geometry.index_count, 1, geometry.first_index,
+                                                                      static_cast<int32_t>(geometry.base_vertex),
+                                                                      slot});
+        }
+        m_indirect_batches.push_back(batch);
+        i = batch.last;
+    }
+    if (m_indirect_commands.empty()) {
+        return;
+    }
+    auto graphics = core::Controller::get<GraphicsController>();
+    auto &stream = graphics->stream_buffer();
+    const auto transforms = stream.allocate_storage(m_indirect_transforms.size() * sizeof(glm::mat4));
+    std::memcpy(transforms.data, m_indirect_transforms.data(), transforms.size);
+    stream.commit(transforms);
+    graphics->geometry_pool()
+            .attach_instance_buffer(transforms.buffer, transforms.offset);
+    m_indirect_count_buffer = 0;
+    if (is_gpu_culling_enabled()) {
+        m_culling_draws.clear();
+        for (uint32_t batch_index = 0; batch_index < m_indirect_batches.size(); ++batch_index) {
+            const IndirectBatch &batch = m_indirect_batches[batch_index];
+            for (size_t j = batch.first; j < batch.last; ++j) {
+                const auto &aabb = m_packets[m_sorted[j].second].mesh->bounds().aabb;
+                CullingDraw draw;
+                draw.aabb_min = glm::vec4(aabb.min, 0.0f);
+                draw.aabb_max = glm::vec4(aabb.max, 0.0f);
+                draw.command = m_indirect_commands[batch.first_command + (j - batch.first)];
+                draw.batch = batch_index;
+                draw.batch_first = batch.first_command;
+                m_culling_draws.push_back(draw);
+            }
+        }
+        const auto batch_count = static_cast<uint32_t>(m_indirect_batches.size());
+        const auto result = m_gpu_culling->cull(m_culling_draws, transforms, batch_count, m_frustum);
+        if (m_gpu_culling->is_validation_enabled()) {
+            m_gpu_culling->validate(result, m_culling_draws, m_indirect_transforms, batch_count, m_frustum);
+        }
+        OpenGL::bind_buffer(DRAW_INDIRECT_BUFFER, result.commands.buffer);
+        m_indirect_offset = result.commands.offset;
+        if (GpuCulling::has_indirect_count()) {
+            m_indirect_count_buffer = result.counts.buffer;
+            m_indirect_count_offset = result.counts.offset;
+        }
+        return;
+    }
+    const auto commands = stream.allocate(m_indirect_commands.size() * sizeof(DrawElementsIndirectCommand),
+                                          alignof(DrawElementsIndirectCommand));
+    std::memcpy(commands.data, m_indirect_commands.data(), commands.size);
+    stream.commit(commands);
+    OpenGL::bind_buffer(DRAW_INDIRECT_BUFFER, commands.buffer);
+    m_indirect_offset = commands.offset;
+}
+
+void RenderQueue::draw_indirect(uint32_t batch_index) {
+    const IndirectBatch &batch = m_indirect_batches[batch_index];
+    const DrawPacket &packet = m_packets[m_sorted[batch.first].second];
+    packet.mesh->bind_textures(packet.shader);
+    core::Controller::get<GraphicsController>()->geometry_pool()
+                                               .bind();
+    const size_t command_offset = m_indirect_offset + batch.first_command * sizeof(DrawElementsIndirectCommand);
+    const auto draw_count = static_cast<uint32_t>(batch.last - batch.first);
+    if (m_indirect_count_buffer) {
+        GpuCulling::multi_draw_indirect_count(command_offset, m_indirect_count_buffer,
+                                              m_indirect_count_offset + batch_index * sizeof(uint32_t), draw_count);
+    } else {
+        // NOLINTNEXTLINE
+        CHECKED_GL_CALL(g_multi_draw_elements_indirect, GL_TRIANGLES, GL_UNSIGNED_INT, (const void *) command_offset,
+                        static_cast<GLsizei>(draw_count), 0);
+    }
+    for (size_t i = batch.first; i < batch.last; ++i) {
+        m_frame_stats.triangles += m_packets[m_sorted[i].second].mesh->index_count() / 3;
+    }
+    m_frame_stats.indirect_draws += draw_count;
+}
+
+void RenderQueue::flush() {
+    cull_occluded();
+    m_sorted.clear();
+    m_sorted.reserve(m_packets.size());
+    for (uint32_t i = 0; i < m_packets.size(); ++i) {
+        m_sorted.emplace_back(m_packets[i].key, i);
+    }
+    std::sort(m_sorted.begin(), m_sorted.end());
+    prepare_indirect_draws();
+    uint32_t next_batch = 0;
+
+    const resources::Shader *shader = nullptr;
+    resources::UniformHandle model_uniform;
+    RenderPass pass = RenderPass::Opaque;
+    bool first = true;
+    uint64_t material = 0;
+    for (size_t i = 0; i < m_sorted.size();) {
+        const auto [key, index] = m_sorted[i];
+        const DrawPacket &packet = m_packets[index];
+        if (first || pass_of(key) != pass) {
+            pass = pass_of(key);
+            begin_pass(pass);
+        }
+        if (packet.shader != shader) {
+            shader = packet.shader;
+            shader->use();
+            model_uniform = shader->uniform("model");
+            ++m_frame_stats.shader_changes;
+        }
+        if (packet.skybox) {
+            draw_skybox(packet);
+            m_frame_stats.triangles += 12;
+            ++i;
+        } else {
+            const uint64_t packet_material = packet.mesh->material_key();
+            if (first || packet_material != material) {
+                material = packet_material;
+                ++m_frame_stats.material_changes;
+            }
+            if (is_indirect(packet)) {
+                RG_GUARANTEE(m_indirect_batches[next_batch].first == i, "Indirect batch {} is out of order.",
+                             next_batch);
+                i = m_indirect_batches[next_batch].last;
+                draw_indirect(next_batch++);
+            } else {
+                if (shader->reads_instance_model()) {
+                    set_instance_model(packet.model);
+                } else {
+                    shader->set_mat4(model_uniform, packet.model);
+                }
+                packet.mesh->draw(shader);
+                m_frame_stats.triangles += packet.mesh->index_count() / 3;
+                ++i;
+            }
+        }
+        ++m_frame_stats.draw_calls;
+        first = false;
+    }
+    if (!m_indirect_batches.empty()) {
+        core::Controller::get<GraphicsController>()->geometry_pool()
+                                                   .detach_instance_buffer();
+    }
+    if (!m_sorted.empty()) {
+        end_passes();
+    }
+    m_stats = m_frame_stats;
+}
+} // namespace engine::graphics
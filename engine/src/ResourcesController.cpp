@@ -1,25 +1,365 @@
 #include <unordered_set>
 #include <utility>
-#include <assimp/Importer.hpp>
-#include <assimp/postprocess.h>
-#include <assimp/scene.h>
+#include <engine/core/JobSystemController.hpp>
 #include <engine/graphics/OpenGL.hpp>
 #include <engine/resources/ResourcesController.hpp>
 #include <engine/resources/ShaderCompiler.hpp>
 #include <engine/util/Configuration.hpp>
 #include <engine/util/Errors.hpp>
+#include <cstdlib>
+#include <future>
 #include <spdlog/spdlog.h>
 
 namespace engine::resources {
 
+template<typename T>
+struct PendingLoad {
+    std::string name;
+    std::filesystem::path path;
+    std::future<T> result;
+};
+
+struct PendingSkyboxLoad {
+    std::string name;
+    std::filesystem::path path;
+    std::vector<std::future<ImageData> > faces;
+};
+
+/**
+ * @brief A model imported on a worker thread together with its occluder proxy and the textures its materials reference.
+ */
+struct ImportedModel {
+    std::filesystem::path path;
+    ModelData model;
+    std::optional<graphics::OccluderMesh> occluder;
+    std::vector<std::pair<TextureReference, TextureData> > textures;
+};
+
+struct ResourcesController::PendingLoads {
+    std::vector<PendingLoad<std::string> > shaders;
+    std::vector<PendingLoad<ImportedModel> > models;
+    std::vector<PendingLoad<TextureData> > textures;
+    std::vector<PendingSkyboxLoad> skyboxes;
+};
+
+/**
+ * @brief Builds one occluder proxy from the triangles of the meshes placed by the nodes of the `model` the `config`
+ * selects, see @ref graphics::build_occluder_mesh.
+ */
+static graphics::OccluderMesh build_occluder(const ModelData &model, const OccluderConfig &config) {
+    std::vector<glm::mat4> world_transforms(model.nodes.size());
+    std::vector<uint8_t> selected(model.nodes.size(), 0);
+    std::vector<std::pair<uint32_t, glm::mat4> > instances;
+    for (size_t node = 0; node < model.nodes.size(); ++node) {
+        const auto &data = model.nodes[node];
+        world_transforms[node] = data.parent < 0 ? data.transform : world_transforms[data.parent] * data.transform;
+        selected[node] = config.nodes.empty() || (data.parent >= 0 && selected[data.parent]) ||
+                         std::ranges::find(config.nodes, data.name) != config.nodes.end();
+        if (!selected[node]) {
+            continue;
+        }
+        for (uint32_t mesh: data.meshes) {
+            instances.emplace_back(mesh, world_transforms[node]);
+        }
+    }
+    if (model.nodes.empty() && config.nodes.empty()) {
+        for (uint32_t mesh = 0; mesh < model.meshes.size(); ++mesh) {
+            instances.emplace_back(mesh, glm::mat4(1.0f));
+        }
+    }
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    for (const auto &[mesh_index, transform]: instances) {
+        const auto &mesh = model.meshes[mesh_index];
+        const auto first_vertex = static_cast<uint32_t>(positions.size());
+        for (const auto &vertex: mesh.vertices) {
+            positions.emplace_back(transform * glm::vec4(vertex.Position, 1.0f));
+        }
+        for (uint32_t index: mesh.indices) {
+            indices.push_back(first_vertex + index);
+        }
+    }
+    return graphics::build_occluder_mesh(positions, indices, config.grid);
+}
+
+/**
+ * @brief Imports the model through the `mesh_cache` and, with an `occluder_config`, builds its occluder proxy.
+ * Doesn't touch the OpenGL context, so it runs on the workers.
+ */
+static ImportedModel import_model(const MeshCache &mesh_cache, const std::filesystem::path &model_path, bool flip_uvs,
+                                  const std::optional<OccluderConfig> &occluder_config) {
+    ImportedModel result{model_path, mesh_cache.import(model_path, flip_uvs), std::nullopt, {}};
+    if (occluder_config) {
+        result.occluder = build_occluder(result.model, *occluder_config);
+        if (result.occluder->triangle_count() == 0) {
+            spdlog::warn("The occluder proxy of {} is empty, check its occluder_nodes.", model_path.string());
+            result.occluder.reset();
+        }
+    }
+    return result;
+}
+
 void ResourcesController::initialize() {
-    load_shaders();
-    load_models();
-    load_textures();
-    load_skyboxes();
+    const auto &config = util::Configuration::config();
+    bool mesh_cache_enabled = config.value(nlohmann::json::json_pointer("/resources/mesh_cache"), true);
+    m_mesh_cache = std::make_unique<MeshCache>(m_mesh_cache_path, mesh_cache_enabled);
+    bool texture_cache_enabled = config.value(nlohmann::json::json_pointer("/resources/texture_cache"), true);
+    m_texture_cache = std::make_unique<TextureCache>(m_texture_cache_path, texture_cache_enabled);
+    m_jobs = core::Controller::get<core::JobSystemController>()->job_system();
+    create_placeholders();
+    PendingLoads pending;
+    load_models(*m_jobs, pending);
+    load_textures(*m_jobs, pending);
+    load_skyboxes(*m_jobs, pending);
+    load_shaders(*m_jobs, pending);
+    finish_loading(*m_jobs, pending);
+}
+
+ImageData checkerboard_image(int32_t size, int32_t channels, uint8_t light, uint8_t dark) {
+    ImageData result;
+    result.width = result.height = size;
+    result.channels = channels;
+    result.pixels.reset(static_cast<uint8_t *>(std::malloc(size * size * channels)));
+    for (int32_t y = 0; y < size; ++y) {
+        for (int32_t x = 0; x < size; ++x) {
+            uint8_t *pixel = result.pixels.get() + (y * size + x) * channels;
+            std::fill_n(pixel, channels, ((x + y) % 2 == 0) ? light : dark);
+        }
+    }
+    return result;
+}
+
+MeshData placeholder_cube_mesh() {
+    MeshData result;
+    const glm::vec3 normals[] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (const auto &normal: normals) {
+        glm::vec3 tangent = glm::abs(normal.y) > 0.5f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+        glm::vec3 bitangent = glm::cross(normal, tangent);
+        const auto first = static_cast<uint32_t>(result.vertices.size());
+        const glm::vec2 corners[] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+        for (const auto &corner: corners) {
+            Vertex vertex{};
+            vertex.Position = 0.5f * (normal + corner.x * tangent + corner.y * bitangent);
+            vertex.Normal = normal;
+            vertex.TexCoords = 0.5f * (corner + 1.0f);
+            vertex.Tangent = tangent;
+            vertex.Bitangent = bitangent;
+            result.vertices.push_back(vertex);
+        }
+        for (uint32_t index: {0u, 1u, 2u, 0u, 2u, 3u}) {
+            result.indices.push_back(first + index);
+        }
+    }
+    result.bounds = compute_bounds(result.vertices);
+    return result;
+}
+
+constexpr std::string_view g_placeholder_shader_source = R"(//#shader vertex
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+
+layout (std140) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec4 camera_position;
+    float time;
+};
+
+void main() {
+    gl_Position = view_projection * model * vec4(aPos, 1.0);
+}
+
+//#shader fragment
+#version 330 core
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(1.0, 0.0, 1.0, 1.0);
+}
+)";
+
+void ResourcesController::create_placeholders() {
+    ImageData checkerboard = checkerboard_image(8, 3, 255, 64);
+    m_placeholder_texture = std::make_unique<Texture>(Texture(graphics::OpenGL::generate_texture(checkerboard),
+                                                              TextureType::Diffuse, "", "placeholder"));
+
+    std::vector<Mesh> meshes;
+    MeshData cube = placeholder_cube_mesh();
+    meshes.emplace_back(Mesh(cube.vertices, cube.indices, {m_placeholder_texture.get()}, cube.bounds));
+    m_placeholder_model = std::make_unique<Model>(Model(std::move(meshes), {}, "", "placeholder"));
+
+    std::vector<ImageData> faces;
+    for (std::string_view face: {"right", "left", "top", "bottom", "front", "back"}) {
+        faces.emplace_back(checkerboard_image(1, 3, 128, 128));
+        faces.back().path = face;
+    }
+    m_placeholder_skybox = std::make_unique<Skybox>(Skybox(graphics::OpenGL::init_skybox_cube(),
+                                                           graphics::OpenGL::load_skybox_textures(faces),
+                                                           "", "placeholder"));
+
+    m_placeholder_shader = std::make_unique<Shader>(
+            ShaderCompiler::compile_from_source("placeholder", std::string(g_placeholder_shader_source)));
+}
+
+template<typename TResource, typename TLoad, typename TCreate>
+ResourceHandle<TResource> ResourcesController::load_async(const std::string &name,
+                                                          std::unordered_map<std::string, std::unique_ptr<TResource> > &
+                                                          loaded,
+                                                          InFlightLoads<TResource> &in_flight,
+                                                          TResource *placeholder, TLoad load, TCreate create) {
+    using Slot = typename ResourceHandle<TResource>::Slot;
+    if (auto it = in_flight.find(name); it != in_flight.end()) {
+        return ResourceHandle<TResource>(it->second);
+    }
+    auto slot = std::make_shared<Slot>();
+    slot->name = name;
+    slot->placeholder = placeholder;
+    if (auto it = loaded.find(name); it != loaded.end() && it->second) {
+        slot->state = LoadState::Ready;
+        slot->resource = it->second.get();
+        return ResourceHandle<TResource>(slot);
+    }
+    in_flight.emplace(name, slot);
+
+    auto fail = [slot, &in_flight](std::string message) {
+        spdlog::error("Failed to load {}: {}", slot->name, message);
+        slot->state = LoadState::Failed;
+        slot->error = std::move(message);
+        in_flight.erase(slot->name);
+    };
+    m_jobs->schedule([jobs = m_jobs, slot, &loaded, &in_flight, fail, load = std::move(load), create = std::move(create)]() mutable {
+        std::move_only_function<void()> complete;
+        try {
+            complete = [slot, &loaded, &in_flight, fail, data = load(), create = std::move(create)]() mutable {
+                try {
+                    // The resource may have been loaded synchronously in the meantime.
+                    auto &existing = loaded[slot->name];
+                    slot->resource = existing ? existing.get() : create(std::move(data));
+                    slot->state = LoadState::Ready;
+                    in_flight.erase(slot->name);
+                } catch (const util::Error &e) {
+                    fail(e.report());
+                } catch (const std::exception &e) {
+                    fail(e.what());
+                } catch (...) {
+                    fail("unknown exception");
+                }
+            };
+        } catch (const util::Error &e) {
+            complete = [fail, message = e.report()]() mutable {
+                fail(std::move(message));
+            };
+        } catch (const std::exception &e) {
+            complete = [fail, message = std::string(e.what())]() mutable {
+                fail(std::move(message));
+            };
+        } catch (...) {
+            complete = [fail]() mutable {
+                fail("unknown exception");
+            };
+        }
+        jobs->run_on_main_thread(std::move(complete));
+    });
+    return ResourceHandle<TResource>(slot);
+}
+
+ResourceHandle<Model> ResourcesController::model_async(const std::string &name) {
+    auto [model_path, flip_uvs] = model_config(name);
+    return load_async(name, m_models, m_models_in_flight, m_placeholder_model.get(),
+                      [mesh_cache = m_mesh_cache.get(), texture_cache = m_texture_cache.get(), model_path, flip_uvs,
+                          occluder = occluder_config(name)] {
+                          ImportedModel result = import_model(*mesh_cache, model_path, flip_uvs, occluder);
+                          std::unordered_set<std::string> decoded;
+                          for (const auto &mesh: result.model.meshes) {
+                              for (const auto &texture_reference: mesh.textures) {
+                                  if (decoded.insert(texture_reference.path.string()).second) {
+                                      result.textures.emplace_back(texture_reference,
+                                                                   texture_cache->import(texture_reference.path, false));
+                                  }
+                              }
+                          }
+                          return result;
+                      },
+                      [this, name](ImportedModel imported) {
+                          spdlog::info("load_model(name={}, path={})", name, imported.path.string());
+                          for (auto &[texture_reference, image]: imported.textures) {
+                              auto texture_name = texture_reference.path.string();
+                              if (!m_textures[texture_name]) {
+                                  create_texture(texture_name, image, texture_reference.type);
+                              }
+                          }
+                          return create_model(name, std::move(imported.path), imported.model,
+                                              std::move(imported.occluder));
+                      });
+}
+
+ResourceHandle<Texture> ResourcesController::texture_async(const std::string &name,
+                                                           const std::filesystem::path &path,
+                                                           TextureType texture_type, bool flip_uvs) {
+    return load_async(name, m_textures, m_textures_in_flight, m_placeholder_texture.get(),
+                      [texture_cache = m_texture_cache.get(), path, flip_uvs] {
+                          return texture_cache->import(path, flip_uvs);
+                      },
+                      [this, name, texture_type](TextureData texture) {
+                          spdlog::info("load_texture(path={})", texture.path.string());
+                          return create_texture(name, texture, texture_type);
+                      });
+}
+
+ResourceHandle<Skybox> ResourcesController::skybox_async(const std::string &name,
+                                                         const std::filesystem::path &path, bool flip_uvs) {
+    return load_async(name, m_sky_boxes, m_sky_boxes_in_flight, m_placeholder_skybox.get(),
+                      [path, flip_uvs] {
+                          RG_GUARANTEE(std::filesystem::is_directory(path),
+                                       "Skybox '{}' must be a directory that contains the cubemap textures named: right, left, top, bottom, front, back.",
+                                       path.string());
+                          std::vector<ImageData> faces;
+                          for (const auto &face: std::filesystem::directory_iterator(path)) {
+                              faces.emplace_back(load_image(absolute(face.path()), flip_uvs));
+                          }
+                          return faces;
+                      },
+                      [this, name, path](std::vector<ImageData> faces) {
+                          spdlog::info("load_skybox(path={})", path.string());
+                          auto &result = m_sky_boxes[name];
+                          result = std::make_unique<Skybox>(Skybox(graphics::OpenGL::init_skybox_cube(),
+                                                                   graphics::OpenGL::load_skybox_textures(faces),
+                                                                   path, name));
+                          return result.get();
+                      });
+}
+
+ResourceHandle<Shader> ResourcesController::shader_async(const std::string &name, const std::filesystem::path &path) {
+    return load_async(name, m_shaders, m_shaders_in_flight, m_placeholder_shader.get(),
+                      [path] {
+                          if (!exists(path)) {
+                              throw util::EngineError(util::EngineError::Type::FileNotFound,
+                                                      std::format("Shader source file {} not found.", path.string()));
+                          }
+                          return util::read_text_file(path);
+                      },
+                      [this, name, path](std::string source) {
+                          spdlog::info("load_shader(path={})", path.string());
+                          auto &result = m_shaders[name];
+                          result = std::make_unique<Shader>(
+                                  ShaderCompiler::compile_from_source(name, std::move(source), path));
+                          return result.get();
+                      });
 }
 
-void ResourcesController::load_shaders() {
+std::string_view to_string(LoadState state) {
+    switch (state) {
+        case LoadState::Pending: return "Pending";
+        case LoadState::Ready: return "Ready";
+        case LoadState::Failed: return "Failed";
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled LoadState");
+    }
+}
+
+void ResourcesController::load_shaders(core::JobSystem &jobs, PendingLoads &pending) {
     if (!exists(m_shaders_path)) {
         spdlog::info("[ResourcesController]: no {} found to load the shaders from", m_shaders_path.string());
         return;
@@ -28,11 +368,13 @@ void ResourcesController::load_shaders() {
         const auto name = shader_path.path()
                                      .stem()
                                      .string();
-        shader(name, shader_path);
+        pending.shaders.emplace_back(name, shader_path.path(), jobs.submit([path = shader_path.path()] {
+            return util::read_text_file(path);
+        }));
     }
 }
 
-void ResourcesController::load_models() {
+void ResourcesController::load_models(core::JobSystem &jobs, PendingLoads &pending) {
     if (!exists(m_models_path)) {
         spdlog::info("[ResourcesController]: no {} found to load the models from", m_models_path.string());
         return;
@@ -43,102 +385,158 @@ void ResourcesController::load_models() {
                                 "No configuration for models in the config.json, please provide the resources config. See the example in the README.md");
     }
     for (const auto &model_entry: config["resources"]["models"].items()) {
-        model(model_entry.key());
+        auto [model_path, flip_uvs] = model_config(model_entry.key());
+        spdlog::info("load_model(name={}, path={})", model_entry.key(), model_path.string());
+        pending.models.emplace_back(model_entry.key(), model_path, jobs.submit([mesh_cache = m_mesh_cache.get(), model_path, flip_uvs,
+                                                                                   occluder = occluder_config(model_entry.key())] {
+            return import_model(*mesh_cache, model_path, flip_uvs, occluder);
+        }));
     }
 }
 
-void ResourcesController::load_textures() {
+void ResourcesController::load_textures(core::JobSystem &jobs, PendingLoads &pending) {
     if (!exists(m_textures_path)) {
         spdlog::info("[ResourcesController]: no {} found to load the textures from", m_textures_path.string());
         return;
     }
     for (const auto &texture_entry: std::filesystem::directory_iterator(m_textures_path)) {
-        texture(texture_entry.path()
-                             .stem()
-                             .string(), texture_entry.path());
+        pending.textures.emplace_back(texture_entry.path()
+                                                   .stem()
+                                                   .string(), texture_entry.path(),
+                                      jobs.submit([texture_cache = m_texture_cache.get(), path = texture_entry.path()] {
+                                          return texture_cache->import(path, false);
+                                      }));
     }
 }
 
-void ResourcesController::load_skyboxes() {
+void ResourcesController::load_skyboxes(core::JobSystem &jobs, PendingLoads &pending) {
     if (!exists(m_skyboxes_path)) {
         spdlog::info("[ResourcesController]: no {} found to load the skyboxes from", m_skyboxes_path.string());
         return;
     }
     for (const auto &sky_boxes_entry: std::filesystem::directory_iterator(m_skyboxes_path)) {
-        skybox(sky_boxes_entry.path()
-                              .stem()
-                              .string(), sky_boxes_entry.path());
+        RG_GUARANTEE(std::filesystem::is_directory(sky_boxes_entry.path()),
+                     "Skybox '{}' must be a directory that contains the cubemap textures named: right, left, top, bottom, front, back.",
+                     sky_boxes_entry.path().string());
+        std::vector<std::future<ImageData> > faces;
+        for (const auto &face: std::filesystem::directory_iterator(sky_boxes_entry.path())) {
+            faces.emplace_back(jobs.submit([path = absolute(face.path())] {
+                return load_image(path, false);
+            }));
+        }
+        pending.skyboxes.emplace_back(sky_boxes_entry.path()
+                                                     .stem()
+                                                     .string(), sky_boxes_entry.path(), std::move(faces));
     }
 }
 
-/**
- * @class AssimpSceneProcessor
- * @brief Processes the meshes in an Assimp scene.
- */
-class AssimpSceneProcessor {
-public:
-    /**
-     * @brief Processes the meshes in the scene.
-     * @returns The meshes in the scene.
-     */
-    std::vector<Mesh> process_meshes();
-
-    explicit AssimpSceneProcessor(ResourcesController *resources_controller, const aiScene *scene,
-                                  std::filesystem::path model_path) :
-            m_scene(scene), m_model_path(std::move(model_path)), m_resources_controller(resources_controller) {
+void ResourcesController::finish_loading(core::JobSystem &jobs, PendingLoads &pending) {
+    // Shaders compile on the main thread while the workers are still decoding.
+    for (auto &shader_load: pending.shaders) {
+        spdlog::info("load_shader(path={})", shader_load.path.string());
+        m_shaders[shader_load.name] = std::make_unique<Shader>(
+                ShaderCompiler::compile_from_source(shader_load.name, shader_load.result.get(), shader_load.path));
     }
 
-private:
-    void process_node(const aiNode *node);
+    std::vector<ImportedModel> models;
+    std::unordered_map<std::string, std::pair<TextureType, std::future<TextureData> > > model_textures;
+    for (auto &model_load: pending.models) {
+        auto &imported = models.emplace_back(model_load.result.get());
+        for (const auto &mesh: imported.model.meshes) {
+            for (const auto &texture_reference: mesh.textures) {
+                auto name = texture_reference.path.string();
+                if (!m_textures.contains(name) && !model_textures.contains(name)) {
+                    model_textures.emplace(name, std::pair(texture_reference.type,
+                                                           jobs.submit([texture_cache = m_texture_cache.get(),
+                                                                           path = texture_reference.path] {
+                                                               return texture_cache->import(path, false);
+                                                           })));
+                }
+            }
+        }
+    }
 
-    void process_mesh(aiMesh *mesh);
+    for (auto &texture_load: pending.textures) {
+        spdlog::info("load_texture(path={})", texture_load.path.string());
+        create_texture(texture_load.name, texture_load.result.get(), TextureType::Regular);
+    }
 
-    std::vector<Texture *> process_materials(const aiMaterial *material);
+    for (auto &skybox_load: pending.skyboxes) {
+        spdlog::info("load_skybox(path={})", skybox_load.path.string());
+        std::vector<ImageData> faces;
+        for (auto &face: skybox_load.faces) {
+            faces.emplace_back(face.get());
+        }
+        m_sky_boxes[skybox_load.name] = std::make_unique<Skybox>(Skybox(graphics::OpenGL::init_skybox_cube(),
+                                                                        graphics::OpenGL::load_skybox_textures(faces),
+                                                                        skybox_load.path, skybox_load.name));
+    }
 
-    void process_material_type(std::vector<Texture *> &textures, const aiMaterial *material, aiTextureType type);
+    for (auto &[name, texture_load]: model_textures) {
+        spdlog::info("load_texture(path={})", name);
+        create_texture(name, texture_load.second.get(), texture_load.first);
+    }
+    for (size_t i = 0; i < models.size(); ++i) {
+        create_model(pending.models[i].name, pending.models[i].path, models[i].model, std::move(models[i].occluder));
+    }
+}
 
-    static TextureType assimp_texture_type_to_engine(aiTextureType type);
+std::pair<std::filesystem::path, bool> ResourcesController::model_config(const std::string &name) const {
+    auto &config = util::Configuration::config();
+    if (!config["resources"]["models"].contains(name)) {
+        throw util::EngineError(util::EngineError::Type::ConfigurationError, std::format(
+                "No model ({}) specify in config.json. Please add the model to the config.json.",
+                name));
+    }
+    std::filesystem::path model_path = m_models_path /
+                                       std::filesystem::path(
+                                               config["resources"]["models"][name]["path"].get<
+                                                       std::string>());
+    bool flip_uvs = config["resources"]["models"][name].value<bool>("flip_uvs", false);
+    return {model_path, flip_uvs};
+}
 
-    std::vector<Mesh> m_meshes;
-    const aiScene *m_scene;
-    std::filesystem::path m_model_path;
-    ResourcesController *m_resources_controller;
-};
+std::optional<OccluderConfig> ResourcesController::occluder_config(const std::string &name) const {
+    const auto &model_config = util::Configuration::config()["resources"]["models"][name];
+    if (!model_config.value<bool>("occluder", false) && !model_config.contains("occluder_nodes")) {
+        return std::nullopt;
+    }
+    OccluderConfig result;
+    result.grid = model_config.value<uint32_t>("occluder_grid", 16);
+    result.nodes = model_config.value<std::vector<std::string> >("occluder_nodes", {});
+    return result;
+}
 
 Model *ResourcesController::model(
         const std::string &name) {
     auto &result = m_models[name];
     if (!result) {
-        auto &config = util::Configuration::config();
-        if (!config["resources"]["models"].contains(name)) {
-            throw util::EngineError(util::EngineError::Type::ConfigurationError, std::format(
-                    "No model ({}) specify in config.json. Please add the model to the config.json.",
-                    name));
-        }
-        std::filesystem::path model_path = m_models_path /
-                                           std::filesystem::path(
-                                                   config["resources"]["models"][name]["path"].get<
-                                                           std::string>());
-        Assimp::Importer importer;
-        int flags = aiProcess_Triangulate | aiProcess_GenSmoothNormals |
-                    aiProcess_CalcTangentSpace;
-        if (config["resources"]["models"][name].value<bool>("flip_uvs", false)) {
-            flags |= aiProcess_FlipUVs;
-        }
-
+        auto [model_path, flip_uvs] = model_config(name);
         spdlog::info("load_model(name={}, path={})", name, model_path.string());
-        const aiScene *scene =
-                importer.ReadFile(model_path, flags);
+        auto imported = import_model(*m_mesh_cache, model_path, flip_uvs, occluder_config(name));
+        return create_model(name, model_path, imported.model, std::move(imported.occluder));
+    }
+    return result.get();
+}
 
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-            throw util::EngineError(util::EngineError::Type::AssetLoadingError,
-                                    std::format("Assimp error while reading model: {} from path {}.",
-                                                model_path.string(), name));
+Model *ResourcesController::create_model(const std::string &name, std::filesystem::path path,
+                                         const ModelData &model, std::optional<graphics::OccluderMesh> occluder) {
+    std::vector<Mesh> result_meshes;
+    result_meshes.reserve(model.meshes.size());
+    for (const auto &mesh: model.meshes) {
+        std::vector<Texture *> textures;
+        textures.reserve(mesh.textures.size());
+        for (const auto &texture_reference: mesh.textures) {
+            textures.emplace_back(texture(texture_reference.path.string(), texture_reference.path,
+                                          texture_reference.type));
         }
-        AssimpSceneProcessor scene_processor(this, scene, model_path);
-        std::vector<Mesh> meshes = scene_processor.process_meshes();
-        result = std::make_unique<Model>(Model(std::move(meshes), model_path,
-                                               name));
+        result_meshes.emplace_back(Mesh(mesh.vertices, mesh.indices, std::move(textures), mesh.bounds));
+    }
+    auto &result = m_models[name];
+    result = std::make_unique<Model>(Model(std::move(result_meshes), model.nodes, std::move(path), name));
+    if (occluder) {
+        spdlog::info("Model {}: occluder proxy of {} triangles.", name, occluder->triangle_count());
+        result->m_occluder = std::move(occluder);
     }
     return result.get();
 }
@@ -149,12 +547,25 @@ Texture *ResourcesController::texture(const std::string &name,
     auto &result = m_textures[name];
     if (!result) {
         spdlog::info("load_texture(path={})", path.string());
-        result = std::make_unique<Texture>(Texture(graphics::OpenGL::generate_texture(path, flip_uvs), type, path,
-                                                   path.stem()));
+        return create_texture(name, m_texture_cache->import(path, flip_uvs), type);
     }
     return result.get();
 }
 
+Texture *ResourcesController::create_texture(const std::string &name, const ImageData &image, TextureType type) {
+    auto &result = m_textures[name];
+    result = std::make_unique<Texture>(Texture(graphics::OpenGL::generate_texture(image), type, image.path,
+                                               image.path.stem()));
+    return result.get();
+}
+
+Texture *ResourcesController::create_texture(const std::string &name, const TextureData &texture, TextureType type) {
+    auto &result = m_textures[name];
+    result = std::make_unique<Texture>(Texture(graphics::OpenGL::generate_texture(texture), type, texture.path,
+                                               texture.path.stem()));
+    return result.get();
+}
+
 Skybox *ResourcesController::skybox(const std::string &name,
                                     const std::filesystem::path &path,
                                     bool flip_uvs) {
@@ -177,117 +588,4 @@ Shader *ResourcesController::shader(const std::string &name, const std::filesyst
     return result.get();
 }
 
-std::vector<Mesh> AssimpSceneProcessor::process_meshes() {
-    m_meshes.clear();
-    process_node(m_scene->mRootNode);
-    return std::move(m_meshes);
-}
-
-void AssimpSceneProcessor::process_node(const aiNode *node) {
-    for (uint32_t i = 0; i < node->mNumMeshes; ++i) {
-        auto mesh = m_scene->mMeshes[node->mMeshes[i]];
-        process_mesh(mesh);
-    }
-    for (uint32_t i = 0; i < node->mNumChildren; ++i) {
-        process_node(node->mChildren[i]);
-    }
-}
-
-void AssimpSceneProcessor::process_mesh(aiMesh *mesh) {
-    std::vector<Vertex> vertices;
-    vertices.reserve(mesh->mNumVertices);
-    for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
-        Vertex vertex{};
-        vertex.Position
-              .x = mesh->mVertices[i].x;
-        vertex.Position
-              .y = mesh->mVertices[i].y;
-        vertex.Position
-              .z = mesh->mVertices[i].z;
-
-        if (mesh->HasNormals()) {
-            vertex.Normal
-                  .x = mesh->mNormals[i].x;
-            vertex.Normal
-                  .y = mesh->mNormals[i].y;
-            vertex.Normal
-                  .z = mesh->mNormals[i].z;
-        }
-
-        if (mesh->mTextureCoords[0]) {
-            vertex.TexCoords
-                  .x = mesh->mTextureCoords[0][i].x;
-            vertex.TexCoords
-                  .y = mesh->mTextureCoords[0][i].y;
-
-            vertex.Tangent
-                  .x = mesh->mTangents[i].x;
-            vertex.Tangent
-                  .y = mesh->mTangents[i].y;
-            vertex.Tangent
-                  .z = mesh->mTangents[i].z;
-
-            vertex.Bitangent
-                  .x = mesh->mBitangents[i].x;
-            vertex.Bitangent
-                  .y = mesh->mBitangents[i].y;
-            vertex.Bitangent
-                  .z = mesh->mBitangents[i].z;
-        }
-        vertices.push_back(vertex);
-    }
-
-    std::vector<uint32_t> indices;
-    for (uint32_t i = 0; i < mesh->mNumFaces; ++i) {
-        aiFace face = mesh->mFaces[i];
-
-        for (uint32_t j = 0; j < face.mNumIndices; ++j) {
-            indices.push_back(face.mIndices[j]);
-        }
-    }
-
-    auto material = m_scene->mMaterials[mesh->mMaterialIndex];
-    std::vector<Texture *> textures = process_materials(material);
-    m_meshes.emplace_back(Mesh(vertices, indices, std::move(textures)));
-}
-
-std::vector<Texture *> AssimpSceneProcessor::process_materials(const aiMaterial *material) {
-    std::vector<Texture *> textures;
-    auto ai_texture_types = {
-            aiTextureType_DIFFUSE,
-            aiTextureType_SPECULAR,
-            aiTextureType_NORMALS,
-            aiTextureType_HEIGHT,
-    };
-
-    for (auto ai_texture_type: ai_texture_types) {
-        process_material_type(textures, material, ai_texture_type);
-    }
-    return textures;
-}
-
-void AssimpSceneProcessor::process_material_type(std::vector<Texture *> &textures, const aiMaterial *material,
-                                                 aiTextureType type) {
-    auto material_count = material->GetTextureCount(type);
-    for (uint32_t i = 0; i < material_count; ++i) {
-        aiString ai_texture_path_string;
-        material->GetTexture(type, i, &ai_texture_path_string);
-        std::filesystem::path texture_path = m_model_path.parent_path() / ai_texture_path_string.C_Str();
-        Texture *texture = m_resources_controller->texture(texture_path.string(), texture_path,
-                                                           assimp_texture_type_to_engine(type));
-        textures.emplace_back(texture);
-    }
-}
-
-TextureType AssimpSceneProcessor::assimp_texture_type_to_engine(aiTextureType type) {
-    switch (type) {
-        case aiTextureType_DIFFUSE: return TextureType::Diffuse;
-        case aiTextureType_SPECULAR: return TextureType::Specular;
-        case aiTextureType_HEIGHT: return TextureType::Height;
-        case aiTextureType_NORMALS: return TextureType::Normal;
-        default: RG_SHOULD_NOT_REACH_HERE("Engine currently doesn't support the aiTextureType: {}",
-                                          static_cast<int>(type));
-    }
-}
-
 } // namespace engine
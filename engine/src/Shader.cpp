@@ -1,64 +1,160 @@
 #include <glad/glad.h>
+#include <algorithm>
+#include <format>
 #include <engine/resources/Shader.hpp>
 #include <engine/graphics/OpenGL.hpp>
+#include <engine/resources/Mesh.hpp>
 
 namespace engine::resources {
 
 void Shader::use() const {
-    glUseProgram(m_shaderId);
+    graphics::OpenGL::use_program(m_shaderId);
 }
 
 void Shader::destroy() const {
     glDeleteProgram(m_shaderId);
+    graphics::OpenGL::invalidate_state_cache();
 }
 
 unsigned Shader::id() const {
     return m_shaderId;
 }
 
-void Shader::set_bool(const std::string &name, bool value) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniform1i, location, static_cast<int>(value));
+UniformHandle Shader::uniform(std::string_view name) const {
+    auto it = std::lower_bound(m_uniforms.begin(), m_uniforms.end(), name,
+                               [](const ActiveUniform &uniform, std::string_view name) {
+                                   return uniform.name < name;
+                               });
+    if (it == m_uniforms.end() || it->name != name) {
+        return UniformHandle();
+    }
+    return UniformHandle(it->location);
 }
 
-void Shader::set_int(const std::string &name, int value) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniform1i, location, value);
+void Shader::introspect_uniforms() {
+    int32_t number_of_uniforms = 0;
+    int32_t max_name_length = 0;
+    CHECKED_GL_CALL(glGetProgramiv, m_shaderId, GL_ACTIVE_UNIFORMS, &number_of_uniforms);
+    CHECKED_GL_CALL(glGetProgramiv, m_shaderId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+    std::string name_buffer(max_name_length, '\0');
+    for (int32_t i = 0; i < number_of_uniforms; ++i) {
+        int32_t name_length = 0;
+        int32_t size = 0;
+        uint32_t type = 0;
+        CHECKED_GL_CALL(glGetActiveUniform, m_shaderId, i, max_name_length, &name_length, &size, &type,
+                        name_buffer.data());
+        std::string name(name_buffer.data(), name_length);
+        const int32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
+        if (location == -1) {
+            // Members of the uniform blocks don't have a location.
+            continue;
+        }
+        // Arrays are reported once as "name[0]"; register the bare name and every element.
+        if (name.ends_with("[0]")) {
+            name.resize(name.size() - 3);
+            for (int32_t element = 0; element < size; ++element) {
+                std::string element_name = std::format("{}[{}]", name, element);
+                const int32_t element_location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId,
+                                                                 element_name.c_str());
+                m_uniforms.emplace_back(std::move(element_name), element_location, type, 1);
+            }
+        }
+        m_uniforms.emplace_back(std::move(name), location, type, size);
+    }
+    std::sort(m_uniforms.begin(), m_uniforms.end(), [](const ActiveUniform &lhs, const ActiveUniform &rhs) {
+        return lhs.name < rhs.name;
+    });
 }
 
-void Shader::set_float(const std::string &name, float value) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniform1f, location, value);
+void Shader::introspect_attributes() {
+    int32_t number_of_attributes = 0;
+    int32_t max_name_length = 0;
+    CHECKED_GL_CALL(glGetProgramiv, m_shaderId, GL_ACTIVE_ATTRIBUTES, &number_of_attributes);
+    CHECKED_GL_CALL(glGetProgramiv, m_shaderId, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_name_length);
+    std::string name_buffer(max_name_length, '\0');
+    for (int32_t i = 0; i < number_of_attributes; ++i) {
+        int32_t name_length = 0;
+        int32_t size = 0;
+        uint32_t type = 0;
+        CHECKED_GL_CALL(glGetActiveAttrib, m_shaderId, i, max_name_length, &name_length, &size, &type,
+                        name_buffer.data());
+        const int32_t location = CHECKED_GL_CALL(glGetAttribLocation, m_shaderId, name_buffer.c_str());
+        if (type == GL_FLOAT_MAT4 && location == static_cast<int32_t>(Mesh::INSTANCE_MODEL_LOCATION)) {
+            m_reads_instance_model = true;
+        }
+    }
 }
 
-void Shader::set_vec2(const std::string &name, const glm::vec2 &value) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniform2fv, location, 1, &value[0]);
+void Shader::set_bool(std::string_view name, bool value) const {
+    set_bool(uniform(name), value);
 }
 
-void Shader::set_vec3(const std::string &name, const glm::vec3 &value) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniform3fv, location, 1, &value[0]);
+void Shader::set_bool(UniformHandle uniform, bool value) const {
+    CHECKED_GL_CALL(glUniform1i, uniform.location(), static_cast<int>(value));
 }
 
-void Shader::set_vec4(const std::string &name, const glm::vec4 &value) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniform4fv, location, 1, &value[0]);
+void Shader::set_int(std::string_view name, int value) const {
+    set_int(uniform(name), value);
 }
 
-void Shader::set_mat2(const std::string &name, const glm::mat2 &mat) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniformMatrix2fv, location, 1, GL_FALSE, &mat[0][0]);
+void Shader::set_int(UniformHandle uniform, int value) const {
+    CHECKED_GL_CALL(glUniform1i, uniform.location(), value);
 }
 
-void Shader::set_mat3(const std::string &name, const glm::mat3 &mat) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniformMatrix3fv, location, 1, GL_FALSE, &mat[0][0]);
+void Shader::set_float(std::string_view name, float value) const {
+    set_float(uniform(name), value);
 }
 
-void Shader::set_mat4(const std::string &name, const glm::mat4 &mat) const {
-    uint32_t location = CHECKED_GL_CALL(glGetUniformLocation, m_shaderId, name.c_str());
-    CHECKED_GL_CALL(glUniformMatrix4fv, location, 1, GL_FALSE, &mat[0][0]);
+void Shader::set_float(UniformHandle uniform, float value) const {
+    CHECKED_GL_CALL(glUniform1f, uniform.location(), value);
+}
+
+void Shader::set_vec2(std::string_view name, const glm::vec2 &value) const {
+    set_vec2(uniform(name), value);
+}
+
+void Shader::set_vec2(UniformHandle uniform, const glm::vec2 &value) const {
+    CHECKED_GL_CALL(glUniform2fv, uniform.location(), 1, &value[0]);
+}
+
+void Shader::set_vec3(std::string_view name, const glm::vec3 &value) const {
+    set_vec3(uniform(name), value);
+}
+
+void Shader::set_vec3(UniformHandle uniform, const glm::vec3 &value) const {
+    CHECKED_GL_CALL(glUniform3fv, uniform.location(), 1, &value[0]);
+}
+
+void Shader::set_vec4(std::string_view name, const glm::vec4 &value) const {
+    set_vec4(uniform(name), value);
+}
+
+void Shader::set_vec4(UniformHandle uniform, const glm::vec4 &value) const {
+    CHECKED_GL_CALL(glUniform4fv, uniform.location(), 1, &value[0]);
+}
+
+void Shader::set_mat2(std::string_view name, const glm::mat2 &mat) const {
+    set_mat2(uniform(name), mat);
+}
+
+void Shader::set_mat2(UniformHandle uniform, const glm::mat2 &mat) const {
+    CHECKED_GL_CALL(glUniformMatrix2fv, uniform.location(), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::set_mat3(std::string_view name, const glm::mat3 &mat) const {
+    set_mat3(uniform(name), mat);
+}
+
+void Shader::set_mat3(UniformHandle uniform, const glm::mat3 &mat) const {
+    CHECKED_GL_CALL(glUniformMatrix3fv, uniform.location(), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::set_mat4(std::string_view name, const glm::mat4 &mat) const {
+    set_mat4(uniform(name), mat);
+}
+
+void Shader::set_mat4(UniformHandle uniform, const glm::mat4 &mat) const {
+    CHECKED_GL_CALL(glUniformMatrix4fv, uniform.location(), 1, GL_FALSE, &mat[0][0]);
 }
 
 Shader::Shader(unsigned shader_id, std::string name, std::string source, std::filesystem::path source_path) :
@@ -66,6 +162,8 @@ Shader::Shader(unsigned shader_id, std::string name, std::string source, std::fi
         , m_name(std::move(name))
         , m_source(std::move(source))
         , m_source_path(std::move(source_path)) {
+    introspect_uniforms();
+    introspect_attributes();
 }
 
 }
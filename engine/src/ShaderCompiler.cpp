@@ -3,6 +3,7 @@
 #include <engine/util/Errors.hpp>
 #include <format>
 #include <spdlog/spdlog.h>
+#include <engine/graphics/FrameUniforms.hpp>
 #include <engine/graphics/OpenGL.hpp>
 
 namespace engine::resources {
@@ -10,17 +11,27 @@ using namespace graphics;
 
 int to_opengl_type(ShaderType type);
 
-Shader ShaderCompiler::compile_from_source(std::string shader_name, std::string shader_source) {
+Shader ShaderCompiler::compile_from_source(std::string shader_name, std::string shader_source,
+                                           std::filesystem::path shader_path) {
     spdlog::info("ShaderCompiler::Compiling: {}", shader_name);
     ShaderCompiler compiler(std::move(shader_name), std::move(shader_source));
     ShaderParsingResult parsing_result = compiler.parse_source();
     OpenGL::ShaderProgramId shader_program = compiler.compile(parsing_result);
-    Shader result(shader_program, shader_name, shader_source, "");
+    Shader result(shader_program, std::move(compiler.m_shader_name), std::move(compiler.m_sources),
+                  std::move(shader_path));
     return result;
 }
 
 OpenGL::ShaderProgramId ShaderCompiler::compile(const ShaderParsingResult &shader_sources) {
     uint32_t shader_program_id = glCreateProgram();
+    if (!shader_sources.compute_shader
+                       .empty()) {
+        const uint32_t compute_shader_id = compile(shader_sources.compute_shader, ShaderType::Compute);
+        glAttachShader(shader_program_id, compute_shader_id);
+        glLinkProgram(shader_program_id);
+        glDeleteShader(compute_shader_id);
+        return shader_program_id;
+    }
     uint32_t vertex_shader_id = 0;
     uint32_t fragment_shader_id = 0;
     uint32_t geometry_shader_id = 0;
@@ -41,6 +52,12 @@ OpenGL::ShaderProgramId ShaderCompiler::compile(const ShaderParsingResult &shade
         glAttachShader(shader_program_id, geometry_shader_id);
     }
     glLinkProgram(shader_program_id);
+
+    const uint32_t frame_uniforms_block = glGetUniformBlockIndex(shader_program_id,
+                                                                 FrameUniforms::BLOCK_NAME.data());
+    if (frame_uniforms_block != GL_INVALID_INDEX) {
+        glUniformBlockBinding(shader_program_id, frame_uniforms_block, FrameUniforms::BINDING);
+    }
     return shader_program_id;
 }
 
@@ -68,6 +85,18 @@ ShaderParsingResult ShaderCompiler::parse_source() {
             current_shader->push_back('\n');
         }
     }
+    if (!parsing_result.compute_shader
+                       .empty()) {
+        if (!parsing_result.vertex_shader
+                           .empty() || !parsing_result.fragment_shader
+                                                      .empty() || !parsing_result.geometry_shader
+                                                                                 .empty()) {
+            throw util::EngineError(util::EngineError::Type::ShaderCompilationError, std::format(
+                    "Error compiling: {}. A compute shader can't be in the same source with the other shaders.",
+                    m_shader_name));
+        }
+        return parsing_result;
+    }
     if (parsing_result.vertex_shader
                       .empty() || parsing_result.fragment_shader
                                                 .empty()) {
@@ -86,12 +115,7 @@ Shader ShaderCompiler::compile_from_file(std::string shader_name,
                                             shader_path.string(),
                                             shader_name));
     }
-    std::string shader_source = util::read_text_file(shader_path);
-    ShaderCompiler compiler(std::move(shader_name), std::move(shader_source));
-    ShaderParsingResult parsing_result = compiler.parse_source();
-    OpenGL::ShaderProgramId shader_program = compiler.compile(parsing_result);
-    Shader result(shader_program, shader_name, shader_source, shader_path);
-    return result;
+    return compile_from_source(std::move(shader_name), util::read_text_file(shader_path), shader_path);
 }
 
 std::string *ShaderCompiler::now_parsing(ShaderParsingResult &result, const std::string &line) {
@@ -104,9 +128,12 @@ std::string *ShaderCompiler::now_parsing(ShaderParsingResult &result, const std:
     if (line.ends_with(to_string(ShaderType::Geometry))) {
         return &result.geometry_shader;
     }
-    RG_SHOULD_NOT_REACH_HERE("Unknown type of shader prefix: {}. Did you mean: #shader {}|{}|{}", line,
+    if (line.ends_with(to_string(ShaderType::Compute))) {
+        return &result.compute_shader;
+    }
+    RG_SHOULD_NOT_REACH_HERE("Unknown type of shader prefix: {}. Did you mean: #shader {}|{}|{}|{}", line,
                              to_string(ShaderType::Vertex), to_string(ShaderType::Fragment),
-                             to_string(ShaderType::Geometry));
+                             to_string(ShaderType::Geometry), to_string(ShaderType::Compute));
 }
 
 std::string_view to_string(ShaderType type) {
@@ -114,6 +141,7 @@ std::string_view to_string(ShaderType type) {
         case ShaderType::Vertex: return "vertex";
         case ShaderType::Fragment: return "fragment";
         case ShaderType::Geometry: return "geometry";
+        case ShaderType::Compute: return "compute";
         default: RG_SHOULD_NOT_REACH_HERE("Unhandled shader type");
     }
 }
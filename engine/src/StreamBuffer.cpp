@@ -0,0 +1,173 @@
+#include <glad/glad.h>
+#include <algorithm>
+#include <utility>
+#include <engine/graphics/OpenGL.hpp>
+#include <engine/graphics/StreamBuffer.hpp>
+#include <engine/util/Errors.hpp>
+#include <engine/util/Profiler.hpp>
+#include <engine/util/Utils.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::graphics {
+// OpenGL 4.3/4.4, not in the 3.3 core glad.
+static constexpr GLbitfield MAP_PERSISTENT_BIT = 0x0040;
+static constexpr GLbitfield MAP_COHERENT_BIT = 0x0080;
+static constexpr GLenum SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT = 0x90DF;
+
+using BufferStorageFunction = void (APIENTRYP)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+static BufferStorageFunction g_buffer_storage = nullptr;
+
+void StreamBuffer::initialize(size_t frame_capacity, bool persistent) {
+    GLint alignment = 0;
+    CHECKED_GL_CALL(glGetIntegerv, GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_uniform_alignment = std::max<size_t>(alignment, 16);
+    if (OpenGL::is_version_at_least(4, 3) || OpenGL::has_extension("GL_ARB_shader_storage_buffer_object")) {
+        CHECKED_GL_CALL(glGetIntegerv, SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        m_storage_alignment = std::max<size_t>(alignment, 16);
+    }
+    if (OpenGL::is_version_at_least(4, 4) || OpenGL::has_extension("GL_ARB_buffer_storage")) {
+        g_buffer_storage = OpenGL::load_function<BufferStorageFunction>("glBufferStorage");
+    }
+    m_persistent = persistent && g_buffer_storage != nullptr;
+    create(util::align_up(frame_capacity, std::max(m_uniform_alignment, m_storage_alignment)));
+    spdlog::info("StreamBuffer: {} KiB per frame, {}", m_frame_capacity / 1024,
+                 m_persistent ? "persistent mapped" : "orphaned with glBufferData");
+}
+
+void StreamBuffer::create(size_t frame_capacity) {
+    m_frame_capacity = frame_capacity;
+    CHECKED_GL_CALL(glGenBuffers, 1, &m_buffer);
+    OpenGL::bind_buffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    if (m_persistent) {
+        const size_t size = m_frame_capacity * FRAMES_IN_FLIGHT;
+        const GLbitfield flags = GL_MAP_WRITE_BIT | MAP_PERSISTENT_BIT | MAP_COHERENT_BIT;
+        CHECKED_GL_CALL(g_buffer_storage, GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, flags);
+        m_mapped = static_cast<std::byte *>(CHECKED_GL_CALL(glMapBufferRange, GL_COPY_WRITE_BUFFER, 0,
+                                                            static_cast<GLsizeiptr>(size), flags));
+        RG_GUARANTEE(m_mapped != nullptr, "Failed to map the StreamBuffer.");
+    } else {
+        CHECKED_GL_CALL(glBufferData, GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(m_frame_capacity), nullptr,
+                        GL_STREAM_DRAW);
+        m_shadow = std::make_unique<std::byte[]>(m_frame_capacity);
+    }
+}
+
+void StreamBuffer::terminate() {
+    for (auto &fence: m_fences) {
+        if (fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+            fence = nullptr;
+        }
+    }
+    for (auto &retired: m_retired) {
+        if (retired.fence) {
+            glDeleteSync(static_cast<GLsync>(retired.fence));
+        }
+        // Deleting a buffer unmaps it.
+        glDeleteBuffers(1, &retired.buffer);
+    }
+    m_retired.clear();
+    if (m_buffer) {
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+    m_mapped = nullptr;
+    m_shadow.reset();
+    OpenGL::invalidate_state_cache();
+}
+
+void StreamBuffer::begin_frame() {
+    delete_finished_retired_buffers();
+    m_frame = (m_frame + 1) % FRAMES_IN_FLIGHT;
+    m_offset = 0;
+    if (!m_persistent) {
+        // Orphan the storage: the draws of the previous frames keep the old one, this frame gets a fresh one.
+        OpenGL::bind_buffer(GL_COPY_WRITE_BUFFER, m_buffer);
+        CHECKED_GL_CALL(glBufferData, GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(m_frame_capacity), nullptr,
+                        GL_STREAM_DRAW);
+        return;
+    }
+    auto fence = static_cast<GLsync>(std::exchange(m_fences[m_frame], nullptr));
+    if (!fence) {
+        return;
+    }
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        RG_PROFILE_SCOPE("StreamBuffer", "wait for the GPU");
+        ++m_stalls;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    RG_GUARANTEE(status != GL_WAIT_FAILED, "Waiting for the StreamBuffer fence failed.");
+}
+
+void StreamBuffer::end_frame() {
+    if (m_persistent) {
+        m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    for (auto &retired: m_retired) {
+        if (!retired.fence) {
+            retired.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    }
+}
+
+StreamAllocation StreamBuffer::allocate(size_t size, size_t alignment) {
+    RG_GUARANTEE(alignment != 0 && (alignment & (alignment - 1)) == 0, "Alignment {} isn't a power of two.",
+                 alignment);
+    size_t offset = util::align_up(region_begin() + m_offset, alignment) - region_begin();
+    if (offset + size > m_frame_capacity) {
+        grow(std::max<size_t>(m_frame_capacity * 2, util::align_up(size + alignment, m_uniform_alignment)));
+        offset = util::align_up(region_begin(), alignment) - region_begin();
+    }
+    m_offset = offset + size;
+    StreamAllocation allocation;
+    allocation.buffer = m_buffer;
+    allocation.offset = region_begin() + offset;
+    allocation.size = size;
+    allocation.data = m_persistent ? m_mapped + allocation.offset : m_shadow.get() + offset;
+    return allocation;
+}
+
+void StreamBuffer::commit(const StreamAllocation &allocation) {
+    if (m_persistent || allocation.size == 0) {
+        return;
+    }
+    OpenGL::bind_buffer(GL_COPY_WRITE_BUFFER, allocation.buffer);
+    CHECKED_GL_CALL(glBufferSubData, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(allocation.offset),
+                    static_cast<GLsizeiptr>(allocation.size), allocation.data);
+}
+
+void StreamBuffer::grow(size_t frame_capacity) {
+    spdlog::info("StreamBuffer: growing from {} to {} KiB per frame.", m_frame_capacity / 1024,
+                 frame_capacity / 1024);
+    // The draws issued in this frame, and in the previous frames, still read the old buffer.
+    m_retired.push_back(RetiredBuffer{m_buffer, nullptr, std::move(m_shadow)});
+    for (auto &fence: m_fences) {
+        if (fence) {
+            glDeleteSync(static_cast<GLsync>(fence));
+            fence = nullptr;
+        }
+    }
+    m_mapped = nullptr;
+    m_offset = 0;
+    create(frame_capacity);
+}
+
+void StreamBuffer::delete_finished_retired_buffers() {
+    const auto first_finished = std::partition(m_retired.begin(), m_retired.end(), [](const RetiredBuffer &retired) {
+        return !retired.fence || glClientWaitSync(static_cast<GLsync>(retired.fence), 0, 0) == GL_TIMEOUT_EXPIRED;
+    });
+    if (first_finished == m_retired.end()) {
+        return;
+    }
+    for (auto it = first_finished; it != m_retired.end(); ++it) {
+        glDeleteSync(static_cast<GLsync>(it->fence));
+        glDeleteBuffers(1, &it->buffer);
+    }
+    m_retired.erase(first_finished, m_retired.end());
+    OpenGL::invalidate_state_cache();
+}
+} // namespace engine::graphics
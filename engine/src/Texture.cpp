@@ -1,8 +1,51 @@
 #include <glad/glad.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <stb_image.h>
+#include <engine/graphics/OpenGL.hpp>
 #include <engine/resources/Texture.hpp>
 #include <engine/util/Errors.hpp>
 
 namespace engine::resources {
+void ImageData::PixelsDeleter::operator()(uint8_t *pixels) const {
+    std::free(pixels);
+}
+
+ImageData load_image(const std::filesystem::path &path, bool flip_uvs) {
+    ImageData result;
+    // stbi_set_flip_vertically_on_load is global state in this version of stb, so the images are flipped here
+    // instead, to keep the decoding safe to run on multiple threads at once.
+    result.pixels.reset(stbi_load(path.c_str(), &result.width, &result.height, &result.channels, 0));
+    if (!result.pixels) {
+        throw util::EngineError(util::EngineError::Type::AssetLoadingError,
+                                std::format("Failed to load texture {}", path.string()));
+    }
+    if (flip_uvs) {
+        const size_t row_size = static_cast<size_t>(result.width) * result.channels;
+        std::vector<uint8_t> row(row_size);
+        for (int32_t top = 0, bottom = result.height - 1; top < bottom; ++top, --bottom) {
+            uint8_t *top_row = result.pixels.get() + top * row_size;
+            uint8_t *bottom_row = result.pixels.get() + bottom * row_size;
+            std::memcpy(row.data(), top_row, row_size);
+            std::memcpy(top_row, bottom_row, row_size);
+            std::memcpy(bottom_row, row.data(), row_size);
+        }
+    }
+    result.path = path;
+    return result;
+}
+std::string_view to_string(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::Raw: return "Raw";
+        case TextureFormat::BC1: return "BC1";
+        case TextureFormat::BC3: return "BC3";
+        case TextureFormat::BC4: return "BC4";
+        case TextureFormat::BC5: return "BC5";
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled TextureFormat");
+    }
+}
+
 std::string_view texture_type_to_string(TextureType type) {
     switch (type) {
         case TextureType::Diffuse: return "Diffuse";
@@ -15,12 +58,12 @@ std::string_view texture_type_to_string(TextureType type) {
 
 void Texture::destroy() {
     glDeleteTextures(1, &m_id);
+    graphics::OpenGL::invalidate_state_cache();
 }
 
 void Texture::bind(int32_t sampler) {
     RG_GUARANTEE(sampler >= GL_TEXTURE0 && sampler <= GL_TEXTURE31, "sampler out of range");
-    glActiveTexture(sampler);
-    glBindTexture(GL_TEXTURE_2D, m_id);
+    graphics::OpenGL::bind_texture(sampler - GL_TEXTURE0, GL_TEXTURE_2D, m_id);
 }
 
 std::string_view Texture::uniform_name_convention(TextureType type) {
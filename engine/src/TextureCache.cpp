@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <engine/resources/TextureCache.hpp>
+#include <engine/resources/TextureCompressor.hpp>
+#include <engine/util/Utils.hpp>
+#include <spdlog/spdlog.h>
+
+namespace engine::resources {
+static_assert(std::endian::native == std::endian::little, "TextureCache files are stored in little-endian.");
+
+struct TextureCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;
+    uint32_t channels;
+    uint32_t level_count;
+    int64_t source_mtime;
+    uint64_t source_size;
+    uint64_t source_path_hash;
+};
+
+struct TextureCacheLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t size;
+};
+
+static_assert(sizeof(TextureCacheHeader) % 16 == 0);
+static_assert(sizeof(TextureCacheLevel) % 16 == 0);
+
+constexpr char g_texture_cache_magic[8] = {'R', 'G', 'T', 'E', 'X', 0, 0, 0};
+constexpr std::streamoff g_section_alignment = 16;
+
+static uint64_t source_path_hash(const std::filesystem::path &image_path, bool flip_uvs) {
+    return util::fnv1a(flip_uvs ? "flip" : "", util::fnv1a(image_path.lexically_normal()
+                                                                     .generic_string()));
+}
+
+static TextureCacheHeader make_header(const std::filesystem::path &image_path, bool flip_uvs) {
+    TextureCacheHeader header{};
+    std::memcpy(header.magic, g_texture_cache_magic, sizeof(header.magic));
+    header.version = TextureCache::VERSION;
+    header.source_mtime = std::filesystem::last_write_time(image_path)
+                          .time_since_epoch()
+                          .count();
+    header.source_size = std::filesystem::file_size(image_path);
+    header.source_path_hash = source_path_hash(image_path, flip_uvs);
+    return header;
+}
+
+static void pad_to_alignment(std::ofstream &file) {
+    static constexpr char zeros[g_section_alignment] = {};
+    std::streamoff offset = file.tellp();
+    file.write(zeros, util::align_up(offset, g_section_alignment) - offset);
+}
+
+static void skip_to_alignment(std::ifstream &file) {
+    file.seekg(util::align_up(file.tellg(), g_section_alignment));
+}
+
+std::filesystem::path TextureCache::cache_file_path(const std::filesystem::path &image_path, bool flip_uvs) const {
+    return m_cache_directory / std::format("{}-{:016x}.rgtex", image_path.stem()
+                                                                     .string(),
+                                           source_path_hash(image_path, flip_uvs));
+}
+
+TextureData TextureCache::import(const std::filesystem::path &image_path, bool flip_uvs) const {
+    if (!m_enabled) {
+        return TextureCompressor::raw(load_image(image_path, flip_uvs));
+    }
+    if (auto cached = load(image_path, flip_uvs)) {
+        return std::move(cached.value());
+    }
+    TextureData texture = TextureCompressor::compress(load_image(image_path, flip_uvs));
+    store(image_path, flip_uvs, texture);
+    return texture;
+}
+
+std::optional<TextureData> TextureCache::load(const std::filesystem::path &image_path, bool flip_uvs) const {
+    std::error_code error;
+    auto cache_path = cache_file_path(image_path, flip_uvs);
+    if (!std::filesystem::exists(cache_path, error) || !std::filesystem::exists(image_path, error)) {
+        return std::nullopt;
+    }
+    const auto cache_size = static_cast<uint64_t>(std::filesystem::file_size(cache_path, error));
+    std::ifstream file(cache_path, std::ios::binary);
+    if (error || !file.is_open()) {
+        return std::nullopt;
+    }
+
+    const TextureCacheHeader expected = make_header(image_path, flip_uvs);
+    TextureCacheHeader header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+        header.version != expected.version || header.source_mtime != expected.source_mtime ||
+        header.source_size != expected.source_size || header.source_path_hash != expected.source_path_hash ||
+        header.format == static_cast<uint32_t>(TextureFormat::Raw) ||
+        header.format > static_cast<uint32_t>(TextureFormat::BC5)) {
+        spdlog::info("TextureCache: {} is stale, compressing {} again", cache_path.string(), image_path.string());
+        return std::nullopt;
+    }
+
+    // A 32-bit size has at most 32 levels; the exact limit is checked against the size of the first level.
+    if (header.channels < 1 || header.channels > 4 || header.level_count < 1 || header.level_count > 32) {
+        spdlog::warn("TextureCache: {} is corrupted", cache_path.string());
+        return std::nullopt;
+    }
+
+    TextureData texture;
+    texture.format = static_cast<TextureFormat>(header.format);
+    texture.channels = static_cast<int32_t>(header.channels);
+    texture.path = image_path;
+    texture.levels.resize(header.level_count);
+    uint64_t file_offset = sizeof(header);
+    uint32_t base_width = 0;
+    uint32_t base_height = 0;
+    for (uint32_t i = 0; i < header.level_count; ++i) {
+        auto &level = texture.levels[i];
+        TextureCacheLevel record{};
+        file.read(reinterpret_cast<char *>(&record), sizeof(record));
+        if (i == 0) {
+            base_width = record.width;
+            base_height = record.height;
+        }
+        // Every level halves the previous one, down to 1x1 at floor(log2(max(width, height))) + 1 levels.
+        const uint32_t base_size = std::max(base_width, base_height);
+        const bool valid_size = base_width > 0 && base_height > 0 &&
+                                base_size <= std::numeric_limits<int32_t>::max() &&
+                                header.level_count <= static_cast<uint32_t>(std::bit_width(base_size)) &&
+                                record.width == std::max(1u, base_width >> i) &&
+                                record.height == std::max(1u, base_height >> i);
+        if (!file || !valid_size || record.size > cache_size ||
+            record.size != TextureCompressor::level_size(texture.format, record.width, record.height)) {
+            spdlog::warn("TextureCache: {} is corrupted", cache_path.string());
+            return std::nullopt;
+        }
+        // The levels read so far must fit the file before their data is read.
+        file_offset += sizeof(record) + util::align_up(record.size, g_section_alignment);
+        if (file_offset > cache_size) {
+            spdlog::warn("TextureCache: {} is corrupted", cache_path.string());
+            return std::nullopt;
+        }
+        level.width = static_cast<int32_t>(record.width);
+        level.height = static_cast<int32_t>(record.height);
+        level.data.resize(record.size);
+        file.read(reinterpret_cast<char *>(level.data.data()), record.size);
+        skip_to_alignment(file);
+        if (!file) {
+            spdlog::warn("TextureCache: {} is corrupted", cache_path.string());
+            return std::nullopt;
+        }
+    }
+    return texture;
+}
+
+bool TextureCache::store(const std::filesystem::path &image_path, bool flip_uvs, const TextureData &texture) const {
+    if (texture.format == TextureFormat::Raw) {
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(m_cache_directory, error);
+    auto cache_path = cache_file_path(image_path, flip_uvs);
+    // Write into a file unique to this thread and rename it, so that concurrent imports of the same image
+    // never leave a partially written cache file behind.
+    auto temporary_path = cache_path;
+    temporary_path += std::format(".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            spdlog::warn("TextureCache: failed to open {} for writing", temporary_path.string());
+            return false;
+        }
+        TextureCacheHeader header = make_header(image_path, flip_uvs);
+        header.format = static_cast<uint32_t>(texture.format);
+        header.channels = texture.channels;
+        header.level_count = texture.levels.size();
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (const auto &level: texture.levels) {
+            TextureCacheLevel record{};
+            record.width = level.width;
+            record.height = level.height;
+            record.size = level.data.size();
+            file.write(reinterpret_cast<const char *>(&record), sizeof(record));
+            file.write(reinterpret_cast<const char *>(level.data.data()), level.data.size());
+            pad_to_alignment(file);
+        }
+        if (!file) {
+            spdlog::warn("TextureCache: failed to write {}", temporary_path.string());
+            file.close();
+            std::filesystem::remove(temporary_path, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary_path, cache_path, error);
+    if (error) {
+        spdlog::warn("TextureCache: failed to write {}: {}", cache_path.string(), error.message());
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    spdlog::info("TextureCache: stored {} ({}, {} levels) into {}", image_path.string(), to_string(texture.format),
+                 texture.levels.size(), cache_path.string());
+    return true;
+}
+} // namespace engine::resources
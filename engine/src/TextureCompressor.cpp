@@ -0,0 +1,337 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <engine/resources/TextureCompressor.hpp>
+#include <engine/util/Errors.hpp>
+
+namespace engine::resources {
+/**
+ * @brief 4x4 pixels with 4 channels, unused channels are zero.
+ */
+using Block = std::array<std::array<uint8_t, 4>, 16>;
+
+static Block read_block(const uint8_t *pixels, int32_t width, int32_t height, int32_t channels, int32_t block_x,
+                        int32_t block_y) {
+    Block block{};
+    for (int32_t y = 0; y < 4; ++y) {
+        for (int32_t x = 0; x < 4; ++x) {
+            // Blocks on the right and bottom edges repeat the last column and row.
+            const int32_t source_x = std::min(block_x * 4 + x, width - 1);
+            const int32_t source_y = std::min(block_y * 4 + y, height - 1);
+            const uint8_t *pixel = pixels + (static_cast<size_t>(source_y) * width + source_x) * channels;
+            std::copy_n(pixel, channels, block[y * 4 + x].begin());
+        }
+    }
+    return block;
+}
+
+static uint16_t to_rgb565(int32_t r, int32_t g, int32_t b) {
+    return static_cast<uint16_t>((r * 31 + 127) / 255 << 11 | (g * 63 + 127) / 255 << 5 | (b * 31 + 127) / 255);
+}
+
+static std::array<int32_t, 3> from_rgb565(uint16_t color) {
+    const int32_t r = color >> 11 & 31, g = color >> 5 & 63, b = color & 31;
+    return {r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2};
+}
+
+static void store_le(uint8_t *out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+static uint64_t load_le(const uint8_t *in, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+static std::array<std::array<int32_t, 3>, 4> bc1_palette(uint16_t color0, uint16_t color1) {
+    const auto c0 = from_rgb565(color0), c1 = from_rgb565(color1);
+    std::array<std::array<int32_t, 3>, 4> palette{c0, c1};
+    for (int32_t c = 0; c < 3; ++c) {
+        palette[2][c] = (2 * c0[c] + c1[c]) / 3;
+        palette[3][c] = (c0[c] + 2 * c1[c]) / 3;
+    }
+    return palette;
+}
+
+/**
+ * @brief Encodes the RGB channels of the `block` into 8 bytes, always in the 4-color mode.
+ */
+static void encode_bc1_block(const Block &block, uint8_t *out) {
+    std::array<int32_t, 3> min{255, 255, 255}, max{0, 0, 0}, mean{};
+    for (const auto &pixel: block) {
+        for (int32_t c = 0; c < 3; ++c) {
+            min[c] = std::min<int32_t>(min[c], pixel[c]);
+            max[c] = std::max<int32_t>(max[c], pixel[c]);
+            mean[c] += pixel[c];
+        }
+    }
+    // The bounding box has 4 diagonals; take the one along which the channels correlate with the widest channel.
+    int32_t widest = 0;
+    for (int32_t c = 1; c < 3; ++c) {
+        if (max[c] - min[c] > max[widest] - min[widest]) {
+            widest = c;
+        }
+    }
+    for (int32_t c = 0; c < 3; ++c) {
+        int32_t covariance = 0;
+        for (const auto &pixel: block) {
+            covariance += (pixel[c] * 16 - mean[c]) * (pixel[widest] * 16 - mean[widest]);
+        }
+        if (covariance < 0) {
+            std::swap(min[c], max[c]);
+        }
+    }
+    // Inset the endpoints a bit, so that the outliers don't pull the interpolated colors away from the rest.
+    for (int32_t c = 0; c < 3; ++c) {
+        const int32_t inset = (max[c] - min[c]) / 16;
+        max[c] -= inset;
+        min[c] += inset;
+    }
+
+    uint16_t color0 = to_rgb565(max[0], max[1], max[2]);
+    uint16_t color1 = to_rgb565(min[0], min[1], min[2]);
+    uint32_t indices = 0;
+    if (color0 != color1) {
+        if (color0 < color1) {
+            std::swap(color0, color1);
+        }
+        const auto palette = bc1_palette(color0, color1);
+        for (int32_t i = 0; i < 16; ++i) {
+            int32_t best_index = 0, best_distance = INT32_MAX;
+            for (int32_t p = 0; p < 4; ++p) {
+                int32_t distance = 0;
+                for (int32_t c = 0; c < 3; ++c) {
+                    const int32_t delta = block[i][c] - palette[p][c];
+                    distance += delta * delta;
+                }
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    best_index = p;
+                }
+            }
+            indices |= static_cast<uint32_t>(best_index) << (2 * i);
+        }
+    }
+    store_le(out, color0, 2);
+    store_le(out + 2, color1, 2);
+    store_le(out + 4, indices, 4);
+}
+
+/**
+ * @brief Encodes one channel of the `block` into 8 bytes, always in the 8-value mode.
+ */
+static void encode_bc4_block(const Block &block, int32_t channel, uint8_t *out) {
+    int32_t min = 255, max = 0;
+    for (const auto &pixel: block) {
+        min = std::min<int32_t>(min, pixel[channel]);
+        max = std::max<int32_t>(max, pixel[channel]);
+    }
+    uint64_t indices = 0;
+    if (max != min) {
+        // Palette: 0 -> max, 1 -> min, 2..7 -> interpolated from max to min.
+        for (int32_t i = 0; i < 16; ++i) {
+            const int32_t step = ((max - block[i][channel]) * 14 + (max - min)) / (2 * (max - min));
+            const uint64_t index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+            indices |= index << (3 * i);
+        }
+    }
+    out[0] = static_cast<uint8_t>(max);
+    out[1] = static_cast<uint8_t>(min);
+    store_le(out + 2, indices, 6);
+}
+
+static void decode_bc1_block(const uint8_t *in, Block &block) {
+    const auto palette = bc1_palette(static_cast<uint16_t>(load_le(in, 2)), static_cast<uint16_t>(load_le(in + 2, 2)));
+    const auto indices = static_cast<uint32_t>(load_le(in + 4, 4));
+    for (int32_t i = 0; i < 16; ++i) {
+        const auto &color = palette[indices >> (2 * i) & 3];
+        for (int32_t c = 0; c < 3; ++c) {
+            block[i][c] = static_cast<uint8_t>(color[c]);
+        }
+    }
+}
+
+static void decode_bc4_block(const uint8_t *in, int32_t channel, Block &block) {
+    const int32_t value0 = in[0], value1 = in[1];
+    std::array<int32_t, 8> palette{value0, value1};
+    if (value0 > value1) {
+        for (int32_t i = 1; i <= 6; ++i) {
+            palette[i + 1] = ((7 - i) * value0 + i * value1) / 7;
+        }
+    } else {
+        for (int32_t i = 1; i <= 4; ++i) {
+            palette[i + 1] = ((5 - i) * value0 + i * value1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    const uint64_t indices = load_le(in + 2, 6);
+    for (int32_t i = 0; i < 16; ++i) {
+        block[i][channel] = static_cast<uint8_t>(palette[indices >> (3 * i) & 7]);
+    }
+}
+
+static void encode_block(TextureFormat format, const Block &block, uint8_t *out) {
+    switch (format) {
+        case TextureFormat::BC1: encode_bc1_block(block, out);
+            break;
+        case TextureFormat::BC3: encode_bc4_block(block, 3, out);
+            encode_bc1_block(block, out + 8);
+            break;
+        case TextureFormat::BC4: encode_bc4_block(block, 0, out);
+            break;
+        case TextureFormat::BC5: encode_bc4_block(block, 0, out);
+            encode_bc4_block(block, 1, out + 8);
+            break;
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled TextureFormat {}", to_string(format));
+    }
+}
+
+static void decode_block(TextureFormat format, const uint8_t *in, Block &block) {
+    switch (format) {
+        case TextureFormat::BC1: decode_bc1_block(in, block);
+            break;
+        case TextureFormat::BC3: decode_bc4_block(in, 3, block);
+            decode_bc1_block(in + 8, block);
+            break;
+        case TextureFormat::BC4: decode_bc4_block(in, 0, block);
+            break;
+        case TextureFormat::BC5: decode_bc4_block(in, 0, block);
+            decode_bc4_block(in + 8, 1, block);
+            break;
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled TextureFormat {}", to_string(format));
+    }
+}
+
+/**
+ * @brief Halves the `level` with a box filter. Odd rows and columns are folded into the last texel.
+ */
+static TextureData::Level downsample(const TextureData::Level &level, int32_t channels) {
+    TextureData::Level result;
+    result.width = std::max(level.width / 2, 1);
+    result.height = std::max(level.height / 2, 1);
+    result.data.resize(static_cast<size_t>(result.width) * result.height * channels);
+    for (int32_t y = 0; y < result.height; ++y) {
+        for (int32_t x = 0; x < result.width; ++x) {
+            const int32_t x0 = std::min(2 * x, level.width - 1), x1 = std::min(2 * x + 1, level.width - 1);
+            const int32_t y0 = std::min(2 * y, level.height - 1), y1 = std::min(2 * y + 1, level.height - 1);
+            for (int32_t c = 0; c < channels; ++c) {
+                auto at = [&](int32_t source_x, int32_t source_y) {
+                    return level.data[(static_cast<size_t>(source_y) * level.width + source_x) * channels + c];
+                };
+                const int32_t sum = at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1);
+                result.data[(static_cast<size_t>(y) * result.width + x) * channels + c] = static_cast<uint8_t>(
+                        (sum + 2) / 4);
+            }
+        }
+    }
+    return result;
+}
+
+TextureData TextureCompressor::compress(const ImageData &image) {
+    const TextureFormat format = format_for(image.channels);
+    TextureData result;
+    result.format = format;
+    result.channels = image.channels;
+    result.path = image.path;
+
+    TextureData::Level source = std::move(raw(image).levels.front());
+    while (true) {
+        const int32_t blocks_x = (source.width + 3) / 4;
+        const int32_t blocks_y = (source.height + 3) / 4;
+        auto &level = result.levels.emplace_back();
+        level.width = source.width;
+        level.height = source.height;
+        level.data.resize(level_size(format, source.width, source.height));
+        uint8_t *out = level.data.data();
+        for (int32_t block_y = 0; block_y < blocks_y; ++block_y) {
+            for (int32_t block_x = 0; block_x < blocks_x; ++block_x) {
+                encode_block(format, read_block(source.data.data(), source.width, source.height, image.channels,
+                                                block_x, block_y), out);
+                out += block_size(format);
+            }
+        }
+        if (source.width == 1 && source.height == 1) {
+            break;
+        }
+        source = downsample(source, image.channels);
+    }
+    return result;
+}
+
+TextureData TextureCompressor::decompress(const TextureData &texture) {
+    if (texture.format == TextureFormat::Raw) {
+        return texture;
+    }
+    TextureData result;
+    result.format = TextureFormat::Raw;
+    result.channels = texture.channels;
+    result.path = texture.path;
+    for (const auto &level: texture.levels) {
+        auto &raw_level = result.levels.emplace_back();
+        raw_level.width = level.width;
+        raw_level.height = level.height;
+        raw_level.data.resize(static_cast<size_t>(level.width) * level.height * texture.channels);
+        const int32_t blocks_x = (level.width + 3) / 4;
+        const int32_t blocks_y = (level.height + 3) / 4;
+        const uint8_t *in = level.data.data();
+        for (int32_t block_y = 0; block_y < blocks_y; ++block_y) {
+            for (int32_t block_x = 0; block_x < blocks_x; ++block_x) {
+                Block block{};
+                decode_block(texture.format, in, block);
+                in += block_size(texture.format);
+                for (int32_t y = 0; y < 4 && block_y * 4 + y < level.height; ++y) {
+                    for (int32_t x = 0; x < 4 && block_x * 4 + x < level.width; ++x) {
+                        const size_t pixel = static_cast<size_t>(block_y * 4 + y) * level.width + block_x * 4 + x;
+                        std::copy_n(block[y * 4 + x].begin(), texture.channels,
+                                    raw_level.data.begin() + pixel * texture.channels);
+                    }
+                }
+            }
+        }
+    }
+    return result;
+}
+
+TextureData TextureCompressor::raw(const ImageData &image) {
+    TextureData result;
+    result.format = TextureFormat::Raw;
+    result.channels = image.channels;
+    result.path = image.path;
+    auto &level = result.levels.emplace_back();
+    level.width = image.width;
+    level.height = image.height;
+    level.data.assign(image.pixels.get(),
+                      image.pixels.get() + static_cast<size_t>(image.width) * image.height * image.channels);
+    return result;
+}
+
+TextureFormat TextureCompressor::format_for(int32_t channels) {
+    switch (channels) {
+        case 1: return TextureFormat::BC4;
+        case 2: return TextureFormat::BC5;
+        case 3: return TextureFormat::BC1;
+        case 4: return TextureFormat::BC3;
+        default: RG_SHOULD_NOT_REACH_HERE("Unknown channels {}", channels);
+    }
+}
+
+size_t TextureCompressor::block_size(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::BC1:
+        case TextureFormat::BC4: return 8;
+        case TextureFormat::BC3:
+        case TextureFormat::BC5: return 16;
+        default: RG_SHOULD_NOT_REACH_HERE("Unhandled TextureFormat {}", to_string(format));
+    }
+}
+
+size_t TextureCompressor::level_size(TextureFormat format, int32_t width, int32_t height) {
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * block_size(format);
+}
+} // namespace engine::resources
@@ -90,6 +90,7 @@ std::string ArgParser::get_arg_value(std::string_view arg_name) {
     for (int i = 0; i < m_argc; ++i) {
         std::string_view token(m_argv[i]);
         if (token == arg_name) {
+            RG_GUARANTEE(i + 1 < m_argc, "No get_arg_value for argument: \"{}\" provided.", arg_name);
             std::string arg_value(m_argv[i + 1]);
             RG_GUARANTEE(!arg_value.starts_with("--"), "No get_arg_value for argument: \"{}\" provided.", arg_name);
             return arg_value;
@@ -98,6 +99,15 @@ std::string ArgParser::get_arg_value(std::string_view arg_name) {
     return "";
 }
 
+bool ArgParser::has_flag(std::string_view name) const {
+    for (int i = 0; i < m_argc; ++i) {
+        if (std::string_view(m_argv[i]) == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
 std::string read_text_file(const std::filesystem::path &path) {
     RG_GUARANTEE(std::filesystem::exists(path), "File {} doesn't exist.", path.string());
     std::ifstream file(path);
@@ -105,4 +115,12 @@ std::string read_text_file(const std::filesystem::path &path) {
     ss << file.rdbuf();
     return ss.str();
 }
+
+uint64_t fnv1a(std::string_view bytes, uint64_t hash) {
+    for (char byte: bytes) {
+        hash ^= static_cast<uint8_t>(byte);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
 } // namespace engine
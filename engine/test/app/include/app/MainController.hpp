@@ -16,6 +16,13 @@ public:
         return "test::app::MainController";
     }
 
+    /**
+    * @brief The update only moves the camera, so it can run on a worker thread with `--parallel-update`.
+    */
+    bool uses_gl_context() const override {
+        return false;
+    }
+
 private:
     void initialize() override;
 
@@ -23,6 +30,8 @@ private:
 
     void poll_events() override;
 
+    void fixed_update() override;
+
     void update() override;
 
     void begin_draw() override;
@@ -37,6 +46,11 @@ private:
 
     void update_camera();
 
+    /**
+    * @brief The camera position at the last two fixed steps; the rendered position is interpolated between them.
+    */
+    glm::vec3 m_previous_camera_position{};
+    glm::vec3 m_camera_position{};
     float m_backpack_scale{1.0f};
     bool m_draw_gui{false};
     bool m_cursor_enabled{true};
@@ -2,6 +2,7 @@
 #include <engine/core/Engine.hpp>
 #include <app/GUIController.hpp>
 #include <engine/graphics/GraphicsController.hpp>
+#include <engine/graphics/OpenGL.hpp>
 
 namespace engine::test::app {
 void GUIController::initialize() {
@@ -41,6 +42,67 @@ void GUIController::draw() {
                                                     .y, c.Front
                                                          .z);
     ImGui::End();
+
+    const auto &state_cache = engine::graphics::OpenGL::state_cache_stats();
+    ImGui::Begin("Render state");
+    ImGui::Text("State changes issued: %llu", static_cast<unsigned long long>(state_cache.issued));
+    ImGui::Text("State changes skipped: %llu", static_cast<unsigned long long>(state_cache.skipped));
+    const auto &render_queue = graphics->render_queue()
+                                       .stats();
+    ImGui::Text("Draw calls: %u", render_queue.draw_calls);
+    ImGui::Text("Shader changes: %u", render_queue.shader_changes);
+    ImGui::Text("Material changes: %u", render_queue.material_changes);
+    ImGui::Text("Meshes visible: %u, culled: %u", render_queue.visible, render_queue.culled);
+    bool culling = graphics->render_queue()
+                           .is_culling_enabled();
+    if (ImGui::Checkbox("Frustum culling", &culling)) {
+        graphics->render_queue()
+                .set_culling_enabled(culling);
+    }
+    ImGui::Text("Meshes drawn by multi-draws: %u", render_queue.indirect_draws);
+    if (graphics->render_queue()
+                .is_multi_draw_indirect_supported()) {
+        bool multi_draw = graphics->render_queue()
+                                  .is_multi_draw_indirect_enabled();
+        if (ImGui::Checkbox("Multi-draw indirect", &multi_draw)) {
+            graphics->render_queue()
+                    .set_multi_draw_indirect_enabled(multi_draw);
+        }
+    }
+    if (auto gpu_culling = graphics->render_queue()
+                                   .gpu_culling()) {
+        bool culling_on_gpu = graphics->render_queue()
+                                      .is_gpu_culling_enabled();
+        if (ImGui::Checkbox("GPU culling", &culling_on_gpu)) {
+            graphics->render_queue()
+                    .set_gpu_culling_enabled(culling_on_gpu);
+        }
+        bool occlusion = gpu_culling->is_occlusion_enabled();
+        if (ImGui::Checkbox("Occlusion culling", &occlusion)) {
+            gpu_culling->set_occlusion_enabled(occlusion);
+        }
+    }
+    ImGui::Text("Meshes occluded: %u, occluder triangles: %u", render_queue.occluded, render_queue.occluder_triangles);
+    bool software_occlusion = graphics->render_queue()
+                                      .is_software_occlusion_enabled();
+    if (ImGui::Checkbox("Software occlusion culling", &software_occlusion)) {
+        graphics->render_queue()
+                .set_software_occlusion_enabled(software_occlusion);
+    }
+    const auto platform = engine::core::Controller::get<engine::platform::PlatformController>();
+    const auto pacing = platform->frame_pacing_stats();
+    ImGui::Text("Frame time: %.2f ms, jitter: %.2f ms, max: %.2f ms", pacing.mean_ms, pacing.jitter_ms,
+                pacing.max_ms);
+    auto frame_pacing = platform->frame_pacing();
+    int vsync = static_cast<int>(frame_pacing.vsync);
+    bool changed = ImGui::Combo("VSync", &vsync, "Off\0On\0Adaptive\0");
+    changed |= ImGui::SliderFloat("Max FPS (0 = off)", &frame_pacing.max_fps, 0.0f, 240.0f, "%.0f");
+    if (changed) {
+        frame_pacing.vsync = static_cast<engine::platform::VSync>(vsync);
+        platform->set_frame_pacing(frame_pacing);
+    }
+    ImGui::End();
+    engine::util::Profiler::instance()->draw_gui();
     graphics->end_gui();
 }
 }
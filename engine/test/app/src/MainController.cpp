@@ -17,6 +17,8 @@ void MainPlatformEventObserver::on_mouse_move(engine::platform::MousePosition po
 void MainController::initialize() {
     // User initialization
     engine::graphics::OpenGL::enable_depth_testing();
+    m_camera_position = engine::core::Controller::get<engine::graphics::GraphicsController>()->camera()->Position;
+    m_previous_camera_position = m_camera_position;
 
     auto observer = std::make_unique<MainPlatformEventObserver>();
     engine::core::Controller::get<engine::platform::PlatformController>()->register_platform_event_observer(
@@ -41,6 +43,36 @@ void MainController::poll_events() {
     }
 }
 
+void MainController::fixed_update() {
+    auto gui = engine::core::Controller::get<GUIController>();
+    auto platform = engine::core::Controller::get<engine::platform::PlatformController>();
+    auto camera = engine::core::Controller::get<engine::graphics::GraphicsController>()->camera();
+    m_previous_camera_position = m_camera_position;
+    if (gui->is_enabled()) {
+        return;
+    }
+    // Move the simulated position, not the interpolated one the previous frame rendered from.
+    camera->Position = m_camera_position;
+    float dt = platform->fixed_timestep().step;
+    if (platform->key(engine::platform::KEY_W)
+                .state() == engine::platform::Key::State::Pressed) {
+        camera->move_camera(engine::graphics::Camera::Movement::FORWARD, dt);
+    }
+    if (platform->key(engine::platform::KEY_S)
+                .state() == engine::platform::Key::State::Pressed) {
+        camera->move_camera(engine::graphics::Camera::Movement::BACKWARD, dt);
+    }
+    if (platform->key(engine::platform::KEY_A)
+                .state() == engine::platform::Key::State::Pressed) {
+        camera->move_camera(engine::graphics::Camera::Movement::LEFT, dt);
+    }
+    if (platform->key(engine::platform::KEY_D)
+                .state() == engine::platform::Key::State::Pressed) {
+        camera->move_camera(engine::graphics::Camera::Movement::RIGHT, dt);
+    }
+    m_camera_position = camera->Position;
+}
+
 void MainController::update() {
     update_camera();
 }
@@ -59,15 +91,11 @@ void MainController::end_draw() {
 }
 
 void MainController::draw_backpack() {
-    auto graphics = engine::core::Controller::get<engine::graphics::GraphicsController>();
-    auto shader = engine::core::Controller::get<engine::resources::ResourcesController>()->shader("basic");
+    auto shader = engine::core::Controller::get<engine::resources::ResourcesController>()->shader("basic_instanced");
     auto backpack = engine::core::Controller::get<engine::resources::ResourcesController>()->model("backpack");
-    shader->use();
-    shader->set_mat4("projection", graphics->projection_matrix());
-    shader->set_mat4("view", graphics->camera()
-                                     ->view_matrix());
-    shader->set_mat4("model", scale(glm::mat4(1.0f), glm::vec3(m_backpack_scale)));
-    backpack->draw(shader);
+    auto graphics = engine::core::Controller::get<engine::graphics::GraphicsController>();
+    graphics->render_queue()
+            .submit(shader, backpack, scale(glm::mat4(1.0f), glm::vec3(m_backpack_scale)));
 }
 
 void MainController::draw_skybox() {
@@ -83,23 +111,8 @@ void MainController::update_camera() {
     }
     auto platform = engine::core::Controller::get<engine::platform::PlatformController>();
     auto camera = engine::core::Controller::get<engine::graphics::GraphicsController>()->camera();
-    float dt = platform->dt();
-    if (platform->key(engine::platform::KEY_W)
-                .state() == engine::platform::Key::State::Pressed) {
-        camera->move_camera(engine::graphics::Camera::Movement::FORWARD, dt);
-    }
-    if (platform->key(engine::platform::KEY_S)
-                .state() == engine::platform::Key::State::Pressed) {
-        camera->move_camera(engine::graphics::Camera::Movement::BACKWARD, dt);
-    }
-    if (platform->key(engine::platform::KEY_A)
-                .state() == engine::platform::Key::State::Pressed) {
-        camera->move_camera(engine::graphics::Camera::Movement::LEFT, dt);
-    }
-    if (platform->key(engine::platform::KEY_D)
-                .state() == engine::platform::Key::State::Pressed) {
-        camera->move_camera(engine::graphics::Camera::Movement::RIGHT, dt);
-    }
+    camera->Position = glm::mix(m_previous_camera_position, m_camera_position, platform->fixed_timestep().alpha);
+    // The mouse moves the view every frame, it's input for the rendering rather than the simulation.
     auto mouse = platform->mouse();
     camera->rotate_camera(mouse.dx, mouse.dy);
     camera->zoom(mouse.scroll);
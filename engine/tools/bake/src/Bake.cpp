@@ -0,0 +1,88 @@
+/**
+ * Bakes all the models from the config.json into the MeshCache, and all the textures from the resources/textures and
+ * the model materials into the TextureCache, so that the first start of the app skips Assimp and image decoding too.
+ * Run it from the directory of the app:
+ *     engine-bake [--configuration config.json]
+*/
+
+#include <engine/core/JobSystem.hpp>
+#include <engine/resources/MeshCache.hpp>
+#include <engine/resources/ModelImporter.hpp>
+#include <engine/resources/TextureCache.hpp>
+#include <engine/resources/TextureCompressor.hpp>
+#include <engine/util/ArgParser.hpp>
+#include <engine/util/Configuration.hpp>
+#include <engine/util/Errors.hpp>
+#include <spdlog/spdlog.h>
+#include <unordered_set>
+
+using namespace engine;
+
+int main(int argc, char **argv) {
+    try {
+        util::ArgParser::instance()->initialize(argc, argv);
+        util::Configuration::instance()->initialize();
+        const auto &config = util::Configuration::config();
+
+        const resources::MeshCache mesh_cache(resources::MeshCache::DEFAULT_DIRECTORY);
+        const resources::TextureCache texture_cache(resources::TextureCache::DEFAULT_DIRECTORY);
+        core::JobSystem pool;
+        std::vector<std::future<bool> > baked;
+        int failed = 0;
+        auto bake_texture = [&pool, &texture_cache](const std::filesystem::path &image_path) {
+            return pool.submit([&texture_cache, image_path] {
+                return texture_cache.store(image_path, false, resources::TextureCompressor::compress(
+                        resources::load_image(image_path, false)));
+            });
+        };
+
+        if (config.contains("resources") && config["resources"].contains("models")) {
+            std::vector<std::future<resources::ModelData> > models;
+            for (const auto &model_entry: config["resources"]["models"].items()) {
+                std::filesystem::path model_path = std::filesystem::path("resources/models") /
+                                                   model_entry.value()["path"].get<std::string>();
+                bool flip_uvs = model_entry.value().value<bool>("flip_uvs", false);
+                models.emplace_back(pool.submit([&mesh_cache, model_path, flip_uvs] {
+                    auto model = resources::ModelImporter::import(model_path, flip_uvs);
+                    mesh_cache.store(model_path, flip_uvs, model);
+                    return model;
+                }));
+            }
+            std::unordered_set<std::string> model_textures;
+            for (auto &model: models) {
+                try {
+                    for (const auto &mesh: model.get().meshes) {
+                        for (const auto &texture_reference: mesh.textures) {
+                            if (model_textures.insert(texture_reference.path.string()).second) {
+                                baked.emplace_back(bake_texture(texture_reference.path));
+                            }
+                        }
+                    }
+                } catch (const util::EngineError &e) {
+                    spdlog::error(e.report());
+                    ++failed;
+                }
+            }
+        }
+        if (std::filesystem::exists("resources/textures")) {
+            for (const auto &texture_entry: std::filesystem::directory_iterator("resources/textures")) {
+                baked.emplace_back(bake_texture(texture_entry.path()));
+            }
+        }
+
+        for (auto &result: baked) {
+            try {
+                failed += !result.get();
+            } catch (const util::EngineError &e) {
+                spdlog::error(e.report());
+                ++failed;
+            }
+        }
+        spdlog::info("Baked the resources into {} and {}, {} failed.", mesh_cache.cache_directory().string(),
+                     texture_cache.cache_directory().string(), failed);
+        return failed == 0 ? 0 : 1;
+    } catch (const util::EngineError &e) {
+        spdlog::error(e.report());
+        return 1;
+    }
+}
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""
+Compares two results of the engine-bench, e.g. of the parent commit and of the commit under review.
+
+Usage:
+    python compare.py baseline.json candidate.json [--threshold 5]
+
+Prints the change of every metric. Frame times that got slower by more than the threshold, in percent, are reported
+as regressions and make the script exit with 1, so it can fail a CI job.
+
+Exit Codes:
+- 0: No regressions.
+- 1: Regressions detected.
+- 2: Wrong usage or a missing file.
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+# Lower is better for all of them. Only the frame times can fail the comparison; the counters explain why.
+FRAME_TIME_METRICS = ["mean", "p50", "p95", "p99"]
+# Shown, but too noisy to fail the comparison.
+FRAME_PACING_METRICS = ["jitter", "max"]
+
+
+def load(path):
+    try:
+        return json.loads(Path(path).read_text())
+    except (OSError, json.JSONDecodeError) as e:
+        print(f"Failed to read {path}: {e}", file=sys.stderr)
+        sys.exit(2)
+
+
+def change(baseline, candidate):
+    if not baseline:
+        return 0.0
+    return (candidate - baseline) / baseline * 100.0
+
+
+def compare_section(name, baseline, candidate, keys, threshold, regressions):
+    if not baseline or not candidate:
+        return
+    print(f"\n{name}")
+    for key in keys:
+        if key not in baseline or key not in candidate:
+            continue
+        percent = change(baseline[key], candidate[key])
+        marker = ""
+        if threshold is not None and percent > threshold:
+            marker = "  <-- regression"
+            regressions.append(f"{name}.{key} {percent:+.1f}%")
+        print(f"  {key:<24}{baseline[key]:>14.3f}{candidate[key]:>14.3f}{percent:>+10.1f}%{marker}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compares two engine-bench results.")
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="Slowdown of a frame time, in percent, reported as a regression.")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    candidate = load(args.candidate)
+    print(f"baseline:  {baseline.get('label') or args.baseline} on {baseline.get('renderer')}")
+    print(f"candidate: {candidate.get('label') or args.candidate} on {candidate.get('renderer')}")
+    if baseline.get("renderer") != candidate.get("renderer"):
+        print("Warning: the results come from different renderers, the times aren't comparable.")
+
+    regressions = []
+    compare_section("frame_time_ms", baseline.get("frame_time_ms"), candidate.get("frame_time_ms"),
+                    FRAME_TIME_METRICS, args.threshold, regressions)
+    compare_section("frame_pacing_ms", baseline.get("frame_time_ms"), candidate.get("frame_time_ms"),
+                    FRAME_PACING_METRICS, None, regressions)
+    compare_section("gpu_frame_time_ms", baseline.get("gpu_frame_time_ms"), candidate.get("gpu_frame_time_ms"),
+                    FRAME_TIME_METRICS, args.threshold, regressions)
+    per_frame = baseline.get("per_frame", {})
+    compare_section("per_frame", per_frame, candidate.get("per_frame"), sorted(per_frame.keys()), None, regressions)
+    load_times = baseline.get("load_time_ms", {})
+    compare_section("load_time_ms", load_times, candidate.get("load_time_ms"), sorted(load_times.keys()), None,
+                    regressions)
+
+    if regressions:
+        print(f"\n{len(regressions)} regression(s) above {args.threshold}%: " + ", ".join(regressions))
+        return 1
+    print(f"\nNo frame time regressions above {args.threshold}%.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,318 @@
+/**
+ * Renders the "bench" scene from the config.json while flying the camera along a spline, and writes the frame time
+ * percentiles and the per-frame render statistics into a JSON file that compare.py diffs between two runs.
+ * Run it from the directory of the app, headless to get the same setup on every machine:
+ *     engine-bench --headless --no-gui [--frames 1000] [--output bench.json] [--label <commit>]
+*/
+
+#include <engine/core/Engine.hpp>
+#include <engine/graphics/GraphicsController.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <spdlog/spdlog.h>
+
+using namespace engine;
+
+namespace engine::tools::bench {
+/**
+* @brief Copies of the instances of a model drawn every frame.
+*/
+struct BenchModel {
+    resources::Model *model{};
+    resources::Shader *shader{};
+    std::vector<glm::mat4> transforms;
+};
+
+/**
+* @brief Sums of the render statistics over the measured frames.
+*/
+struct BenchCounters {
+    double draw_calls{};
+    double indirect_draws{};
+    double triangles{};
+    double shader_changes{};
+    double material_changes{};
+    double visible{};
+    double culled{};
+    double occluded{};
+    double state_changes_issued{};
+    double state_changes_skipped{};
+};
+
+class BenchController final : public core::Controller {
+public:
+    std::string_view name() const override {
+        return "BenchController";
+    }
+
+private:
+    void initialize() override;
+
+    void update() override;
+
+    void begin_draw() override;
+
+    void draw() override;
+
+    void end_draw() override;
+
+    void terminate() override;
+
+    /**
+    * @brief Reads the models and their instances from the "bench.models" of the config.json.
+    */
+    void load_scene(const nlohmann::json &scene);
+
+    /**
+    * @brief Collects the time every controller spent in initialize, before the events fall out of the profiler.
+    */
+    void record_load_times();
+
+    nlohmann::json results() const;
+
+    std::vector<BenchModel> m_models;
+    resources::Shader *m_skybox_shader{};
+    resources::Skybox *m_skybox{};
+    graphics::CameraPath m_camera_path;
+
+    uint64_t m_warmup_frames{};
+    uint64_t m_measured_frames{};
+    /**
+    * @brief The warmup frames, the measured frames, and one more frame that ends the last measured one.
+    */
+    uint64_t m_total_frames{};
+    uint64_t m_frame{};
+    uint64_t m_last_frame_begin{};
+
+    std::vector<uint64_t> m_frame_times;
+    std::vector<uint64_t> m_gpu_frame_times;
+    BenchCounters m_counters{};
+    std::map<std::string, double> m_load_times;
+};
+
+static glm::vec3 read_vec3(const nlohmann::json &json, const glm::vec3 &default_value) {
+    if (!json.is_array() || json.size() != 3) {
+        return default_value;
+    }
+    return glm::vec3(json[0].get<float>(), json[1].get<float>(), json[2].get<float>());
+}
+
+static double to_milliseconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) / 1e6;
+}
+
+void BenchController::initialize() {
+    const auto &config = util::Configuration::config();
+    RG_GUARANTEE(config.contains("bench"), "Add the \"bench\" scene to the config.json, see engine/tools/bench.");
+    const auto &bench = config["bench"];
+    auto arg_parser = util::ArgParser::instance();
+    m_warmup_frames = bench.value("warmup_frames", 60);
+    m_measured_frames = arg_parser->arg<long long>("--frames", bench.value("frames", 1000ll))
+                                   .value();
+    RG_GUARANTEE(m_measured_frames > 0, "The benchmark needs at least one measured frame.");
+    m_total_frames = m_warmup_frames + m_measured_frames + 1;
+    core::Controller::get<platform::PlatformController>()->set_frame_limit(m_total_frames);
+    load_scene(bench);
+    m_camera_path = graphics::CameraPath::from_json(bench.at("camera_path"));
+    RG_GUARANTEE(!m_camera_path.empty(), "The bench camera_path needs at least one keyframe.");
+    graphics::OpenGL::enable_depth_testing();
+    spdlog::info("Bench: {} warmup and {} measured frames on {}", m_warmup_frames, m_measured_frames,
+                 graphics::OpenGL::renderer_description());
+}
+
+void BenchController::load_scene(const nlohmann::json &scene) {
+    auto resources = core::Controller::get<resources::ResourcesController>();
+    for (const auto &entry: scene.at("models")) {
+        BenchModel model;
+        model.model = resources->model(entry.at("model").get<std::string>());
+        model.shader = resources->shader(entry.value("shader", "basic"));
+        // A grid of copies multiplies the draw calls without adding more assets.
+        const glm::vec3 origin = read_vec3(entry.value("position", nlohmann::json()), glm::vec3(0.0f));
+        const glm::vec3 grid = read_vec3(entry.value("grid", nlohmann::json()), glm::vec3(1.0f));
+        const float spacing = entry.value("spacing", 4.0f);
+        const float scale = entry.value("scale", 1.0f);
+        for (int x = 0; x < static_cast<int>(grid.x); ++x) {
+            for (int y = 0; y < static_cast<int>(grid.y); ++y) {
+                for (int z = 0; z < static_cast<int>(grid.z); ++z) {
+                    const glm::vec3 position = origin + glm::vec3(x, y, z) * spacing;
+                    model.transforms.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position),
+                                                          glm::vec3(scale)));
+                }
+            }
+        }
+        m_models.push_back(std::move(model));
+    }
+    if (scene.contains("skybox")) {
+        m_skybox = resources->skybox(scene["skybox"].value("name", "skybox"));
+        m_skybox_shader = resources->shader(scene["skybox"].value("shader", "skybox"));
+    }
+}
+
+void BenchController::record_load_times() {
+    uint64_t first_begin = UINT64_MAX;
+    uint64_t last_end = 0;
+    for (const auto &event: util::Profiler::instance()->events_between(0, util::Profiler::now())) {
+        if (event.detail != "initialize" || event.depth != 1) {
+            continue;
+        }
+        m_load_times[std::string(event.name)] += to_milliseconds(event.end - event.begin);
+        first_begin = std::min(first_begin, event.begin);
+        last_end = std::max(last_end, event.end);
+    }
+    if (last_end > first_begin) {
+        m_load_times["total"] = to_milliseconds(last_end - first_begin);
+    }
+}
+
+void BenchController::update() {
+    const uint64_t now = util::Profiler::now();
+    if (m_frame == 0) {
+        record_load_times();
+    }
+    // The statistics are those of the previous frame, the last one that was flushed.
+    if (m_frame > m_warmup_frames) {
+        m_frame_times.push_back(now - m_last_frame_begin);
+        const auto &stats = core::Controller::get<graphics::GraphicsController>()->render_queue()
+                                                                                 .stats();
+        m_counters.draw_calls += stats.draw_calls;
+        m_counters.indirect_draws += stats.indirect_draws;
+        m_counters.triangles += static_cast<double>(stats.triangles);
+        m_counters.shader_changes += stats.shader_changes;
+        m_counters.material_changes += stats.material_changes;
+        m_counters.visible += stats.visible;
+        m_counters.culled += stats.culled;
+        m_counters.occluded += stats.occluded;
+        const auto &state_cache = graphics::OpenGL::state_cache_stats();
+        m_counters.state_changes_issued += static_cast<double>(state_cache.issued);
+        m_counters.state_changes_skipped += static_cast<double>(state_cache.skipped);
+        if (const uint64_t gpu_time = graphics::GpuProfiler::instance()->last_frame_time(); gpu_time != 0) {
+            m_gpu_frame_times.push_back(gpu_time);
+        }
+    }
+    m_last_frame_begin = now;
+
+    // The pose depends only on the frame number, so every run renders the same images.
+    const float t = static_cast<float>(m_frame) / static_cast<float>(m_total_frames - 1);
+    m_camera_path.apply(core::Controller::get<graphics::GraphicsController>()->camera(), t);
+    ++m_frame;
+}
+
+void BenchController::begin_draw() {
+    graphics::OpenGL::clear_buffers();
+}
+
+void BenchController::draw() {
+    auto graphics = core::Controller::get<graphics::GraphicsController>();
+    for (const auto &model: m_models) {
+        for (const auto &transform: model.transforms) {
+            graphics->render_queue()
+                    .submit(model.shader, model.model, transform);
+        }
+    }
+    if (m_skybox) {
+        graphics->draw_skybox(m_skybox_shader, m_skybox);
+    }
+}
+
+void BenchController::end_draw() {
+    core::Controller::get<platform::PlatformController>()->swap_buffers();
+}
+
+/**
+ * @brief Returns the value below which the `percent` of the `sorted` values are, by the nearest rank.
+ */
+static double percentile(const std::vector<uint64_t> &sorted, double percent) {
+    const auto rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+    return to_milliseconds(sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1]);
+}
+
+static nlohmann::json summarize(std::vector<uint64_t> times) {
+    if (times.empty()) {
+        return nullptr;
+    }
+    std::sort(times.begin(), times.end());
+    const double sum = std::accumulate(times.begin(), times.end(), 0.0, [](double total, uint64_t time) {
+        return total + to_milliseconds(time);
+    });
+    const double mean = sum / static_cast<double>(times.size());
+    const double squared_deviations = std::accumulate(times.begin(), times.end(), 0.0,
+                                                      [mean](double total, uint64_t time) {
+                                                          const double deviation = to_milliseconds(time) - mean;
+                                                          return total + deviation * deviation;
+                                                      });
+    return {
+            {"mean", mean},
+            {"jitter", std::sqrt(squared_deviations / static_cast<double>(times.size()))},
+            {"min", to_milliseconds(times.front())},
+            {"p50", percentile(times, 50.0)},
+            {"p95", percentile(times, 95.0)},
+            {"p99", percentile(times, 99.0)},
+            {"max", to_milliseconds(times.back())},
+    };
+}
+
+nlohmann::json BenchController::results() const {
+    const double frames = std::max<double>(static_cast<double>(m_frame_times.size()), 1.0);
+    auto platform = core::Controller::get<platform::PlatformController>();
+    return {
+            {"label", util::ArgParser::instance()->arg<std::string>("--label").value()},
+            {"renderer", graphics::OpenGL::renderer_description()},
+            {"headless", platform->is_headless()},
+            {"multi_draw_indirect", core::Controller::get<graphics::GraphicsController>()->render_queue()
+                                                                                       .is_multi_draw_indirect_enabled()},
+            {"gpu_culling", core::Controller::get<graphics::GraphicsController>()->render_queue()
+                                                                               .is_gpu_culling_enabled()},
+            {"software_occlusion", core::Controller::get<graphics::GraphicsController>()->render_queue()
+                                                                                      .is_software_occlusion_enabled()},
+            {"resolution", {platform->window()->width(), platform->window()->height()}},
+            {"warmup_frames", m_warmup_frames},
+            {"frames", m_frame_times.size()},
+            {"frame_time_ms", summarize(m_frame_times)},
+            {"gpu_frame_time_ms", summarize(m_gpu_frame_times)},
+            {"per_frame", {
+                    {"draw_calls", m_counters.draw_calls / frames},
+                    {"indirect_draws", m_counters.indirect_draws / frames},
+                    {"triangles", m_counters.triangles / frames},
+                    {"shader_changes", m_counters.shader_changes / frames},
+                    {"material_changes", m_counters.material_changes / frames},
+                    {"visible_meshes", m_counters.visible / frames},
+                    {"culled_meshes", m_counters.culled / frames},
+                    {"occluded_meshes", m_counters.occluded / frames},
+                    {"state_changes_issued", m_counters.state_changes_issued / frames},
+                    {"state_changes_skipped", m_counters.state_changes_skipped / frames},
+            }},
+            {"load_time_ms", m_load_times},
+    };
+}
+
+void BenchController::terminate() {
+    if (m_frame_times.empty()) {
+        spdlog::warn("Bench: no frames were measured, nothing to write.");
+        return;
+    }
+    auto output_path = util::ArgParser::instance()->arg<std::string>("--output", "bench.json")
+                                                   .value();
+    const auto json = results();
+    std::ofstream file(output_path);
+    RG_GUARANTEE(file.is_open(), "Failed to open {} for writing.", output_path);
+    file << json.dump(4);
+    const auto &frame_time = json["frame_time_ms"];
+    spdlog::info("Bench: p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, written into {}",
+                 frame_time["p50"].get<double>(), frame_time["p95"].get<double>(), frame_time["p99"].get<double>(),
+                 output_path);
+}
+
+class BenchApp final : public core::App {
+    void app_setup() override {
+        auto bench = register_controller<BenchController>();
+        bench->after(core::Controller::get<core::EngineControllersEnd>());
+    }
+};
+} // namespace engine::tools::bench
+
+int main(int argc, char **argv) {
+    return std::make_unique<tools::bench::BenchApp>()->run(argc, argv);
+}